@@ -0,0 +1,98 @@
+/*
+ *  Copyright (c) 2018 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * @file        bench-backpressure.cpp
+ * @author      Sangwan Kwon (sangwan.kwon@samsung.com)
+ */
+
+#include "application/server.hxx"
+
+#include <bench.hxx>
+
+#include <chrono>
+#include <limits>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+using namespace rmi::application;
+
+namespace {
+
+const int REQUESTS = 64;
+const std::size_t REPLY_SIZE = 256 * 1024;
+
+struct Blob {
+	std::string get(void)
+	{
+		return this->data;
+	}
+
+	std::string data = std::string(REPLY_SIZE, 'b');
+};
+
+} // anonymous namespace
+
+// The client sends all requests before reading the replies.
+TEST(BENCH_BACKPRESSURE, LAZY_READER)
+{
+	const std::size_t unbounded = std::numeric_limits<std::size_t>::max();
+	struct {
+		std::string name;
+		std::size_t high;
+		std::size_t low;
+	} limits[] = {
+		{"unbounded", unbounded, unbounded},
+		{"4MB/1MB", Connection::HIGH_WATERMARK, Connection::LOW_WATERMARK},
+		{"256KB/64KB", 256 * 1024, 64 * 1024},
+	};
+
+	for (const auto& limit : limits) {
+		bench::SocketPath sockPath("backpressure");
+
+		Server server;
+		server.listen(sockPath);
+		server.setWatermarks(limit.high, limit.low);
+		server.expose(std::make_shared<Blob>(), "Blob::get", &Blob::get);
+
+		auto reactor = std::thread([&]() { server.start(); });
+		std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+		{
+			Connection lazy(sockPath);
+			auto sender = std::thread([&]() {
+				Message request(Message::Type::MethodCall, "Blob::get");
+				for (int i = 0; i < REQUESTS; i++)
+					lazy.send(request);
+			});
+
+			std::this_thread::sleep_for(std::chrono::milliseconds(200));
+			auto ns = bench::measure(REQUESTS, [&]() { bench::keep(lazy.recv()); });
+			sender.join();
+
+			auto backpressure = server.getBackpressure();
+			auto label = "server/backpressure[" + limit.name + "]";
+			bench::report(label, REPLY_SIZE * 1e9 / ns / (1024 * 1024), "MB/s");
+			bench::report(label, backpressure.peakBytes / 1024.0, "KB queued at peak");
+			bench::report(label, backpressure.paused, "pauses");
+		}
+
+		server.stop();
+		reactor.join();
+	}
+}
@@ -0,0 +1,88 @@
+/*
+ *  Copyright (c) 2018 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * @file        bench-batch.cpp
+ * @author      Sangwan Kwon (sangwan.kwon@samsung.com)
+ */
+
+#include "application/server.hxx"
+#include "application/client.hxx"
+
+#include <bench.hxx>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+using namespace rmi::application;
+
+namespace {
+
+const std::size_t CALLS = 8192;
+
+struct Counter {
+	int add(int value)
+	{
+		return value + 1;
+	}
+};
+
+} // anonymous namespace
+
+// N calls in one batch take one round trip instead of N.
+TEST(BENCH_BATCH, SIZE)
+{
+	bench::SocketPath sockPath("batch");
+
+	Server server;
+	server.listen(sockPath);
+	server.expose(std::make_shared<Counter>(), "Counter::add", &Counter::add);
+
+	auto reactor = std::thread([&]() { server.start(); });
+	std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+	{
+		Client client(sockPath);
+		auto ns = bench::measure(CALLS, [&]() {
+			bench::keep(client.invoke<int>("Counter::add", 1));
+		});
+		bench::report("client/invoke", 1e9 / ns, "calls/s");
+		bench::report("client/invoke", 1.0, "round trips/call");
+	}
+
+	for (std::size_t size : {1, 8, 64, 256}) {
+		Client client(sockPath);
+		Batch batch;
+		for (std::size_t i = 0; i < size; i++)
+			batch.add("Counter::add", 1);
+
+		auto ns = bench::measure(CALLS / size, [&]() {
+			auto result = client.invoke(batch);
+			for (std::size_t i = 0; i < size; i++)
+				bench::keep(result.get<int>(i));
+		});
+
+		auto label = "client/invoke(batch)[" + std::to_string(size) + "]";
+		bench::report(label, size * 1e9 / ns, "calls/s");
+		bench::report(label, 1.0 / size, "round trips/call");
+	}
+
+	server.stop();
+	reactor.join();
+}
@@ -0,0 +1,89 @@
+/*
+ *  Copyright (c) 2018 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * @file        bench-client-async.cpp
+ * @author      Sangwan Kwon (sangwan.kwon@samsung.com)
+ */
+
+#include "application/server.hxx"
+#include "application/client.hxx"
+
+#include <bench.hxx>
+
+#include <chrono>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace rmi::application;
+
+namespace {
+
+const std::size_t CALLS = 8192;
+
+struct Counter {
+	int add(int value)
+	{
+		return value + 1;
+	}
+};
+
+} // anonymous namespace
+
+// One caller keeps depth calls in flight on one connection.
+TEST(BENCH_CLIENT_ASYNC, DEPTH)
+{
+	bench::SocketPath sockPath("client-async");
+
+	Server server;
+	server.listen(sockPath);
+	server.expose(std::make_shared<Counter>(), "Counter::add", &Counter::add);
+
+	auto reactor = std::thread([&]() { server.start(); });
+	std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+	{
+		Client client(sockPath);
+		auto ns = bench::measure(CALLS, [&]() {
+			bench::keep(client.invoke<int>("Counter::add", 1));
+		});
+		bench::report("client/invoke", 1e9 / ns, "requests/s");
+	}
+
+	for (std::size_t depth : {1, 4, 16, 64, 256}) {
+		Client client(sockPath);
+		std::vector<std::future<int>> futures;
+
+		auto ns = bench::measure(CALLS / depth, [&]() {
+			for (std::size_t i = 0; i < depth; i++)
+				futures.push_back(client.invokeAsync<int>("Counter::add", 1));
+
+			for (auto& future : futures)
+				bench::keep(future.get());
+			futures.clear();
+		});
+
+		auto label = "client/invokeAsync[depth " + std::to_string(depth) + "]";
+		bench::report(label, depth * 1e9 / ns, "requests/s");
+	}
+
+	server.stop();
+	reactor.join();
+}
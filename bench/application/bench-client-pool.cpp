@@ -0,0 +1,98 @@
+/*
+ *  Copyright (c) 2018 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * @file        bench-client-pool.cpp
+ * @author      Sangwan Kwon (sangwan.kwon@samsung.com)
+ */
+
+#include "application/server.hxx"
+#include "application/client.hxx"
+#include "application/client-pool.hxx"
+
+#include <bench.hxx>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace rmi::application;
+
+namespace {
+
+const std::size_t THREADS = 8;
+const std::size_t CALLS = 500;
+
+struct Counter {
+	int add(int value)
+	{
+		return value + 1;
+	}
+};
+
+// The callers share the invoker, and each makes CALLS in a row.
+template<typename F>
+void share(const std::string& name, F&& invoke)
+{
+	auto ns = bench::measure(1, [&]() {
+		std::vector<std::thread> callers;
+		for (std::size_t i = 0; i < THREADS; i++) {
+			callers.emplace_back([&]() {
+				for (std::size_t j = 0; j < CALLS; j++)
+					bench::keep(invoke(static_cast<int>(j)));
+			});
+		}
+
+		for (auto& caller : callers)
+			caller.join();
+	});
+
+	bench::report(name, (THREADS * CALLS) * 1e9 / ns, "requests/s");
+}
+
+} // anonymous namespace
+
+TEST(BENCH_CLIENT_POOL, THREADS)
+{
+	bench::SocketPath sockPath("client-pool");
+
+	Server server;
+	server.listen(sockPath);
+	server.expose(std::make_shared<Counter>(), "Counter::add", &Counter::add);
+
+	auto reactor = std::thread([&]() { server.start(); });
+	std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+	{
+		Client client(sockPath);
+		share("client-pool/single client", [&](int value) {
+			return client.invoke<int>("Counter::add", value);
+		});
+	}
+
+	for (std::size_t size : {1, 2, 4, 8}) {
+		ClientPool pool({sockPath}, size);
+		share("client-pool/pool[" + std::to_string(size) + "]", [&](int value) {
+			return pool.invoke<int>("Counter::add", value);
+		});
+	}
+
+	server.stop();
+	reactor.join();
+}
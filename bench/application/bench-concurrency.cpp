@@ -0,0 +1,124 @@
+/*
+ *  Copyright (c) 2018 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * @file        bench-concurrency.cpp
+ * @author      Sangwan Kwon (sangwan.kwon@samsung.com)
+ */
+
+#include "application/server.hxx"
+#include "application/client.hxx"
+
+#include <bench.hxx>
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace rmi::application;
+
+namespace {
+
+const std::size_t CLIENTS = 4;
+const std::size_t CALLS = 100;
+
+// The method which waits for others, such as disk or another service.
+struct Store {
+	int write(int value)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		return value;
+	}
+
+	int read(int value) const
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		return value;
+	}
+};
+
+} // anonymous namespace
+
+// Each client calls on its own connection, and the methods run on workers.
+TEST(BENCH_CONCURRENCY, POLICY)
+{
+	bench::SocketPath sockPath("concurrency");
+
+	Server server;
+	server.listen(sockPath);
+	server.setWorkers(CLIENTS);
+
+	auto exclusive = std::make_shared<Store>();
+	server.expose(exclusive, "Exclusive::write", &Store::write);
+	server.expose(exclusive, "Exclusive::read", &Store::read);
+
+	auto shared = std::make_shared<Store>();
+	server.expose(shared, "Shared::write", &Store::write, Server::Concurrency::ReaderWriter);
+	server.expose(shared, "Shared::read", &Store::read, Server::Concurrency::ReaderWriter);
+
+	auto none = std::make_shared<Store>();
+	server.expose(none, "None::write", &Store::write, Server::Concurrency::None);
+
+	for (std::size_t i = 0; i < CLIENTS; i++) {
+		server.expose(std::make_shared<Store>(), "Store" + std::to_string(i) + "::write",
+					  &Store::write);
+	}
+
+	auto reactor = std::thread([&]() { server.start(); });
+	std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+	std::vector<std::unique_ptr<Client>> clients;
+	for (std::size_t i = 0; i < CLIENTS; i++)
+		clients.emplace_back(new Client(sockPath));
+
+	auto run = [&](const std::string& label, std::function<std::string(std::size_t)> name) {
+		auto ns = bench::measure(1, [&]() {
+			std::vector<std::thread> callers;
+			for (std::size_t i = 0; i < CLIENTS; i++) {
+				auto method = name(i);
+				auto client = clients[i].get();
+				callers.emplace_back([client, method]() {
+					for (std::size_t j = 0; j < CALLS; j++)
+						bench::keep(client->invoke<int>(method, 1));
+				});
+			}
+
+			for (auto& caller : callers)
+				caller.join();
+		});
+
+		bench::report("server/concurrency[" + label + "]", CLIENTS * CALLS * 1e9 / ns,
+					  "requests/s");
+	};
+
+	run("exclusive, one object", [](std::size_t) { return "Exclusive::write"; });
+	run("exclusive, own objects", [](std::size_t i) {
+		return "Store" + std::to_string(i) + "::write";
+	});
+	run("none, one object", [](std::size_t) { return "None::write"; });
+	run("exclusive, const methods", [](std::size_t) { return "Exclusive::read"; });
+	run("reader/writer, const methods", [](std::size_t) { return "Shared::read"; });
+	run("reader/writer, 1 writer", [](std::size_t i) {
+		return i == 0 ? "Shared::write" : "Shared::read";
+	});
+
+	server.stop();
+	reactor.join();
+}
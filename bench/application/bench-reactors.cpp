@@ -0,0 +1,89 @@
+/*
+ *  Copyright (c) 2018 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * @file        bench-reactors.cpp
+ * @author      Sangwan Kwon (sangwan.kwon@samsung.com)
+ */
+
+#include "application/server.hxx"
+#include "application/client.hxx"
+
+#include <bench.hxx>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace rmi::application;
+
+namespace {
+
+const std::size_t CLIENTS = 8;
+const std::size_t CALLS = 1024;
+
+struct Counter {
+	int add(int value)
+	{
+		return value + 1;
+	}
+};
+
+} // anonymous namespace
+
+// The clients call at once on their own connections.
+TEST(BENCH_REACTORS, CLIENTS)
+{
+	for (std::size_t count : {1, 2, 4, 8}) {
+		bench::SocketPath sockPath("reactors");
+
+		Server server;
+		server.listen(sockPath);
+		server.setReactors(count);
+		server.expose(std::make_shared<Counter>(), "Counter::add", &Counter::add);
+
+		auto reactor = std::thread([&]() { server.start(); });
+		std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+		{
+			std::vector<std::unique_ptr<Client>> clients;
+			for (std::size_t i = 0; i < CLIENTS; i++)
+				clients.emplace_back(new Client(sockPath));
+
+			auto ns = bench::measure(1, [&]() {
+				std::vector<std::thread> callers;
+				for (auto& client : clients) {
+					callers.emplace_back([&client]() {
+						for (std::size_t i = 0; i < CALLS; i++)
+							bench::keep(client->invoke<int>("Counter::add", 1));
+					});
+				}
+
+				for (auto& caller : callers)
+					caller.join();
+			});
+
+			auto label = "server/reactors[" + std::to_string(count) + "]";
+			bench::report(label, CLIENTS * CALLS * 1e9 / ns, "requests/s");
+		}
+
+		server.stop();
+		reactor.join();
+	}
+}
@@ -0,0 +1,115 @@
+/*
+ *  Copyright (c) 2018 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * @file        bench.hxx
+ * @author      Sangwan Kwon (sangwan.kwon@samsung.com)
+ * @brief       Tiny helpers for micro-benchmark. (Header Only)
+ * @usage       auto ns = bench::measure(1000, [&]() { ... });
+ *              bench::report("archive/int", ns, "ns/field");
+ *              auto before = bench::syscalls(); ... bench::syscalls() - before;
+ *              bench::SocketPath path("server"); server.listen(path);
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include <unistd.h>
+
+namespace bench {
+
+// Prevent the optimizer from discarding the benchmarked value.
+template<typename T>
+inline void keep(const T& value) noexcept
+{
+	asm volatile("" : : "g"(&value) : "memory");
+}
+
+// Returns the elapsed nanoseconds per iteration.
+template<typename F>
+double measure(std::size_t iterations, F&& func)
+{
+	using Clock = std::chrono::steady_clock;
+
+	auto begin = Clock::now();
+	for (std::size_t i = 0; i < iterations; i++)
+		func();
+	auto end = Clock::now();
+
+	auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin);
+	return static_cast<double>(elapsed.count()) / iterations;
+}
+
+// Returns the number of read and write system calls of this process.
+inline std::size_t syscalls(void)
+{
+	std::ifstream io("/proc/self/io");
+
+	std::size_t count = 0;
+	std::string key;
+	std::size_t value;
+	while (io >> key >> value) {
+		if (key == "syscr:" || key == "syscw:")
+			count += value;
+	}
+
+	return count;
+}
+
+// The unique path of unix socket, which is removed when it goes out of scope.
+class SocketPath {
+public:
+	explicit SocketPath(const std::string& name) :
+		path("/tmp/rmi-bench-" + name + "-" + std::to_string(::getpid()))
+	{
+		::unlink(this->path.c_str());
+	}
+
+	~SocketPath()
+	{
+		::unlink(this->path.c_str());
+	}
+
+	SocketPath(const SocketPath&) = delete;
+	SocketPath& operator=(const SocketPath&) = delete;
+
+	const std::string& get(void) const noexcept
+	{
+		return this->path;
+	}
+
+	operator const std::string&(void) const noexcept
+	{
+		return this->path;
+	}
+
+private:
+	std::string path;
+};
+
+inline void report(const std::string& name, double value, const std::string& unit)
+{
+	std::cout << "[BENCH] " << std::left << std::setw(40) << name
+			  << std::right << std::setw(12) << std::fixed << std::setprecision(2)
+			  << value << " " << unit << std::endl;
+}
+
+} // namespace bench
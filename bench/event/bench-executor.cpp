@@ -0,0 +1,118 @@
+/*
+ *  Copyright (c) 2018 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * @file        bench-executor.cpp
+ * @author      Sangwan Kwon (sangwan.kwon@samsung.com)
+ */
+
+#include "event/executor.hxx"
+
+#include <bench.hxx>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+using namespace rmi::event;
+
+namespace {
+
+const std::size_t TASKS = 100000;
+const std::size_t SKEWED_TASKS = 2000;
+
+void spin(std::chrono::microseconds duration)
+{
+	auto until = std::chrono::steady_clock::now() + duration;
+	while (std::chrono::steady_clock::now() < until);
+}
+
+void wait(const std::atomic<std::size_t>& done, std::size_t count)
+{
+	while (done < count)
+		std::this_thread::yield();
+}
+
+} // anonymous namespace
+
+// The tiny tasks submitted from outside, as the reactors do.
+TEST(BENCH_EXECUTOR, SUBMIT)
+{
+	for (std::size_t workers : {1, 2, 4}) {
+		Executor executor(workers);
+		std::atomic<std::size_t> done{0};
+
+		auto ns = bench::measure(1, [&]() {
+			for (std::size_t i = 0; i < TASKS; i++)
+				executor.submit([&done]() { done++; });
+			wait(done, TASKS);
+		});
+
+		auto label = "executor/submit[" + std::to_string(workers) + " workers]";
+		bench::report(label, TASKS * 1e9 / ns, "tasks/s");
+	}
+
+	for (std::size_t workers : {1, 2, 4}) {
+		Executor executor(workers);
+		std::atomic<std::size_t> done{0};
+		int keys[8];
+
+		auto ns = bench::measure(1, [&]() {
+			for (std::size_t i = 0; i < TASKS; i++)
+				executor.submit(&keys[i % 8], [&done]() { done++; });
+			wait(done, TASKS);
+		});
+
+		auto label = "executor/submit ordered[" + std::to_string(workers) + " workers]";
+		bench::report(label, TASKS * 1e9 / ns, "tasks/s");
+	}
+}
+
+// All tasks are queued on one worker, so the others should steal them.
+TEST(BENCH_EXECUTOR, SKEWED)
+{
+	for (std::size_t workers : {2, 4}) {
+		Executor executor(workers);
+		std::atomic<std::size_t> done{0};
+
+		auto ns = bench::measure(1, [&]() {
+			executor.submit([&]() {
+				for (std::size_t i = 0; i < SKEWED_TASKS; i++) {
+					executor.submit([&done]() {
+						spin(std::chrono::microseconds(20));
+						done++;
+					});
+				}
+			});
+			wait(done, SKEWED_TASKS);
+		});
+
+		std::size_t steals = 0, least = SKEWED_TASKS;
+		for (const auto& worker : executor.getStatistics()) {
+			steals += worker.steals;
+			least = std::min(least, worker.tasks);
+		}
+
+		auto label = "executor/skewed[" + std::to_string(workers) + " workers]";
+		bench::report(label, SKEWED_TASKS * 1e9 / ns, "tasks/s");
+		bench::report(label, static_cast<double>(steals) / SKEWED_TASKS, "stolen/task");
+		bench::report(label, static_cast<double>(least) * workers / SKEWED_TASKS,
+					  "least/fair share");
+	}
+}
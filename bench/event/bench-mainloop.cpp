@@ -0,0 +1,117 @@
+/*
+ *  Copyright (c) 2018 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * @file        bench-mainloop.cpp
+ * @author      Sangwan Kwon (sangwan.kwon@samsung.com)
+ */
+
+#include "application/server.hxx"
+#include "transport/connection.hxx"
+
+#include <bench.hxx>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <pthread.h>
+#include <time.h>
+
+#include <gtest/gtest.h>
+
+using namespace rmi::application;
+using namespace rmi::event;
+using namespace rmi::transport;
+
+namespace {
+
+const std::size_t CONNECTIONS = 4;
+const std::size_t DEPTH = 32;
+const std::size_t ROUNDS = 500;
+
+struct Counter {
+	int add(int value)
+	{
+		return value + 1;
+	}
+};
+
+double cpu(clockid_t clock)
+{
+	::timespec time;
+	::clock_gettime(clock, &time);
+
+	return static_cast<double>(time.tv_sec) * 1e9 + static_cast<double>(time.tv_nsec);
+}
+
+// Each connection sends a burst of requests, then reads the replies.
+void serve(const std::string& name, Mainloop::Backend backend)
+{
+	bench::SocketPath sockPath("mainloop");
+
+	Server server(backend);
+	server.listen(sockPath);
+	server.expose(std::make_shared<Counter>(), "Counter::add", &Counter::add);
+
+	auto reactor = std::thread([&]() { server.start(); });
+	std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+	// The CPU time of the server thread only.
+	clockid_t clock;
+	ASSERT_EQ(::pthread_getcpuclockid(reactor.native_handle(), &clock), 0);
+
+	std::vector<std::unique_ptr<Connection>> connections;
+	for (std::size_t i = 0; i < CONNECTIONS; i++)
+		connections.emplace_back(new Connection(sockPath));
+
+	auto before = cpu(clock);
+	auto ns = bench::measure(ROUNDS, [&]() {
+		for (auto& connection : connections) {
+			for (std::size_t i = 0; i < DEPTH; i++) {
+				Message request(Message::Type::MethodCall, "Counter::add");
+				request.enclose(static_cast<int>(i));
+				connection->send(request);
+			}
+		}
+
+		for (auto& connection : connections)
+			for (std::size_t i = 0; i < DEPTH; i++)
+				bench::keep(connection->recv());
+	});
+	auto used = cpu(clock) - before;
+
+	connections.clear();
+	server.stop();
+	reactor.join();
+
+	auto requests = static_cast<double>(CONNECTIONS * DEPTH);
+	bench::report(name, requests * 1e9 / ns, "requests/s");
+	bench::report(name, used / (ROUNDS * requests), "server cpu ns/request");
+}
+
+} // anonymous namespace
+
+TEST(BENCH_MAINLOOP, BACKEND)
+{
+	serve("mainloop/epoll", Mainloop::Backend::Epoll);
+
+	if (!IoUring::isSupported())
+		return;
+
+	serve("mainloop/io_uring", Mainloop::Backend::IoUring);
+}
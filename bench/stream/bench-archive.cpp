@@ -0,0 +1,226 @@
+/*
+ *  Copyright (c) 2018 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * @file        bench-archive.cpp
+ * @author      Sangwan Kwon (sangwan.kwon@samsung.com)
+ */
+
+#include "stream/archive.hxx"
+#include "stream/archive-view.hxx"
+
+#include <bench.hxx>
+
+#include <algorithm>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace rmi::stream;
+
+namespace {
+
+const std::size_t FIELDS = 1000;
+const std::size_t ITERATIONS = 1000;
+
+// The append path before the growth policy was introduced.
+struct LegacyArchive : public Archive {
+	void save(const void* bytes, std::size_t size) override
+	{
+		auto binary = reinterpret_cast<unsigned char*>(const_cast<void*>(bytes));
+		std::vector<unsigned char> next(binary, binary + size);
+
+		std::copy(next.begin(), next.end(), std::back_inserter(this->legacy));
+	}
+
+	std::vector<unsigned char> legacy;
+};
+
+struct Nested : public Archival {
+	void pack(Archive& archive) const override
+	{
+		archive << a << b << c;
+	}
+
+	void unpack(Archive& archive) override
+	{
+		archive >> a >> b >> c;
+	}
+
+	int a = 100;
+	double b = 1.5;
+	std::string c = "nested";
+};
+
+template<typename A, typename T>
+double perField(const T& value)
+{
+	auto ns = bench::measure(ITERATIONS, [&]() {
+		A archive;
+		for (std::size_t i = 0; i < FIELDS; i++)
+			archive << value;
+		bench::keep(archive);
+	});
+
+	return ns / FIELDS;
+}
+
+} // anonymous namespace
+
+TEST(BENCH_ARCHIVE, APPEND_INT)
+{
+	int value = 0x12345678;
+	bench::report("archive/int (legacy)", perField<LegacyArchive>(value), "ns/field");
+	bench::report("archive/int", perField<Archive>(value), "ns/field");
+}
+
+TEST(BENCH_ARCHIVE, APPEND_STRING)
+{
+	std::string value(32, 'a');
+	bench::report("archive/string[32] (legacy)", perField<LegacyArchive>(value), "ns/field");
+	bench::report("archive/string[32]", perField<Archive>(value), "ns/field");
+}
+
+TEST(BENCH_ARCHIVE, APPEND_ARCHIVAL)
+{
+	Nested value;
+	bench::report("archive/archival (legacy)", perField<LegacyArchive>(value), "ns/field");
+	bench::report("archive/archival", perField<Archive>(value), "ns/field");
+}
+
+TEST(BENCH_ARCHIVE, APPEND_ARCHIVE)
+{
+	Archive source;
+	for (std::size_t i = 0; i < FIELDS; i++)
+		source << static_cast<int>(i);
+
+	auto ns = bench::measure(ITERATIONS, [&]() {
+		Archive archive;
+		archive << source;
+		bench::keep(archive);
+	});
+
+	bench::report("archive/archive[4KB]", ns, "ns/append");
+}
+
+TEST(BENCH_ARCHIVE, APPEND_VECTOR)
+{
+	std::vector<int> value(FIELDS, 0x12345678);
+
+	auto elementwise = bench::measure(ITERATIONS, [&]() {
+		Archive archive;
+		archive << value.size();
+		for (const auto& element : value)
+			archive << element;
+		bench::keep(archive);
+	});
+
+	auto bulk = bench::measure(ITERATIONS, [&]() {
+		Archive archive;
+		archive << value;
+		bench::keep(archive);
+	});
+
+	bench::report("archive/vector<int> (elementwise)", elementwise / FIELDS, "ns/field");
+	bench::report("archive/vector<int>", bulk / FIELDS, "ns/field");
+}
+
+namespace {
+
+// The typical call carries small integers and short strings.
+struct Call : public Archival {
+	void pack(Archive& archive) const override
+	{
+		archive << id << count << offset << flags << timeout << name << path;
+	}
+
+	void unpack(Archive& archive) override
+	{
+		archive >> id >> count >> offset >> flags >> timeout >> name >> path;
+	}
+
+	int id = 42;
+	int count = 3;
+	long offset = -128;
+	unsigned int flags = 0x11;
+	long long timeout = 5000;
+	std::string name = "Foo::getName";
+	std::string path = "/tmp/file";
+};
+
+void encoding(Archive::Encoding type, const std::string& name)
+{
+	const std::size_t calls = 100;
+	Call call;
+
+	Archive encoded;
+	encoded.setEncoding(type);
+	for (std::size_t i = 0; i < calls; i++)
+		encoded << call;
+
+	auto encode = bench::measure(ITERATIONS, [&]() {
+		Archive archive;
+		archive.setEncoding(type);
+		for (std::size_t i = 0; i < calls; i++)
+			archive << call;
+		bench::keep(archive);
+	});
+
+	auto decode = bench::measure(ITERATIONS, [&]() {
+		ArchiveView view(encoded);
+		view.setEncoding(type);
+		Call output;
+		for (std::size_t i = 0; i < calls; i++)
+			view >> output;
+		bench::keep(output);
+	});
+
+	bench::report("encoding/" + name + " size", encoded.size() / calls, "bytes/call");
+	bench::report("encoding/" + name + " encode", encode / calls, "ns/call");
+	bench::report("encoding/" + name + " decode", decode / calls, "ns/call");
+}
+
+} // anonymous namespace
+
+TEST(BENCH_ARCHIVE, ENCODING)
+{
+	encoding(Archive::Encoding::Fixed, "fixed");
+	encoding(Archive::Encoding::Compact, "compact");
+}
+
+TEST(BENCH_ARCHIVE, PREPARE)
+{
+	std::array<double, 32> fixed;
+	fixed.fill(1.5);
+	std::vector<std::string> variable(32, std::string(48, 'v'));
+
+	auto growing = bench::measure(ITERATIONS * 10, [&]() {
+		Archive archive;
+		archive.pack(1, 2L, fixed, variable);
+		bench::keep(archive);
+	});
+
+	auto prepared = bench::measure(ITERATIONS * 10, [&]() {
+		Archive archive;
+		archive.prepare(1, 2L, fixed, variable);
+		archive.pack(1, 2L, fixed, variable);
+		bench::keep(archive);
+	});
+
+	bench::report("archive/pack (growing)", growing, "ns/pack");
+	bench::report("archive/pack (prepared)", prepared, "ns/pack");
+}
@@ -0,0 +1,130 @@
+/*
+ *  Copyright (c) 2018 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * @file        bench-buffer-pool.cpp
+ * @author      Sangwan Kwon (sangwan.kwon@samsung.com)
+ * @brief       Count the allocations of request/reply loop with and without pool.
+ */
+
+#include "klass/functor.hxx"
+#include "transport/connection.hxx"
+#include "transport/socket.hxx"
+
+#include <bench.hxx>
+
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+
+#include <sys/socket.h>
+
+#include <gtest/gtest.h>
+
+using namespace rmi::klass;
+using namespace rmi::transport;
+
+namespace {
+
+// Replacing global operator new counts every allocation of this binary.
+std::atomic<std::size_t> allocations(0);
+
+const std::size_t WARMUP = 100;
+const std::size_t REQUESTS = 10000;
+
+struct Calculator {
+	int add(int a, int b) { return a + b; }
+};
+
+void roundtrip(const std::string& name, bool pooled)
+{
+	int fds[2];
+	ASSERT_NE(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds), -1);
+
+	Connection client{Socket(fds[0])};
+	Connection server{Socket(fds[1])};
+	if (!pooled) {
+		client.setPool(nullptr);
+		server.setPool(nullptr);
+	}
+
+	auto functor = make_functor_ptr(std::make_shared<Calculator>(), &Calculator::add);
+	auto serverThread = std::thread([&]() {
+		for (std::size_t i = 0; i < WARMUP + REQUESTS; i++) {
+			Message request = server.recv();
+			auto result = functor->invoke(request.buffer);
+
+			Message reply(Message::Type::Reply, request.signature,
+						  request.header.flags, server.getPool());
+			reply.enclose(result);
+			server.send(reply);
+		}
+	});
+
+	auto call = [&]() {
+		Message request(Message::Type::MethodCall, "add",
+						Message::Flag::None, client.getPool());
+		request.enclose(1, 2);
+
+		Message reply = client.request(request);
+		int sum;
+		reply.disclose(sum);
+		bench::keep(sum);
+	};
+
+	for (std::size_t i = 0; i < WARMUP; i++)
+		call();
+
+	auto before = allocations.load();
+	auto ns = bench::measure(REQUESTS, call);
+	auto count = allocations.load() - before;
+
+	serverThread.join();
+
+	bench::report(name, ns / 1000, "us/request");
+	bench::report(name, static_cast<double>(count) / REQUESTS, "allocations/request");
+	if (pooled)
+		bench::report(name, server.getPool()->getHitRate() * 100, "% server hit rate");
+}
+
+} // anonymous namespace
+
+void* operator new(std::size_t size)
+{
+	allocations.fetch_add(1, std::memory_order_relaxed);
+	if (void* ptr = std::malloc(size == 0 ? 1 : size))
+		return ptr;
+
+	throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+	std::free(ptr);
+}
+
+TEST(BENCH, BUFFER_POOL_ROUNDTRIP)
+{
+	roundtrip("pool/roundtrip[none]", false);
+	roundtrip("pool/roundtrip[pooled]", true);
+}
@@ -0,0 +1,159 @@
+/*
+ *  Copyright (c) 2018 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * @file        bench-kernel.cpp
+ * @author      Sangwan Kwon (sangwan.kwon@samsung.com)
+ * @brief       Throughput of scalar versus vectorized kernels.
+ */
+
+#include "stream/archive.hxx"
+#include "stream/kernel.hxx"
+#include "stream/varint.hxx"
+
+#include <bench.hxx>
+
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace rmi::stream;
+
+namespace {
+
+const std::size_t COUNT = 64 * 1024;
+const std::size_t ITERATIONS = 200;
+
+const char* name(kernel::Isa isa)
+{
+	switch (isa) {
+	case kernel::Isa::AVX2: return "avx2";
+	case kernel::Isa::SSE41: return "sse4.1";
+	default: return "scalar";
+	}
+}
+
+// GB/s of the native array.
+void report(const std::string& label, kernel::Isa isa, std::size_t bytes, double ns)
+{
+	bench::report("kernel/" + label + "[" + name(isa) + "]", bytes / ns, "GB/s");
+}
+
+template<typename F>
+void each(F&& run)
+{
+	auto best = kernel::detect();
+	for (auto isa : {kernel::Isa::Scalar, kernel::Isa::SSE41, kernel::Isa::AVX2}) {
+		if (static_cast<int>(isa) > static_cast<int>(best))
+			break;
+
+		kernel::setIsa(isa);
+		run(isa);
+	}
+
+	kernel::setIsa(best);
+}
+
+// Small values like ids, lengths and counters.
+std::vector<std::uint32_t> small(std::size_t limit)
+{
+	std::srand(0);
+	std::vector<std::uint32_t> values(COUNT);
+	for (auto& value : values)
+		value = static_cast<std::uint32_t>(std::rand()) % limit;
+
+	return values;
+}
+
+} // anonymous namespace
+
+TEST(BENCH_KERNEL, VARINTS)
+{
+	for (auto limit : {128, 16384}) {
+		auto values = small(limit);
+		std::vector<unsigned char> bytes(COUNT * MAX_VARINT_SIZE);
+		std::vector<std::uint32_t> decoded(COUNT);
+		auto label = std::string("varint<") + std::to_string(limit) + ">";
+
+		each([&](kernel::Isa isa) {
+			std::size_t size = 0;
+			auto encode = bench::measure(ITERATIONS, [&]() {
+				size = kernel::encodeVarints(values.data(), COUNT, bytes.data(), false);
+				bench::keep(bytes);
+			});
+			auto decode = bench::measure(ITERATIONS, [&]() {
+				kernel::decodeVarints(bytes.data(), size, decoded.data(), COUNT, false);
+				bench::keep(decoded);
+			});
+
+			report(label + " encode", isa, COUNT * sizeof(std::uint32_t), encode);
+			report(label + " decode", isa, COUNT * sizeof(std::uint32_t), decode);
+		});
+	}
+}
+
+TEST(BENCH_KERNEL, BYTE_SWAP_DELTA)
+{
+	std::vector<std::uint32_t> words = small(1 << 30);
+	std::vector<std::int32_t> series(COUNT);
+	for (std::size_t i = 0; i < COUNT; i++)
+		series[i] = static_cast<std::int32_t>(i * 3 + words[i] % 7);
+
+	each([&](kernel::Isa isa) {
+		auto swap = bench::measure(ITERATIONS, [&]() {
+			kernel::byteSwap(words.data(), words.data(), COUNT);
+			bench::keep(words);
+		});
+		auto delta = bench::measure(ITERATIONS, [&]() {
+			kernel::deltaEncode(series.data(), series.data(), COUNT);
+			kernel::deltaDecode(series.data(), series.data(), COUNT);
+			bench::keep(series);
+		});
+
+		report("byteswap<uint32>", isa, COUNT * sizeof(std::uint32_t), swap);
+		report("delta<int32> encode+decode", isa, COUNT * sizeof(std::int32_t), delta);
+	});
+}
+
+TEST(BENCH_KERNEL, ARCHIVE_COMPACT_VECTOR)
+{
+	auto values = small(16384);
+	std::vector<unsigned int> ints(values.begin(), values.end());
+
+	each([&](kernel::Isa isa) {
+		auto pack = bench::measure(ITERATIONS, [&]() {
+			Archive archive;
+			archive.setEncoding(Archive::Encoding::Compact);
+			archive << ints;
+			bench::keep(archive);
+		});
+
+		Archive archive;
+		archive.setEncoding(Archive::Encoding::Compact);
+		archive << ints;
+		auto unpack = bench::measure(ITERATIONS, [&]() {
+			Archive copy(archive);
+			std::vector<unsigned int> out;
+			copy >> out;
+			bench::keep(out);
+		});
+
+		report("archive compact vector<uint> pack", isa, COUNT * sizeof(int), pack);
+		report("archive compact vector<uint> unpack", isa, COUNT * sizeof(int), unpack);
+	});
+}
@@ -0,0 +1,98 @@
+/*
+ *  Copyright (c) 2018 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * @file        bench-record.cpp
+ * @author      Sangwan Kwon (sangwan.kwon@samsung.com)
+ * @brief       Read 2 fields out of 50-field object: unpack all vs record.
+ */
+
+#include "stream/record.hxx"
+
+#include <bench.hxx>
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace rmi::stream;
+
+namespace {
+
+const std::size_t FIELDS = 50;
+const std::size_t ITERATIONS = 10000;
+
+struct Wide : public Archival {
+	void pack(Archive& archive) const override
+	{
+		for (const auto& field : fields)
+			archive << field;
+	}
+
+	void unpack(Archive& archive) override
+	{
+		for (auto& field : fields)
+			archive >> field;
+	}
+
+	std::vector<std::string> fields = std::vector<std::string>(FIELDS);
+};
+
+} // anonymous namespace
+
+TEST(BENCH, RECORD)
+{
+	Wide wide;
+	Record record;
+	for (std::size_t i = 0; i < FIELDS; i++) {
+		wide.fields[i] = "field value which is not small string " + std::to_string(i);
+		record.add(wide.fields[i]);
+	}
+
+	Archive unpacked;
+	unpacked << wide;
+	Archive lazy;
+	lazy << record;
+
+	auto all = bench::measure(ITERATIONS, [&]() {
+		ArchiveView view(unpacked);
+		Wide output;
+		view >> output;
+		bench::keep(output.fields[3].size() + output.fields[42].size());
+	});
+
+	auto two = bench::measure(ITERATIONS, [&]() {
+		ArchiveView view(lazy);
+		Record output;
+		view >> output;
+		bench::keep(output.get<std::string>(3).size() + output.get<std::string>(42).size());
+	});
+
+	auto inPlace = bench::measure(ITERATIONS, [&]() {
+		ArchiveView view(lazy);
+		Record output;
+		view >> output;
+
+		StringView first, second;
+		output.get(3, first);
+		output.get(42, second);
+		bench::keep(first.size() + second.size());
+	});
+
+	bench::report("record/read-2-of-50[unpack]", all, "ns/object");
+	bench::report("record/read-2-of-50[record]", two, "ns/object");
+	bench::report("record/read-2-of-50[record-view]", inPlace, "ns/object");
+}
@@ -0,0 +1,97 @@
+/*
+ *  Copyright (c) 2018 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * @file        bench-serializable.cpp
+ * @author      Sangwan Kwon (sangwan.kwon@samsung.com)
+ * @brief       20-field struct: virtual Archival versus RMI_SERIALIZE.
+ */
+
+#include "stream/archive.hxx"
+#include "stream/archive-view.hxx"
+
+#include <bench.hxx>
+
+#include <gtest/gtest.h>
+
+using namespace rmi::stream;
+
+namespace {
+
+const std::size_t OBJECTS = 1000;
+const std::size_t ITERATIONS = 1000;
+
+struct Fields {
+	int f0 = 0, f1 = 1, f2 = 2, f3 = 3, f4 = 4;
+	long f5 = 5, f6 = 6, f7 = 7, f8 = 8, f9 = 9;
+	double f10 = 10, f11 = 11, f12 = 12, f13 = 13, f14 = 14;
+	unsigned int f15 = 15, f16 = 16, f17 = 17, f18 = 18;
+	bool f19 = true;
+};
+
+struct Virtual : public Archival, public Fields {
+	void pack(Archive& archive) const override
+	{
+		archive << f0 << f1 << f2 << f3 << f4 << f5 << f6 << f7 << f8 << f9
+				<< f10 << f11 << f12 << f13 << f14 << f15 << f16 << f17 << f18 << f19;
+	}
+
+	void unpack(Archive& archive) override
+	{
+		archive >> f0 >> f1 >> f2 >> f3 >> f4 >> f5 >> f6 >> f7 >> f8 >> f9
+				>> f10 >> f11 >> f12 >> f13 >> f14 >> f15 >> f16 >> f17 >> f18 >> f19;
+	}
+};
+
+struct Declared : public Fields {
+	RMI_SERIALIZE(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9,
+				  f10, f11, f12, f13, f14, f15, f16, f17, f18, f19)
+};
+
+template<typename T>
+void run(const std::string& name)
+{
+	std::vector<T> objects(OBJECTS);
+
+	auto pack = bench::measure(ITERATIONS, [&]() {
+		Archive archive;
+		archive.reserve(OBJECTS * SerializedSize<Declared>::size);
+		for (const auto& object : objects)
+			archive << object;
+		bench::keep(archive);
+	});
+
+	Archive archive;
+	for (const auto& object : objects)
+		archive << object;
+
+	auto unpack = bench::measure(ITERATIONS, [&]() {
+		ArchiveView view(archive);
+		for (auto& object : objects)
+			view >> object;
+		bench::keep(objects);
+	});
+
+	bench::report(name + " pack", pack / OBJECTS, "ns/object");
+	bench::report(name + " unpack", unpack / OBJECTS, "ns/object");
+}
+
+} // anonymous namespace
+
+TEST(BENCH, SERIALIZABLE)
+{
+	run<Virtual>("serializable/20-fields[archival]");
+	run<Declared>("serializable/20-fields[declared]");
+}
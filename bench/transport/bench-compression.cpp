@@ -0,0 +1,122 @@
+/*
+ *  Copyright (c) 2018 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * @file        bench-compression.cpp
+ * @author      Sangwan Kwon (sangwan.kwon@samsung.com)
+ * @brief       CPU versus bytes of compression over unix socket.
+ */
+
+#include "stream/compression.hxx"
+#include "transport/connection.hxx"
+#include "transport/socket.hxx"
+
+#include <bench.hxx>
+
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+
+#include <gtest/gtest.h>
+
+using namespace rmi::stream;
+using namespace rmi::transport;
+
+namespace {
+
+const std::size_t MESSAGES = 20;
+
+// Log-like text which is moderately compressible.
+std::string text(std::size_t size)
+{
+	std::srand(0);
+	std::string payload;
+	payload.reserve(size + 128);
+	while (payload.size() < size) {
+		payload += "2018-01-01 00:00:" + std::to_string(std::rand() % 60) +
+				   " INFO rmi: request id " + std::to_string(std::rand()) +
+				   " is dispatched to Foo::method\n";
+	}
+	payload.resize(size);
+
+	return payload;
+}
+
+double roundtrip(const std::string& payload, unsigned int flags)
+{
+	int fds[2];
+	EXPECT_NE(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds), -1);
+
+	Connection client{Socket(fds[0])};
+	Connection server{Socket(fds[1])};
+
+	auto serverThread = std::thread([&]() {
+		Message handshake = server.recv();
+		server.acknowledge(handshake);
+
+		for (std::size_t i = 0; i < MESSAGES; i++) {
+			Message message = server.recv();
+			StringView received;
+			message.disclose(received);
+			bench::keep(received);
+		}
+	});
+
+	client.negotiate(flags);
+	auto ns = bench::measure(MESSAGES, [&]() {
+		Message message(Message::Type::MethodCall, "bench", flags, client.getPool());
+		message.buffer.setReferenceThreshold(Message::REFERENCE_THRESHOLD);
+		message.enclose(payload);
+		client.send(message);
+	});
+
+	serverThread.join();
+
+	return ns;
+}
+
+} // anonymous namespace
+
+TEST(BENCH, COMPRESSION)
+{
+	for (std::size_t size : {4 * 1024, 64 * 1024, 1024 * 1024, 8 * 1024 * 1024}) {
+		auto payload = text(size);
+		auto source = reinterpret_cast<const unsigned char*>(payload.data());
+		std::vector<unsigned char> compressed(compressBound(size));
+
+		std::size_t length = 0;
+		auto compressNs = bench::measure(MESSAGES, [&]() {
+			length = compress(source, size, compressed.data(), compressed.size());
+		});
+
+		std::vector<unsigned char> output(size);
+		auto decompressNs = bench::measure(MESSAGES, [&]() {
+			decompress(compressed.data(), length, output.data(), output.size());
+		});
+
+		auto label = "compression[" + std::to_string(size >> 10) + "KB]";
+		bench::report(label + " ratio", static_cast<double>(length) / size * 100, "% of raw");
+		bench::report(label + " compress", size / compressNs * 1000, "MB/s");
+		bench::report(label + " decompress", size / decompressNs * 1000, "MB/s");
+
+		bench::report(label + " plain", roundtrip(payload, Message::Flag::None) / 1000,
+					  "us/message");
+		bench::report(label + " compressed", roundtrip(payload, Message::Flag::Compressed) / 1000,
+					  "us/message");
+	}
+}
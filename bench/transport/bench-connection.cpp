@@ -0,0 +1,101 @@
+/*
+ *  Copyright (c) 2018 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * @file        bench-connection.cpp
+ * @author      Sangwan Kwon (sangwan.kwon@samsung.com)
+ */
+
+#include "transport/connection.hxx"
+#include "transport/socket.hxx"
+
+#include <bench.hxx>
+
+#include <string>
+#include <thread>
+
+#include <sys/socket.h>
+
+#include <gtest/gtest.h>
+
+using namespace rmi::transport;
+using namespace rmi::stream;
+
+namespace {
+
+const std::size_t MESSAGES = 50;
+
+template<typename F>
+void transfer(const std::string& name, std::size_t payload, F&& send)
+{
+	int fds[2];
+	ASSERT_NE(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds), -1);
+
+	Socket sender(fds[0]);
+	Connection receiver{Socket(fds[1])};
+
+	auto reader = std::thread([&]() {
+		for (std::size_t i = 0; i < MESSAGES; i++)
+			bench::keep(receiver.recv());
+	});
+
+	std::string blob(payload, 'b');
+	auto before = bench::syscalls();
+	auto ns = bench::measure(MESSAGES, [&]() { send(sender, blob); });
+	auto calls = bench::syscalls() - before;
+
+	reader.join();
+
+	auto label = name + "[" + std::to_string(payload >> 10) + "KB]";
+	bench::report(label, ns / 1000, "us/message");
+	bench::report(label, static_cast<double>(calls) / MESSAGES, "syscalls/message");
+}
+
+// Copy arguments into message, then write header and body separately.
+void copying(Socket& socket, const std::string& blob)
+{
+	Message message(Message::Type::MethodCall, "bench");
+	message.enclose(BlobView(reinterpret_cast<const unsigned char*>(blob.data()),
+							 blob.size()));
+
+	socket.send(&message.header);
+	socket.send(message.buffer.get(), message.header.length);
+}
+
+// Reference arguments, then write header and pieces of body at once.
+void gathering(Socket& socket, const std::string& blob)
+{
+	Message message(Message::Type::MethodCall, "bench");
+	message.buffer.setReferenceThreshold(Message::REFERENCE_THRESHOLD);
+	message.enclose(BlobView(reinterpret_cast<const unsigned char*>(blob.data()),
+							 blob.size()));
+
+	auto pieces = message.buffer.gather();
+	std::vector<::iovec> vector = {{&message.header, sizeof(message.header)}};
+	for (const auto& piece : pieces)
+		vector.push_back({const_cast<unsigned char*>(piece.data()), piece.size()});
+
+	socket.sendv(vector.data(), vector.size());
+}
+
+} // anonymous namespace
+
+TEST(BENCH_CONNECTION, SEND_LARGE_ARGUMENT)
+{
+	for (auto payload : {64 * 1024, 1024 * 1024, 8 * 1024 * 1024}) {
+		transfer("connection/send copy+write", payload, copying);
+		transfer("connection/send reference+writev", payload, gathering);
+	}
+}
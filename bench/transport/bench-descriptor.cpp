@@ -0,0 +1,113 @@
+/*
+ *  Copyright (c) 2018 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * @file        bench-descriptor.cpp
+ * @author      Sangwan Kwon (sangwan.kwon@samsung.com)
+ */
+
+#include "transport/connection.hxx"
+#include "transport/socket.hxx"
+
+#include <bench.hxx>
+
+#include <cstring>
+#include <string>
+#include <thread>
+
+#include <sys/socket.h>
+
+#include <gtest/gtest.h>
+
+using namespace rmi::transport;
+using namespace rmi::stream;
+
+namespace {
+
+const std::size_t MESSAGES = 5;
+const std::size_t PAYLOAD = 100 * 1024 * 1024;
+
+// The receiver reads every byte, so both sides pay for the access.
+template<typename E, typename R>
+void transfer(const std::string& name, E&& enclose, R&& read)
+{
+	int fds[2];
+	ASSERT_NE(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds), -1);
+
+	Connection sender{Socket(fds[0])};
+	Connection receiver{Socket(fds[1])};
+	// Over the default limit if the bytes are sent.
+	receiver.setMaxMessageLength(2 * PAYLOAD);
+
+	// Until the receiver has read all.
+	std::size_t sum = 0;
+	auto ns = bench::measure(1, [&]() {
+		auto reader = std::thread([&]() {
+			for (std::size_t i = 0; i < MESSAGES; i++) {
+				Message message = receiver.recv();
+				sum += read(message);
+			}
+		});
+
+		for (std::size_t i = 0; i < MESSAGES; i++) {
+			Message message(Message::Type::MethodCall, "bench");
+			message.buffer.setReferenceThreshold(Message::REFERENCE_THRESHOLD);
+			enclose(message);
+			sender.send(message);
+		}
+
+		reader.join();
+	});
+	bench::keep(sum);
+
+	bench::report(name, ns / MESSAGES / 1000000, "ms/100MB");
+}
+
+std::size_t checksum(const BlobView& view)
+{
+	std::size_t sum = 0;
+	for (std::size_t i = 0; i < view.size(); i += 4096)
+		sum += view[i];
+
+	return sum;
+}
+
+} // anonymous namespace
+
+TEST(BENCH_DESCRIPTOR, SEND_100MB)
+{
+	std::string bytes(PAYLOAD, 'b');
+	transfer("descriptor/bytes through socket",
+		[&](Message& message) {
+			message.enclose(BlobView(reinterpret_cast<const unsigned char*>(bytes.data()),
+									 bytes.size()));
+		},
+		[](Message& message) {
+			BlobView view;
+			message.disclose(view);
+			return checksum(view);
+		});
+
+	SealedBlob blob(PAYLOAD);
+	std::memset(blob.writable(), 'b', PAYLOAD);
+	blob.seal();
+	transfer("descriptor/sealed memfd",
+		[&](Message& message) { message.enclose(blob); },
+		[](Message& message) {
+			SealedBlob mapped;
+			message.disclose(mapped);
+			return checksum(mapped.view());
+		});
+}
@@ -0,0 +1,165 @@
+/*
+ *  Copyright (c) 2018 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * @file        bench-pipeline.cpp
+ * @author      Sangwan Kwon (sangwan.kwon@samsung.com)
+ * @brief       Read syscalls per request under pipelined small calls.
+ */
+
+#include "event/mainloop.hxx"
+#include "transport/connection.hxx"
+#include "transport/decoder.hxx"
+#include "transport/socket.hxx"
+
+#include <bench.hxx>
+
+#include <string>
+#include <thread>
+
+#include <sys/socket.h>
+
+#include <gtest/gtest.h>
+
+using namespace rmi::event;
+using namespace rmi::transport;
+
+namespace {
+
+const std::size_t ROUNDS = 200;
+
+void burst(Connection& client, std::size_t depth)
+{
+	for (std::size_t i = 0; i < depth; i++) {
+		Message message(Message::Type::MethodCall, "Foo::setName");
+		message.enclose(std::string("pipelined"));
+		client.send(message);
+	}
+}
+
+// Drain the buffered burst on the receiver side only.
+template<typename F>
+void drain(const std::string& name, std::size_t depth, F&& receive)
+{
+	int fds[2];
+	ASSERT_NE(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds), -1);
+
+	Connection client{Socket(fds[0])};
+	Connection server{Socket(fds[1])};
+
+	// Reading /proc/self/io is counted too.
+	auto overhead = bench::syscalls();
+	overhead = bench::syscalls() - overhead;
+
+	std::size_t calls = 0;
+	double ns = 0;
+	for (std::size_t round = 0; round < ROUNDS; round++) {
+		burst(client, depth);
+
+		auto before = bench::syscalls();
+		ns += bench::measure(1, [&]() { receive(server, depth); });
+		calls += bench::syscalls() - before - overhead;
+	}
+
+	auto label = name + "[depth " + std::to_string(depth) + "]";
+	bench::report(label, static_cast<double>(calls) / (ROUNDS * depth), "reads/request");
+	bench::report(label, ns / (ROUNDS * depth), "ns/request");
+}
+
+// The former recv(): read exactly the header, then the body.
+void exact(Connection& server, std::size_t depth)
+{
+	static Decoder decoder;
+	for (std::size_t i = 0; i < depth; i++) {
+		while (!decoder.ready()) {
+			auto window = decoder.window();
+			::ssize_t bytes = ::read(server.getFd(), window.data, window.size);
+			decoder.commit(static_cast<std::size_t>(bytes));
+		}
+		bench::keep(decoder.next());
+	}
+}
+
+void blocking(Connection& server, std::size_t depth)
+{
+	for (std::size_t i = 0; i < depth; i++)
+		bench::keep(server.recv());
+}
+
+void batched(Connection& server, std::size_t depth)
+{
+	server.setNonBlocking(true);
+	std::size_t received = 0;
+	while (received < depth) {
+		server.fill();
+		while (server.ready()) {
+			bench::keep(server.next());
+			received++;
+		}
+	}
+}
+
+} // anonymous namespace
+
+TEST(BENCH_PIPELINE, DRAIN)
+{
+	for (std::size_t depth : {1, 16, 256}) {
+		drain("pipeline/exact header+body read", depth, exact);
+		drain("pipeline/batched recv", depth, blocking);
+		drain("pipeline/non-blocking fill", depth, batched);
+	}
+}
+
+// Round trips through the edge-triggered reactor.
+// (read and write calls of both sides, except sendmsg of reactor)
+TEST(BENCH_PIPELINE, REACTOR)
+{
+	for (std::size_t depth : {1, 16, 256}) {
+		int fds[2];
+		ASSERT_NE(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds), -1);
+
+		Connection client{Socket(fds[0])};
+		Connection server{Socket(fds[1])};
+		server.setNonBlocking(true);
+
+		Mainloop mainloop;
+		auto onReadable = [&]() {
+			server.fill();
+			while (server.ready()) {
+				Message request = server.next();
+				Message reply(Message::Type::Reply, request.signature);
+				reply.enclose(true);
+				server.send(reply);
+			}
+		};
+		mainloop.addEdgeHandler(server.getFd(), onReadable, [&]() { server.flush(); });
+		auto reactor = std::thread([&]() { mainloop.run(); });
+
+		auto before = bench::syscalls();
+		auto ns = bench::measure(ROUNDS, [&]() {
+			burst(client, depth);
+			for (std::size_t i = 0; i < depth; i++)
+				bench::keep(client.recv());
+		});
+		auto calls = bench::syscalls() - before;
+
+		mainloop.stop();
+		reactor.join();
+
+		auto label = "pipeline/reactor[depth " + std::to_string(depth) + "]";
+		bench::report(label, static_cast<double>(calls) / (ROUNDS * depth), "syscalls/request");
+		bench::report(label, ns / depth, "ns/request");
+	}
+}
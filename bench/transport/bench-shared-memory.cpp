@@ -0,0 +1,101 @@
+/*
+ *  Copyright (c) 2018 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * @file        bench-shared-memory.cpp
+ * @author      Sangwan Kwon (sangwan.kwon@samsung.com)
+ * @brief       Latency and throughput of unix socket versus shared memory.
+ */
+
+#include "transport/connection.hxx"
+#include "transport/socket.hxx"
+
+#include <bench.hxx>
+
+#include <string>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+using namespace rmi::stream;
+using namespace rmi::transport;
+
+namespace {
+
+const std::size_t CALLS = 20000;
+const std::size_t TRANSFERS = 200;
+
+// Reply true to each request until "stop".
+void serve(Socket& listener)
+{
+	Connection conn(listener.accept());
+	while (true) {
+		Message request = conn.recv();
+		if (request.header.type == Message::Type::Handshake) {
+			conn.acknowledge(request);
+			continue;
+		}
+
+		Message reply(Message::Type::Reply, request.signature);
+		reply.enclose(true);
+		conn.send(reply);
+
+		if (request.signature == "stop")
+			break;
+	}
+}
+
+void run(const std::string& name, unsigned int flags)
+{
+	bench::SocketPath path("shared-memory");
+	Socket listener(path);
+	auto server = std::thread([&]() { serve(listener); });
+
+	Connection conn(path);
+	if (flags != Message::Flag::None)
+		conn.negotiate(flags);
+
+	auto call = [&](const BlobView& payload) {
+		Message request(Message::Type::MethodCall, "bench", conn.getFlags(), conn.getPool());
+		request.buffer.setReferenceThreshold(Message::REFERENCE_THRESHOLD);
+		request.enclose(payload);
+		bench::keep(conn.request(request));
+	};
+
+	std::string small(16, 's');
+	auto latency = bench::measure(CALLS, [&]() {
+		call(BlobView(reinterpret_cast<const unsigned char*>(small.data()), small.size()));
+	});
+
+	std::string large(1024 * 1024, 'l');
+	auto transfer = bench::measure(TRANSFERS, [&]() {
+		call(BlobView(reinterpret_cast<const unsigned char*>(large.data()), large.size()));
+	});
+
+	Message stop(Message::Type::MethodCall, "stop");
+	conn.request(stop);
+	server.join();
+
+	bench::report("shared-memory/" + name + " round trip", latency / 1000, "us/call");
+	bench::report("shared-memory/" + name + " 1MB request", large.size() / transfer, "GB/s");
+}
+
+} // anonymous namespace
+
+TEST(BENCH_SHARED_MEMORY, SOCKET_VERSUS_RING)
+{
+	run("unix socket", Message::Flag::None);
+	run("memfd ring", Message::Flag::SharedMemory);
+}
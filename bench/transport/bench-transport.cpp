@@ -0,0 +1,102 @@
+/*
+ *  Copyright (c) 2018 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * @file        bench-transport.cpp
+ * @author      Sangwan Kwon (sangwan.kwon@samsung.com)
+ */
+
+#include "transport/connection.hxx"
+#include "transport/socket.hxx"
+
+#include <bench.hxx>
+
+#include <string>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+using namespace rmi::stream;
+using namespace rmi::transport;
+
+namespace {
+
+const std::size_t CALLS = 20000;
+const std::size_t TRANSFERS = 200;
+
+// Reply true to each request until "stop".
+void serve(Socket& listener)
+{
+	Connection conn(listener.accept());
+	while (true) {
+		Message request = conn.recv();
+
+		Message reply(Message::Type::Reply, request.signature);
+		reply.enclose(true);
+		conn.send(reply);
+
+		if (request.signature == "stop")
+			break;
+	}
+}
+
+void run(const std::string& name, const std::string& address,
+		 const Socket::Options& options = Socket::Options())
+{
+	Socket listener(address, options);
+	auto server = std::thread([&]() { serve(listener); });
+
+	Connection conn(listener.getAddress(), options);
+
+	auto call = [&](const BlobView& payload) {
+		Message request(Message::Type::MethodCall, "bench", conn.getFlags(), conn.getPool());
+		request.buffer.setReferenceThreshold(Message::REFERENCE_THRESHOLD);
+		request.enclose(payload);
+		bench::keep(conn.request(request));
+	};
+
+	std::string small(16, 's');
+	auto latency = bench::measure(CALLS, [&]() {
+		call(BlobView(reinterpret_cast<const unsigned char*>(small.data()), small.size()));
+	});
+
+	std::string large(1024 * 1024, 'l');
+	auto transfer = bench::measure(TRANSFERS, [&]() {
+		call(BlobView(reinterpret_cast<const unsigned char*>(large.data()), large.size()));
+	});
+
+	Message stop(Message::Type::MethodCall, "stop");
+	conn.request(stop);
+	server.join();
+
+	bench::report("transport/" + name + " round trip", latency / 1000, "us/call");
+	bench::report("transport/" + name + " 1MB request", large.size() / transfer, "GB/s");
+}
+
+} // anonymous namespace
+
+TEST(BENCH_TRANSPORT, UNIX_VERSUS_TCP)
+{
+	bench::SocketPath path("transport");
+	run("unix", "unix:" + path.get());
+	run("tcp ipv4", "tcp:127.0.0.1:0");
+	run("tcp ipv6", "tcp:[::1]:0");
+
+	// The larger buffers take more bytes per system call.
+	Socket::Options options;
+	options.sendBufferSize = 4 * 1024 * 1024;
+	options.recvBufferSize = 4 * 1024 * 1024;
+	run("tcp ipv4 4MB buffers", "tcp:127.0.0.1:0", options);
+}
@@ -0,0 +1,149 @@
+/*
+ *  Copyright (c) 2018 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * @file        batch.cpp
+ * @author      Sangwan Kwon (sangwan.kwon@samsung.com)
+ * @brief       Implementation of batch.
+ */
+
+#include "batch.hxx"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace rmi {
+namespace application {
+
+std::size_t Batch::size(void) const noexcept
+{
+	return this->calls.size();
+}
+
+void Batch::clear(void) noexcept
+{
+	this->calls.clear();
+}
+
+void Batch::pack(Message& message) const
+{
+	// The parameters of all calls are packed in turn, then copied into message
+	// which is reserved at once.
+	stream::Archive parameters;
+	parameters.setEncoding(message.buffer.getEncoding());
+
+	std::vector<std::size_t> ends, descriptorEnds;
+	ends.reserve(this->calls.size());
+	descriptorEnds.reserve(this->calls.size());
+	for (const auto& call : this->calls) {
+		call.pack(parameters);
+		ends.push_back(parameters.size());
+		descriptorEnds.push_back(parameters.getDescriptors().size());
+	}
+	parameters.flatten();
+
+	std::vector<stream::BlobView> views;
+	views.reserve(this->calls.size());
+	std::size_t size = message.buffer.measure(this->calls.size());
+	for (std::size_t i = 0, begin = 0; i < this->calls.size(); begin = ends[i++]) {
+		views.emplace_back(parameters.get() + begin, ends[i] - begin);
+		size += message.buffer.measure(this->calls[i].name, 0u, views.back());
+	}
+	message.buffer.reserve(message.buffer.size() + size);
+
+	message.enclose(this->calls.size());
+
+	const auto& descriptors = parameters.getDescriptors();
+	for (std::size_t i = 0, begin = 0; i < this->calls.size(); begin = descriptorEnds[i++]) {
+		auto count = static_cast<unsigned int>(descriptorEnds[i] - begin);
+		message.enclose(this->calls[i].name, count, views[i]);
+
+		for (std::size_t j = begin; j < descriptorEnds[i]; j++)
+			message.buffer.addDescriptor(descriptors[j]);
+	}
+}
+
+BatchResult::BatchResult(Message&& reply) : reply(std::move(reply))
+{
+	std::size_t count;
+	this->reply.disclose(count);
+
+	// Each entry takes at least a byte.
+	if (count > this->reply.size())
+		throw std::runtime_error("Batch reply is malformed.");
+
+	std::size_t descriptorIndex = 0;
+	this->entries.reserve(count);
+	for (std::size_t i = 0; i < count; i++) {
+		Entry entry = {false, stream::BlobView(), descriptorIndex, 0, std::string()};
+		this->reply.disclose(entry.succeeded);
+
+		if (entry.succeeded)
+			this->reply.disclose(entry.descriptors, entry.result);
+		else
+			this->reply.disclose(entry.error);
+
+		descriptorIndex += entry.descriptors;
+		this->entries.push_back(std::move(entry));
+	}
+
+	if (descriptorIndex > this->reply.buffer.getDescriptors().size())
+		throw std::runtime_error("Batch reply has not enough descriptors.");
+}
+
+std::size_t BatchResult::size(void) const noexcept
+{
+	return this->entries.size();
+}
+
+bool BatchResult::succeeded(std::size_t index) const
+{
+	return this->at(index).succeeded;
+}
+
+const std::string& BatchResult::getError(std::size_t index) const
+{
+	return this->at(index).error;
+}
+
+const BatchResult::Entry& BatchResult::at(std::size_t index) const
+{
+	if (index >= this->entries.size())
+		throw std::out_of_range("Batch has no such call.");
+
+	return this->entries[index];
+}
+
+stream::Archive BatchResult::open(std::size_t index)
+{
+	const auto& entry = this->at(index);
+	if (!entry.succeeded)
+		throw std::runtime_error("Remote call failed: " + entry.error);
+
+	stream::Archive result;
+	result.setEncoding(this->reply.buffer.getEncoding());
+	result.resize(entry.result.size());
+	if (entry.result.size() > 0)
+		std::memcpy(result.get(), entry.result.data(), entry.result.size());
+
+	const auto& descriptors = this->reply.buffer.getDescriptors();
+	for (unsigned int i = 0; i < entry.descriptors; i++)
+		result.addDescriptor(descriptors[entry.descriptorIndex + i]);
+
+	return result;
+}
+
+} // namespace application
+} // namespace rmi
@@ -0,0 +1,129 @@
+/*
+ *  Copyright (c) 2018 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * @file        batch.hxx
+ * @author      Sangwan Kwon (sangwan.kwon@samsung.com)
+ * @brief       Several method calls carried by one message.
+ * @details     The calls are invoked in order on server, and one reply
+ *              holds the result or the error of each call.
+ *              [count] ([name][descriptors][parameters])...
+ *              [count] ([true][descriptors][result] or [false][error])...
+ *              The parameters and results are length-prefixed, so a failed
+ *              call does not affect the following ones.
+ * @usage       Batch batch;
+ *              auto first = batch.add("Foo::setName", name);
+ *              auto second = batch.add("Foo::getName");
+ *              BatchResult result = client.invoke(batch);
+ *              auto ret = result.get<std::string>(second);
+ */
+
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "../transport/message.hxx"
+
+using namespace rmi::transport;
+
+namespace rmi {
+namespace application {
+
+class Batch {
+public:
+	explicit Batch(void) = default;
+
+	// The arguments are copied, and packed when the batch is invoked.
+	// Return the index of call in result.
+	template<typename... Args>
+	std::size_t add(const std::string& name, Args&&... args);
+
+	std::size_t size(void) const noexcept;
+	void clear(void) noexcept;
+
+	// Write the calls with the encoding of message.
+	// (The message should not reference bytes, see setReferenceThreshold.)
+	void pack(Message& message) const;
+
+private:
+	struct Call {
+		std::string name;
+		std::function<void(stream::Archive&)> pack;
+	};
+
+	std::vector<Call> calls;
+};
+
+class BatchResult {
+public:
+	explicit BatchResult(Message&& reply);
+
+	// The entries point into the reply.
+	BatchResult(const BatchResult&) = delete;
+	BatchResult& operator=(const BatchResult&) = delete;
+
+	BatchResult(BatchResult&&) = default;
+	BatchResult& operator=(BatchResult&&) = default;
+
+	std::size_t size(void) const noexcept;
+	bool succeeded(std::size_t index) const;
+	// Empty if the call succeeded.
+	const std::string& getError(std::size_t index) const;
+
+	// Throw std::runtime_error with the error if the call failed.
+	template<typename R>
+	R get(std::size_t index);
+
+private:
+	struct Entry {
+		bool succeeded;
+		stream::BlobView result;
+		std::size_t descriptorIndex;
+		unsigned int descriptors;
+		std::string error;
+	};
+
+	stream::Archive open(std::size_t index);
+	const Entry& at(std::size_t index) const;
+
+	Message reply;
+	std::vector<Entry> entries;
+};
+
+template<typename... Args>
+std::size_t Batch::add(const std::string& name, Args&&... args)
+{
+	this->calls.push_back({name, [args...](stream::Archive& archive) {
+		archive.pack(args...);
+	}});
+
+	return this->calls.size() - 1;
+}
+
+template<typename R>
+R BatchResult::get(std::size_t index)
+{
+	auto result = this->open(index);
+
+	R ret;
+	result >> ret;
+
+	return ret;
+}
+
+} // namespace application
+} // namespace rmi
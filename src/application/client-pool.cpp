@@ -0,0 +1,183 @@
+/*
+ *  Copyright (c) 2018 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * @file        client-pool.cpp
+ * @author      Sangwan Kwon (sangwan.kwon@samsung.com)
+ * @brief       Implementation of client pool.
+ */
+
+#include "client-pool.hxx"
+
+#include <ho/logger.hxx>
+
+using namespace ho;
+
+namespace rmi {
+namespace application {
+
+constexpr std::chrono::milliseconds::rep ClientPool::RETRY_INTERVAL;
+
+ClientPool::ClientPool(const std::vector<std::string>& addresses, std::size_t size,
+					   unsigned int flags, const Socket::Options& options) :
+	flags(flags), options(options)
+{
+	if (addresses.empty() || size == 0)
+		throw std::invalid_argument("Pool should have at least one connection.");
+
+	for (std::size_t i = 0; i < size; i++)
+		for (const auto& address : addresses)
+			this->slots.push_back({address, nullptr, 0, Clock::now(), false});
+
+	this->reconnect(true);
+}
+
+void ClientPool::reconnect(bool force)
+{
+	std::vector<std::size_t> due;
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+
+		auto now = Clock::now();
+		for (std::size_t i = 0; i < this->slots.size(); i++) {
+			auto& slot = this->slots[i];
+			if (slot.client != nullptr || slot.outstanding > 0 || slot.connecting ||
+				(!force && now < slot.retryAt))
+				continue;
+
+			slot.connecting = true;
+			due.push_back(i);
+		}
+	}
+
+	// The address of slot is not changed, so it is read without mutex.
+	for (auto index : due) {
+		const auto& address = this->slots[index].address;
+
+		std::shared_ptr<Client> client;
+		try {
+			client = std::make_shared<Client>(address, this->flags, this->options);
+		} catch (const std::exception& e) {
+			log(ERROR, "Failed to connect to " + address + ": " + e.what());
+		}
+
+		std::lock_guard<std::mutex> lock(this->mutex);
+
+		auto& slot = this->slots[index];
+		slot.connecting = false;
+		slot.client = client;
+		if (client != nullptr)
+			client->setCompressionThreshold(this->compressionThreshold);
+		else
+			slot.retryAt = Clock::now() + std::chrono::milliseconds(RETRY_INTERVAL);
+	}
+}
+
+ClientPool::Lease ClientPool::acquire(void)
+{
+	// The unused ones are reconnected when their turn comes.
+	this->reconnect(false);
+
+	std::lock_guard<std::mutex> lock(this->mutex);
+
+	auto count = this->slots.size();
+	auto start = this->next++ % count;
+
+	Slot* chosen = nullptr;
+	std::size_t index = 0;
+	for (std::size_t i = 0; i < count; i++) {
+		auto current = (start + i) % count;
+		auto& slot = this->slots[current];
+
+		if (slot.client == nullptr)
+			continue;
+
+		if (chosen == nullptr || slot.outstanding < chosen->outstanding) {
+			chosen = &slot;
+			index = current;
+		}
+	}
+
+	if (chosen == nullptr)
+		throw std::runtime_error("No healthy connection in pool.");
+
+	chosen->outstanding++;
+
+	return {index, chosen->client};
+}
+
+void ClientPool::release(const Lease& lease, bool healthy)
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+
+	auto& slot = this->slots[lease.index];
+	slot.outstanding--;
+
+	// The others sharing the broken one fail by themselves.
+	if (!healthy && slot.client == lease.client) {
+		log(ERROR, "Connection to " + slot.address + " is dropped from pool.");
+		slot.client = nullptr;
+		slot.retryAt = Clock::now() + std::chrono::milliseconds(RETRY_INTERVAL);
+	}
+}
+
+std::size_t ClientPool::check(void)
+{
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+
+		// The probe does not block, so it is done under mutex.
+		for (auto& slot : this->slots) {
+			if (slot.client != nullptr && slot.outstanding == 0 && !slot.client->probe()) {
+				log(ERROR, "Connection to " + slot.address + " is dropped from pool.");
+				slot.client = nullptr;
+			}
+		}
+	}
+
+	this->reconnect(true);
+
+	return this->getHealthyCount();
+}
+
+std::size_t ClientPool::size(void) const noexcept
+{
+	return this->slots.size();
+}
+
+std::size_t ClientPool::getHealthyCount(void) const
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+
+	std::size_t healthy = 0;
+	for (const auto& slot : this->slots)
+		if (slot.client != nullptr)
+			healthy++;
+
+	return healthy;
+}
+
+void ClientPool::setCompressionThreshold(std::size_t threshold)
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+
+	this->compressionThreshold = threshold;
+	for (auto& slot : this->slots)
+		if (slot.client != nullptr)
+			slot.client->setCompressionThreshold(threshold);
+}
+
+} // namespace application
+} // namespace rmi
@@ -0,0 +1,132 @@
+/*
+ *  Copyright (c) 2018 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * @file        client-pool.hxx
+ * @author      Sangwan Kwon (sangwan.kwon@samsung.com)
+ * @brief       Pool of clients which routes invocations to the least loaded.
+ * @details     Client serializes a round trip on its connection, so the
+ *              threads sharing one client wait for each other.
+ *              The pool keeps connections to one or more servers, and each
+ *              invocation takes the healthy one with the fewest outstanding.
+ *              The connection which fails on transport is dropped, and
+ *              reconnected after RETRY_INTERVAL. (or by check())
+ *              check() also probes the idle ones of which server is gone.
+ * @usage       ClientPool pool({"unix:/tmp/a", "unix:/tmp/b"}, 4);
+ *              auto name = pool.invoke<std::string>("Foo::getName");
+ */
+
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "client.hxx"
+
+namespace rmi {
+namespace application {
+
+class ClientPool {
+public:
+	// Open size connections to each address. (see Client)
+	// The unreachable ones are retried later instead of failing here.
+	explicit ClientPool(const std::vector<std::string>& addresses, std::size_t size,
+						unsigned int flags = Message::Flag::None,
+						const Socket::Options& options = Socket::Options());
+	virtual ~ClientPool() = default;
+
+	ClientPool(const ClientPool&) = delete;
+	ClientPool& operator=(const ClientPool&) = delete;
+
+	ClientPool(ClientPool&&) = delete;
+	ClientPool& operator=(ClientPool&&) = delete;
+
+	// Throw std::runtime_error if no connection is healthy.
+	template<typename R, typename... Args>
+	R invoke(const std::string& name, Args&&... args);
+
+	// Probe the idle connections and drop the broken ones, reconnect the
+	// unhealthy ones now, and return the healthy count. (see Client::probe)
+	std::size_t check(void);
+
+	std::size_t size(void) const noexcept;
+	std::size_t getHealthyCount(void) const;
+
+	// Applied to the connections opened after this, too.
+	void setCompressionThreshold(std::size_t threshold);
+
+	static constexpr std::chrono::milliseconds::rep RETRY_INTERVAL = 1000;
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	struct Slot {
+		std::string address;
+		// Null while unhealthy.
+		std::shared_ptr<Client> client;
+		std::size_t outstanding;
+		Clock::time_point retryAt;
+		// Being connected without mutex by a thread.
+		bool connecting;
+	};
+
+	struct Lease {
+		std::size_t index;
+		std::shared_ptr<Client> client;
+	};
+
+	Lease acquire(void);
+	void release(const Lease& lease, bool healthy);
+	// Connect the unused unhealthy slots, which are due to retry unless forced.
+	// The mutex is released while connecting, since it takes a round trip.
+	void reconnect(bool force);
+
+	std::vector<Slot> slots;
+	// Ties are broken from here to spread the idle ones.
+	std::size_t next = 0;
+
+	unsigned int flags;
+	Socket::Options options;
+	std::size_t compressionThreshold = Connection::COMPRESSION_THRESHOLD;
+
+	mutable std::mutex mutex;
+};
+
+template<typename R, typename... Args>
+R ClientPool::invoke(const std::string& name, Args&&... args)
+{
+	auto lease = this->acquire();
+
+	try {
+		R ret = lease.client->template invoke<R>(name, std::forward<Args>(args)...);
+		this->release(lease, true);
+
+		return ret;
+	} catch (const std::runtime_error&) {
+		// The failure of remote method is replied on the healthy connection.
+		this->release(lease, !lease.client->isBroken());
+		throw;
+	} catch (...) {
+		this->release(lease, true);
+		throw;
+	}
+}
+
+} // namespace application
+} // namespace rmi
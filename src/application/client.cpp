@@ -21,11 +21,260 @@
 
 #include "client.hxx"
 
+#include <sys/socket.h>
+
+#include <ho/logger.hxx>
+
+using namespace ho;
+
 namespace rmi {
 namespace application {
 
-Client::Client(const std::string& remotePath) : connection(remotePath)
+Client::Client(const std::string& address, unsigned int flags,
+			   const Socket::Options& options) :
+	connection(address, options)
+{
+	if (flags != Message::Flag::None)
+		this->connection.negotiate(flags);
+}
+
+Client::~Client()
+{
+	// Wake up the receiving thread, which fails the pending calls.
+	if (this->receiver.joinable()) {
+		::shutdown(this->connection.getFd(), SHUT_RDWR);
+		this->receiver.join();
+	}
+}
+
+BatchResult Client::invoke(const Batch& batch)
+{
+	Message msg(Message::Type::Batch, "Batch", this->connection.getFlags(),
+				this->connection.getPool());
+	batch.pack(msg);
+
+	return BatchResult(this->roundTrip(msg));
+}
+
+Message Client::roundTrip(Message& call)
+{
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+
+		// The replies are read by the receiving thread once it runs.
+		if (!this->receiver.joinable()) {
+			{
+				std::lock_guard<std::mutex> lock(this->pendingMutex);
+
+				if (this->broken != nullptr)
+					std::rethrow_exception(this->broken);
+			}
+
+			Message reply;
+			try {
+				reply = this->connection.request(call);
+			} catch (...) {
+				this->fail(std::current_exception());
+				throw;
+			}
+
+			if (reply.header.type == Message::Type::Error) {
+				std::string error;
+				reply.disclose(error);
+				throw std::runtime_error(error);
+			}
+
+			return reply;
+		}
+	}
+
+	auto promise = std::make_shared<std::promise<Message>>();
+	auto future = promise->get_future();
+
+	this->submit(call, [promise](Message& reply, std::exception_ptr error) {
+		if (error != nullptr)
+			return promise->set_exception(error);
+
+		promise->set_value(std::move(reply));
+	});
+
+	return future.get();
+}
+
+void Client::submit(Message& call, Completion&& completion)
+{
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+
+		if (!this->receiver.joinable())
+			this->receiver = std::thread(&Client::receive, this);
+	}
+
+	// The failure is told through the completion, as the reply would be.
+	Message none;
+	std::exception_ptr error;
+	{
+		std::lock_guard<std::mutex> lock(this->pendingMutex);
+
+		error = this->broken;
+		if (error == nullptr)
+			this->sending++;
+	}
+
+	if (error != nullptr)
+		return completion(none, error);
+
+	try {
+		// The calls of other threads are sent in parallel. (id is set by send)
+		this->connection.send(call);
+	} catch (...) {
+		this->fail(std::current_exception());
+		{
+			std::lock_guard<std::mutex> lock(this->pendingMutex);
+
+			if (--this->sending == 0)
+				this->arrived.clear();
+		}
+
+		return completion(none, std::current_exception());
+	}
+
+	auto id = call.header.id;
+
+	std::unique_lock<std::mutex> lock(this->pendingMutex);
+
+	Message reply;
+	auto iter = this->arrived.find(id);
+	bool replied = (iter != this->arrived.end());
+	if (replied) {
+		reply = std::move(iter->second);
+		this->arrived.erase(iter);
+	}
+
+	// Once no call is being sent, the rest arrived for nobody.
+	if (--this->sending == 0)
+		this->arrived.clear();
+
+	if (replied) {
+		lock.unlock();
+		return Client::complete(completion, reply);
+	}
+
+	if (this->broken == nullptr) {
+		this->pending.emplace(id, std::move(completion));
+		return;
+	}
+
+	error = this->broken;
+	lock.unlock();
+
+	completion(none, error);
+}
+
+void Client::complete(Completion& completion, Message& reply)
+{
+	if (reply.header.type != Message::Type::Error)
+		return completion(reply, nullptr);
+
+	std::exception_ptr error;
+	try {
+		std::string what;
+		reply.disclose(what);
+		error = std::make_exception_ptr(std::runtime_error(what));
+	} catch (...) {
+		error = std::current_exception();
+	}
+
+	Message none;
+	completion(none, error);
+}
+
+void Client::receive(void)
+{
+	try {
+		while (true) {
+			Message reply = this->connection.recv();
+			auto id = reply.header.id;
+
+			Completion completion;
+			{
+				std::lock_guard<std::mutex> lock(this->pendingMutex);
+
+				auto iter = this->pending.find(id);
+				if (iter == this->pending.end()) {
+					// The call of it may not be registered yet.
+					if (this->sending > 0)
+						this->arrived.emplace(id, std::move(reply));
+					else
+						log(WARN, "Reply of unknown id is dropped: " + std::to_string(id));
+					continue;
+				}
+
+				completion = std::move(iter->second);
+				this->pending.erase(iter);
+			}
+
+			try {
+				Client::complete(completion, reply);
+			} catch (const std::exception& e) {
+				log(ERROR, std::string("Exception in callback: ") + e.what());
+			}
+		}
+	} catch (const std::exception& e) {
+		log(INFO, std::string("Connection is closed: ") + e.what());
+	}
+
+	std::unordered_map<unsigned int, Completion> rest;
+	std::exception_ptr error;
+	{
+		std::lock_guard<std::mutex> lock(this->pendingMutex);
+
+		this->broken = std::make_exception_ptr(std::runtime_error("Connection is broken."));
+		error = this->broken;
+		rest.swap(this->pending);
+	}
+
+	Message none;
+	for (auto& entry : rest) {
+		try {
+			entry.second(none, error);
+		} catch (const std::exception& e) {
+			log(ERROR, std::string("Exception in callback: ") + e.what());
+		}
+	}
+}
+
+bool Client::isBroken(void) const
+{
+	std::lock_guard<std::mutex> lock(this->pendingMutex);
+
+	return this->broken != nullptr;
+}
+
+bool Client::probe(void)
+{
+	if (this->isBroken())
+		return false;
+
+	if (this->connection.isAlive())
+		return true;
+
+	this->fail(std::make_exception_ptr(std::runtime_error("Connection is closed by peer.")));
+
+	return false;
+}
+
+void Client::fail(std::exception_ptr error)
+{
+	std::lock_guard<std::mutex> lock(this->pendingMutex);
+
+	if (this->broken == nullptr)
+		this->broken = error;
+}
+
+void Client::setCompressionThreshold(std::size_t threshold) noexcept
 {
+	this->connection.setCompressionThreshold(threshold);
 }
 
 } // namespace application
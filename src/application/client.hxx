@@ -17,13 +17,25 @@
  * @file        client.hxx
  * @author      Sangwan Kwon (sangwan.kwon@samsung.com)
  * @brief       Client application for invoking remote function(method).
+ * @details     invoke() is a round trip which the other callers wait for.
+ *              invokeAsync() sends the call and returns, so many calls are
+ *              in flight on the connection. Their replies are read by the
+ *              receiving thread of client (started at the first one), and
+ *              matched to the calls by id in any order. (Message::Header::id)
  */
 
 #pragma once
 
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
 #include <string>
 #include <mutex>
+#include <thread>
+#include <unordered_map>
 
+#include "batch.hxx"
 #include "../transport/connection.hxx"
 #include "../transport/message.hxx"
 
@@ -34,8 +46,16 @@ namespace application {
 
 class Client {
 public:
-	explicit Client(const std::string& remotePath);
-	virtual ~Client() = default;
+	// The error is set instead of result if the call failed.
+	template<typename R>
+	using Callback = std::function<void(R result, std::exception_ptr error)>;
+
+	// The flags(Message::Flag) are negotiated with server on connection.
+	// The address is unix:<path> or tcp:<host>:<port>. (see Socket)
+	explicit Client(const std::string& address,
+					unsigned int flags = Message::Flag::None,
+					const Socket::Options& options = Socket::Options());
+	virtual ~Client();
 
 	Client(const Client&) = delete;
 	Client& operator=(const Client&) = delete;
@@ -45,26 +65,137 @@ public:
 
 	template<typename R, typename... Args>
 	R invoke(const std::string& name, Args&&... args);
+	// The calls are sent in one message and answered by one reply.
+	BatchResult invoke(const Batch& batch);
+
+	// The arguments are sent before return, so they need not outlive it.
+	// The calls fail with std::runtime_error if connection is broken,
+	// or if the method is not found or throws on server.
+	template<typename R, typename... Args>
+	std::future<R> invokeAsync(const std::string& name, Args&&... args);
+	// The callback runs on the receiving thread, so it should not block.
+	template<typename R, typename... Args>
+	void invokeAsync(const Callback<R>& callback, const std::string& name, Args&&... args);
+
+	// Compress the request equal or larger than threshold.
+	// (Message::Flag::Compressed should be negotiated.)
+	void setCompressionThreshold(std::size_t threshold) noexcept;
+
+	// True once the connection has failed, then the calls fail with it.
+	// (The error replied by server does not break the connection.)
+	bool isBroken(void) const;
+	// Mark the connection broken if the server is gone, without sending.
+	// Return false if it is broken.
+	bool probe(void);
 
 private:
+	using Completion = std::function<void(Message& reply, std::exception_ptr error)>;
+
+	template<typename... Args>
+	Message compose(const std::string& name, Args&&... args);
+	template<typename R>
+	std::future<R> await(Message& call);
+	// Send the call and wait for its reply.
+	Message roundTrip(Message& call);
+
+	// Send the call, then complete it with the reply of same id.
+	void submit(Message& call, Completion&& completion);
+	// The error reply fails the call with std::runtime_error of server's one.
+	static void complete(Completion& completion, Message& reply);
+	// Run on the receiving thread until the connection is closed.
+	void receive(void);
+	// Marks the connection broken by the error of transport.
+	void fail(std::exception_ptr error);
+
 	Connection connection;
+	// Serializes the round trips of invoke() before going asynchronous.
 	std::mutex mutex;
+
+	std::thread receiver;
+
+	mutable std::mutex pendingMutex;
+	std::unordered_map<unsigned int, Completion> pending;
+	// The replies which arrived before their calls are registered.
+	// They are kept only while calls are being sent, so the ones of unknown
+	// id are dropped.
+	std::unordered_map<unsigned int, Message> arrived;
+	std::size_t sending = 0;
+	std::exception_ptr broken;
 };
 
-template<typename R, typename... Args>
-R Client::invoke(const std::string& name, Args&&... args)
+template<typename... Args>
+Message Client::compose(const std::string& name, Args&&... args)
 {
-	Message msg(Message::Type::MethodCall, name);
+	Message msg(Message::Type::MethodCall, name, this->connection.getFlags(),
+				this->connection.getPool());
+	// The arguments outlive the message, so large ones are not copied.
+	msg.buffer.setReferenceThreshold(Message::REFERENCE_THRESHOLD);
 	msg.enclose(std::forward<Args>(args)...);
 
-	std::lock_guard<std::mutex> lock(this->mutex);
+	return msg;
+}
+
+template<typename R>
+std::future<R> Client::await(Message& call)
+{
+	auto promise = std::make_shared<std::promise<R>>();
+	auto future = promise->get_future();
+
+	this->submit(call, [promise](Message& reply, std::exception_ptr error) {
+		if (error != nullptr)
+			return promise->set_exception(error);
+
+		try {
+			R ret;
+			reply.disclose(ret);
+			promise->set_value(std::move(ret));
+		} catch (...) {
+			promise->set_exception(std::current_exception());
+		}
+	});
 
-	Message reply = this->connection.request(msg);
+	return future;
+}
+
+template<typename R, typename... Args>
+R Client::invoke(const std::string& name, Args&&... args)
+{
+	Message msg = this->compose(name, std::forward<Args>(args)...);
+
+	Message reply = this->roundTrip(msg);
 	R ret;
 	reply.disclose(ret);
 
 	return ret;
 }
 
+template<typename R, typename... Args>
+std::future<R> Client::invokeAsync(const std::string& name, Args&&... args)
+{
+	Message msg = this->compose(name, std::forward<Args>(args)...);
+
+	return this->await<R>(msg);
+}
+
+template<typename R, typename... Args>
+void Client::invokeAsync(const Callback<R>& callback, const std::string& name,
+						 Args&&... args)
+{
+	Message msg = this->compose(name, std::forward<Args>(args)...);
+
+	this->submit(msg, [callback](Message& reply, std::exception_ptr error) {
+		R ret = R();
+		if (error == nullptr) {
+			try {
+				reply.disclose(ret);
+			} catch (...) {
+				error = std::current_exception();
+			}
+		}
+
+		callback(std::move(ret), error);
+	});
+}
+
 } // namespace application
 } // namespace rmi
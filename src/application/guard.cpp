@@ -0,0 +1,87 @@
+/*
+ *  Copyright (c) 2018 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * @file        guard.cpp
+ * @author      Sangwan Kwon (sangwan.kwon@samsung.com)
+ * @brief       Implementation of guard.
+ */
+
+#include "guard.hxx"
+
+#include <stdexcept>
+
+namespace rmi {
+namespace application {
+
+Guard::Scope::Scope(Guard& guard, bool reader) : guard(guard), reader(reader)
+{
+	this->guard.lock(this->reader);
+}
+
+Guard::Scope::~Scope()
+{
+	this->guard.unlock(this->reader);
+}
+
+Guard::Guard(Policy policy) : policy(policy)
+{
+	::pthread_rwlockattr_t attr;
+	::pthread_rwlockattr_init(&attr);
+	::pthread_rwlockattr_setkind_np(&attr, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+
+	int error = ::pthread_rwlock_init(&this->rwlock, &attr);
+	::pthread_rwlockattr_destroy(&attr);
+
+	if (error != 0)
+		throw std::runtime_error("Failed to initialize guard.");
+}
+
+Guard::~Guard()
+{
+	::pthread_rwlock_destroy(&this->rwlock);
+}
+
+void Guard::lock(bool reader)
+{
+	switch (this->policy) {
+	case Policy::None:
+		return;
+	case Policy::ReaderWriter:
+		if (reader) {
+			::pthread_rwlock_rdlock(&this->rwlock);
+			return;
+		}
+		break;
+	case Policy::Exclusive:
+		break;
+	}
+
+	::pthread_rwlock_wrlock(&this->rwlock);
+}
+
+void Guard::unlock(bool)
+{
+	if (this->policy != Policy::None)
+		::pthread_rwlock_unlock(&this->rwlock);
+}
+
+Guard::Policy Guard::getPolicy(void) const noexcept
+{
+	return this->policy;
+}
+
+} // namespace application
+} // namespace rmi
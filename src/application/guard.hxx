@@ -0,0 +1,76 @@
+/*
+ *  Copyright (c) 2018 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * @file        guard.hxx
+ * @author      Sangwan Kwon (sangwan.kwon@samsung.com)
+ * @brief       Concurrency control of the methods of an exposed object.
+ */
+
+#pragma once
+
+#include <pthread.h>
+
+namespace rmi {
+namespace application {
+
+class Guard final {
+public:
+	enum class Policy {
+		// The methods run at once. (The object should be thread-safe.)
+		None,
+		// One method at a time.
+		Exclusive,
+		// The const methods run at once, and the others alone.
+		ReaderWriter
+	};
+
+	// Hold the guard during the scope.
+	class Scope final {
+	public:
+		Scope(Guard& guard, bool reader);
+		~Scope();
+
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+
+	private:
+		Guard& guard;
+		bool reader;
+	};
+
+	explicit Guard(Policy policy);
+	~Guard();
+
+	Guard(const Guard&) = delete;
+	Guard& operator=(const Guard&) = delete;
+
+	Guard(Guard&&) = delete;
+	Guard& operator=(Guard&&) = delete;
+
+	// The reader shares the guard only with ReaderWriter policy.
+	void lock(bool reader);
+	void unlock(bool reader);
+
+	Policy getPolicy(void) const noexcept;
+
+private:
+	Policy policy;
+	// The writers are preferred, so they are not starved by the readers.
+	::pthread_rwlock_t rwlock;
+};
+
+} // namespace application
+} // namespace rmi
@@ -21,27 +21,52 @@
 
 #include "server.hxx"
 
+#include "../stream/archive-view.hxx"
 #include "../transport/message.hxx"
 
 #include <ho/logger.hxx>
 
+#include <cstring>
+
 using namespace ho;
 
 namespace rmi {
 namespace application {
 
+Server::Server(Mainloop::Backend backend) : primary(backend)
+{
+}
+
 void Server::start(void)
 {
-	for (const auto& path : this->socketPaths) {
-		auto socket = std::make_shared<Socket>(path);
+	for (const auto& address : this->addresses) {
+		auto socket = std::make_shared<Socket>(address.first, address.second);
+		if (this->primary.mainloop.getBackend() == Mainloop::Backend::IoUring) {
+			auto onAccepted = [this, socket](int fd) {
+				this->onAccept(std::make_shared<Connection>(socket->adopt(fd)));
+			};
+
+			this->primary.mainloop.addAcceptHandler(socket->getFd(), std::move(onAccepted));
+			continue;
+		}
+
 		auto accept = [this, socket]() {
 			this->onAccept(std::make_shared<Connection>(socket->accept()));
 		};
 
-		this->mainloop.addHandler(socket->getFd(), std::move(accept));
+		this->primary.mainloop.addHandler(socket->getFd(), std::move(accept));
+	}
+
+	for (auto& reactor : this->reactors) {
+		auto mainloop = &reactor->mainloop;
+		reactor->thread = std::thread([mainloop]() { mainloop->run(); });
 	}
 
-	this->mainloop.run();
+	this->primary.mainloop.run();
+
+	// Stopped together by stop().
+	for (auto& reactor : this->reactors)
+		reactor->thread.join();
 }
 
 void Server::stop(void)
@@ -50,15 +75,131 @@ void Server::stop(void)
 		std::lock_guard<std::mutex> lock(this->connectionMutex);
 
 		for (auto iter : this->connectionMap)
-			this->mainloop.removeHandler(iter.first);
+			iter.second.reactor->mainloop.removeHandler(iter.first);
+	}
+
+	for (auto& reactor : this->reactors)
+		reactor->mainloop.stop();
+
+	this->primary.mainloop.stop();
+}
+
+void Server::setReactors(std::size_t count, Balance balance)
+{
+	if (count == 0)
+		throw std::invalid_argument("Server needs a reactor at least.");
+
+	this->reactors.clear();
+	this->balance = balance;
+	this->nextReactor = 0;
+
+	// The calling thread serves the connections by itself.
+	if (count == 1)
+		return;
+
+	auto backend = this->primary.mainloop.getBackend();
+	for (std::size_t i = 0; i < count; i++)
+		this->reactors.emplace_back(new Reactor(backend));
+}
+
+std::vector<std::size_t> Server::getReactorLoads(void) const
+{
+	if (this->reactors.empty())
+		return {this->primary.connections.load()};
+
+	std::vector<std::size_t> loads;
+	for (const auto& reactor : this->reactors)
+		loads.push_back(reactor->connections.load());
+
+	return loads;
+}
+
+void Server::setWorkers(std::size_t count)
+{
+	this->executor.reset(count > 0 ? new Executor(count) : nullptr);
+}
+
+std::vector<Executor::Statistics> Server::getWorkerStatistics(void) const
+{
+	if (this->executor == nullptr)
+		return {};
+
+	return this->executor->getStatistics();
+}
+
+void Server::listen(const std::string& address, const Socket::Options& options)
+{
+	this->addresses[address] = options;
+}
+
+void Server::setCompressionThreshold(std::size_t threshold) noexcept
+{
+	this->compressionThreshold = threshold;
+}
+
+void Server::setWatermarks(std::size_t high, std::size_t low)
+{
+	if (high == 0 || low > high)
+		throw std::invalid_argument("Low watermark should not be over high watermark.");
+
+	this->highWatermark = high;
+	this->lowWatermark = low;
+}
+
+Server::Backpressure Server::getBackpressure(void) const noexcept
+{
+	return {this->paused.load(), this->resumed.load(), this->peakBytes.load()};
+}
+
+Server::Reactor& Server::select(void)
+{
+	if (this->reactors.empty())
+		return this->primary;
+
+	// Called only on the accepting thread.
+	if (this->balance == Balance::RoundRobin)
+		return *this->reactors[this->nextReactor++ % this->reactors.size()];
+
+	auto least = this->reactors.begin();
+	for (auto iter = this->reactors.begin(); iter != this->reactors.end(); iter++) {
+		if ((*iter)->connections < (*least)->connections)
+			least = iter;
 	}
 
-	this->mainloop.stop();
+	return **least;
 }
 
-void Server::listen(const std::string& socketPath)
+void Server::publish(const std::string& name, std::shared_ptr<AbstractFunctor>&& functor,
+					 Concurrency concurrency)
 {
-	this->socketPaths.insert(socketPath);
+	std::lock_guard<std::mutex> lock(this->exposeMutex);
+
+	auto& guard = this->guards[functor->getInstance()];
+	if (guard == nullptr)
+		guard = std::make_shared<Guard>(concurrency);
+	else if (guard->getPolicy() != concurrency)
+		throw std::invalid_argument("Object is already exposed with another concurrency.");
+
+	auto current = std::atomic_load(&this->exposed);
+	std::shared_ptr<ExposedMap> next = current != nullptr ? std::make_shared<ExposedMap>(*current)
+														  : std::make_shared<ExposedMap>();
+	(*next)[name] = {std::move(functor), guard};
+
+	std::atomic_store(&this->exposed, std::shared_ptr<const ExposedMap>(std::move(next)));
+}
+
+std::shared_ptr<const Server::Exposed> Server::find(const std::string& name) const noexcept
+{
+	auto snapshot = std::atomic_load(&this->exposed);
+	if (snapshot == nullptr)
+		return nullptr;
+
+	auto iter = snapshot->find(name);
+	if (iter == snapshot->end())
+		return nullptr;
+
+	// Shares the ownership of snapshot.
+	return std::shared_ptr<const Exposed>(snapshot, &iter->second);
 }
 
 void Server::onAccept(std::shared_ptr<Connection>&& connection)
@@ -66,39 +207,188 @@ void Server::onAccept(std::shared_ptr<Connection>&& connection)
 	if (connection == nullptr)
 		throw std::invalid_argument("Wrong connection.");
 
-	auto onRead = [this, connection]() {
-		std::shared_ptr<Connection> conn;
+	connection->setCompressionThreshold(this->compressionThreshold);
+	connection->setWatermarks(this->highWatermark, this->lowWatermark);
+	// A slow peer should not stall the others on the mainloop.
+	connection->setNonBlocking(true);
+
+	Reactor& reactor = this->select();
+	auto onError = [this, &reactor, connection]() {
+		log(ERROR, std::string("Connection error occured. fd: ") +
+				   std::to_string(connection->getFd()));
+		this->onClose(reactor, connection);
+	};
+
+	auto onWritable = [this, &reactor, connection]() {
+		this->onWritable(reactor, connection);
+	};
 
+	int clientFd = connection->getFd();
+	{
 		std::lock_guard<std::mutex> lock(this->connectionMutex);
 
-		auto iter = this->connectionMap.find(connection->getFd());
-		if (iter == this->connectionMap.end())
-			throw std::runtime_error("Faild to find connection.");
+		this->connectionMap[clientFd] = {connection, &reactor};
+		reactor.connections++;
+	}
 
-		conn = iter->second;
+	if (reactor.mainloop.getBackend() == Mainloop::Backend::IoUring) {
+		// The socket is owned by the multishot receive, so the descriptors
+		// of shared memory can not be read in the middle of message.
+		connection->setSupportedFlags(Connection::SUPPORTED_FLAGS &
+									  ~Message::Flag::SharedMemory);
 
-		this->dispatch(conn);
-	};
+		auto onReceived = [this, &reactor, connection](const unsigned char* bytes,
+													   std::size_t size,
+													   std::vector<int>& fds) {
+			this->onReceive(reactor, connection, bytes, size, fds);
+		};
 
-	auto onError = [this, connection]() {
-		log(ERROR, std::string("Connection error occured. fd: ") +
-				   std::to_string(connection->getFd()));
-		this->onClose(connection);
+		reactor.mainloop.addReceiveHandler(clientFd, std::move(onReceived),
+										   std::move(onWritable), std::move(onError));
+		log(INFO, std::string("Connection is accepted. fd: ") + std::to_string(clientFd));
+		return;
+	}
+
+	auto onReadable = [this, &reactor, connection]() {
+		this->onRead(reactor, connection);
 	};
 
-	int clientFd = connection->getFd();
-	this->mainloop.addHandler(clientFd, std::move(onRead), std::move(onError));
+	// The bytes which arrived before are reported at once.
+	reactor.mainloop.addEdgeHandler(clientFd, std::move(onReadable), std::move(onWritable),
+									std::move(onError));
 	log(INFO, std::string("Connection is accepted. fd: ") + std::to_string(clientFd));
+}
 
-	{
-		std::lock_guard<std::mutex> lock(this->connectionMutex);
+void Server::onRead(Reactor& reactor, const std::shared_ptr<Connection>& connection)
+{
+	// The bytes are left on socket while congested.
+	if (reactor.paused.count(connection->getFd()) != 0 && !this->resume(reactor, connection))
+		return;
+
+	if (!this->process(reactor, connection, false))
+		return;
+
+	// Edge-triggered, so all available bytes should be consumed here.
+	bool closed = false;
+	try {
+		connection->fill();
+	} catch (const std::exception& e) {
+		log(INFO, std::string("Connection is broken: ") + e.what());
+		closed = true;
+	}
+
+	// Reply the received ones even if the peer has shut down writing.
+	this->process(reactor, connection, closed);
+
+	if (closed)
+		this->onClose(reactor, connection);
+}
+
+void Server::onReceive(Reactor& reactor, const std::shared_ptr<Connection>& connection,
+					   const unsigned char* bytes, std::size_t size, std::vector<int>& fds)
+{
+	bool closed = false;
+	try {
+		connection->feed(bytes, size, fds);
+	} catch (const std::exception& e) {
+		log(INFO, std::string("Connection is broken: ") + e.what());
+		closed = true;
+	}
+
+	// The requests are decoded and kept while receiving is paused,
+	// and onWritable() checks the congestion again.
+	if (!this->process(reactor, connection, closed)) {
+		reactor.mainloop.pauseReceive(connection->getFd());
+		reactor.mainloop.watchWritable(connection->getFd());
+	} else if (connection->getPendingBytes() > 0) {
+		// The rest of replies is written once the socket becomes writable.
+		reactor.mainloop.watchWritable(connection->getFd());
+	}
+
+	if (closed)
+		this->onClose(reactor, connection);
+}
+
+void Server::onWritable(Reactor& reactor, const std::shared_ptr<Connection>& connection)
+{
+	bool uring = reactor.mainloop.getBackend() == Mainloop::Backend::IoUring;
+
+	connection->flush();
+	if (reactor.paused.count(connection->getFd()) != 0 && this->resume(reactor, connection)) {
+		// The edge of bytes left on socket is not reported again. (epoll)
+		if (!uring)
+			return this->onRead(reactor, connection);
+
+		if (this->process(reactor, connection, false))
+			reactor.mainloop.resumeReceive(connection->getFd());
+	}
 
-		this->dispatch(connection);
-		this->connectionMap[clientFd] = std::move(connection);
+	if (uring && connection->getPendingBytes() > 0)
+		reactor.mainloop.watchWritable(connection->getFd());
+}
+
+void Server::onNotified(Reactor& reactor, const std::shared_ptr<Connection>& connection)
+{
+	connection->flush();
+
+	// The requests are left in the shared memory while congested, but the
+	// notification is consumed not to be reported again. (level-triggered)
+	if (reactor.paused.count(connection->getFd()) != 0 && !this->resume(reactor, connection))
+		return connection->hold();
+
+	this->onRead(reactor, connection);
+}
+
+bool Server::process(Reactor& reactor, const std::shared_ptr<Connection>& connection,
+					 bool force)
+{
+	while (connection->ready() && (force || !connection->isCongested())) {
+		Message request = connection->next();
+		try {
+			if (request.header.type == Message::Type::Handshake)
+				this->handshake(reactor, connection, request);
+			else
+				this->execute(reactor, connection, std::move(request));
+		} catch (const std::exception& e) {
+			log(ERROR, std::string("Failed to dispatch: ") + e.what());
+		}
+
+		this->updatePeak(connection);
 	}
+
+	if (force || !connection->isCongested())
+		return true;
+
+	if (reactor.paused.insert(connection->getFd()).second) {
+		this->paused++;
+		log(DEBUG, std::string("Reading is paused. fd: ") +
+				   std::to_string(connection->getFd()));
+	}
+
+	return false;
 }
 
-void Server::onClose(const std::shared_ptr<Connection>& connection)
+bool Server::resume(Reactor& reactor, const std::shared_ptr<Connection>& connection)
+{
+	if (connection->isCongested())
+		return false;
+
+	reactor.paused.erase(connection->getFd());
+	this->resumed++;
+	log(DEBUG, std::string("Reading is resumed. fd: ") + std::to_string(connection->getFd()));
+
+	return true;
+}
+
+void Server::updatePeak(const std::shared_ptr<Connection>& connection) noexcept
+{
+	// The reactors and workers update it concurrently.
+	auto pending = connection->getPendingBytes();
+	auto peak = this->peakBytes.load();
+	while (pending > peak && !this->peakBytes.compare_exchange_weak(peak, pending));
+}
+
+void Server::onClose(Reactor& reactor, const std::shared_ptr<Connection>& connection)
 {
 	if (connection == nullptr)
 		throw std::invalid_argument("Wrong connection.");
@@ -110,34 +400,220 @@ void Server::onClose(const std::shared_ptr<Connection>& connection)
 		if (iter == this->connectionMap.end())
 			throw std::runtime_error("Faild to find connection.");
 
-		this->mainloop.removeHandler(iter->first);
+		reactor.mainloop.removeHandler(iter->first);
+		reactor.paused.erase(iter->first);
+		if (connection->getNotifyFd() != -1)
+			reactor.mainloop.removeHandler(connection->getNotifyFd());
 		log(INFO, std::string("Connection is closed. fd: ") + std::to_string(iter->first));
 		this->connectionMap.erase(iter);
+		reactor.connections--;
 	}
 }
 
-void Server::dispatch(const std::shared_ptr<Connection>& connection)
+void Server::handshake(Reactor& reactor, const std::shared_ptr<Connection>& connection,
+					   Message& request)
 {
-	Message request = connection->recv();
-	std::string funcName = request.signature;
+	int notifyFd = connection->getNotifyFd();
+	connection->acknowledge(request);
 
-	{
-		std::lock_guard<std::mutex> lock(this->functorMutex);
+	// The requests come through the shared memory from now.
+	if (notifyFd == -1 && connection->getNotifyFd() != -1) {
+		auto onNotified = [this, &reactor, connection]() {
+			this->onNotified(reactor, connection);
+		};
+		reactor.mainloop.addHandler(connection->getNotifyFd(), std::move(onNotified));
+	}
+}
+
+void Server::execute(Reactor& reactor, const std::shared_ptr<Connection>& connection,
+					 Message&& request)
+{
+	if (this->executor == nullptr)
+		return this->dispatch(connection, request);
+
+	// Shared, since the task should be copyable.
+	auto shared = std::make_shared<Message>(std::move(request));
+	auto task = [this, &reactor, connection, shared]() {
+		bool congested = connection->isCongested();
+		try {
+			this->dispatch(connection, *shared);
+		} catch (const std::exception& e) {
+			log(ERROR, std::string("Failed to dispatch: ") + e.what());
+		}
+
+		this->updatePeak(connection);
+
+		// The rest of reply is flushed by reactor, and the reactor may have
+		// paused reading on the congestion which this reply has cleared.
+		if (connection->getPendingBytes() > 0 || (congested && !connection->isCongested()))
+			reactor.mainloop.watchWritable(connection->getFd());
+	};
+
+	unsigned int flags = connection->getFlags();
+	if (flags & Message::Flag::Ordered)
+		return this->executor->submit(connection.get(), std::move(task));
 
-		auto iter = this->functorMap.find(funcName);
-		if (iter == this->functorMap.end())
+	if (flags & Message::Flag::OrderedPerObject) {
+		// The batch may call several objects, so it is ordered per connection.
+		const void* key = connection.get();
+		if (shared->header.type != Message::Type::Batch) {
+			auto exposed = this->find(shared->signature);
+			if (exposed != nullptr)
+				key = exposed->functor->getInstance();
+		}
+
+		return this->executor->submit(key, std::move(task));
+	}
+
+	this->executor->submit(std::move(task));
+}
+
+void Server::dispatch(const std::shared_ptr<Connection>& connection, Message& request)
+{
+	if (request.header.type == Message::Type::Batch)
+		return this->dispatchBatch(connection, request);
+
+	const std::string& funcName = request.signature;
+
+	Archive result;
+	try {
+		auto exposed = this->find(funcName);
+		if (exposed == nullptr)
 			throw std::runtime_error("Faild to find function.");
 
 		log(DEBUG, "Remote method invokation> " + funcName);
 
-		auto functor = iter->second;
-		auto result = functor->invoke(request.buffer);
+		Guard::Scope scope(*exposed->guard, exposed->functor->isConst());
+		result = exposed->functor->invoke(request.buffer);
+	} catch (const std::exception& e) {
+		// The caller waits for the reply of its id.
+		return this->reject(connection, request, funcName + ": " + e.what());
+	}
 
-		Message reply(Message::Type::Reply, funcName);
-		reply.enclose(result);
+	Message reply(Message::Type::Reply, funcName, request.header.flags,
+				  connection->getPool());
+	reply.header.id = request.header.id;
+	reply.buffer.setReferenceThreshold(Message::REFERENCE_THRESHOLD);
+	reply.enclose(result);
 
-		connection->send(reply);
+	connection->send(reply);
+}
+
+void Server::reject(const std::shared_ptr<Connection>& connection, const Message& request,
+					const std::string& error)
+{
+	log(ERROR, "Failed to invoke> " + error);
+
+	Message reply(Message::Type::Error, request.signature, request.header.flags,
+				  connection->getPool());
+	reply.header.id = request.header.id;
+	reply.enclose(error);
+
+	connection->send(reply);
+}
+
+void Server::dispatchBatch(const std::shared_ptr<Connection>& connection, Message& request)
+{
+	struct Call {
+		std::string name;
+		unsigned int descriptors;
+		BlobView parameters;
+	};
+
+	// A malformed batch is rejected as a whole before any call is invoked.
+	std::vector<Call> calls;
+	try {
+		std::size_t count;
+		request.disclose(count);
+
+		// Each call takes at least a byte.
+		if (count > request.size())
+			throw std::runtime_error("Batch is malformed.");
+
+		std::size_t descriptors = 0;
+		calls.reserve(count);
+		for (std::size_t i = 0; i < count; i++) {
+			Call call;
+			request.disclose(call.name, call.descriptors, call.parameters);
+			descriptors += call.descriptors;
+			calls.push_back(std::move(call));
+		}
+
+		if (descriptors > request.buffer.getDescriptors().size())
+			throw std::runtime_error("Batch has not enough descriptors.");
+	} catch (const std::exception& e) {
+		return this->reject(connection, request, request.signature + ": " + e.what());
+	}
+
+	struct Outcome {
+		bool succeeded;
+		Archive result;
+		std::string error;
+	};
+
+	// The parameters are read in place, and the results are kept until sent.
+	std::vector<Outcome> outcomes(calls.size());
+	const auto& descriptors = request.buffer.getDescriptors();
+	std::size_t descriptorIndex = 0;
+	for (std::size_t i = 0; i < calls.size(); i++) {
+		const auto& call = calls[i];
+		ArchiveView parameters(call.parameters.data(), call.parameters.size());
+		parameters.setEncoding(request.buffer.getEncoding());
+		for (unsigned int j = 0; j < call.descriptors; j++)
+			parameters.addDescriptor(descriptors[descriptorIndex++]);
+
+		// The failure of a call is replied, and the others go on.
+		auto& outcome = outcomes[i];
+		try {
+			auto exposed = this->find(call.name);
+			if (exposed == nullptr)
+				throw std::runtime_error("Faild to find function.");
+
+			log(DEBUG, "Remote method invokation> " + call.name);
+
+			{
+				Guard::Scope scope(*exposed->guard, exposed->functor->isConst());
+				outcome.result = exposed->functor->invoke(parameters);
+			}
+			outcome.result.flatten();
+			outcome.succeeded = true;
+		} catch (const std::exception& e) {
+			outcome.succeeded = false;
+			outcome.error = call.name + ": " + e.what();
+		}
 	}
+
+	Message reply(Message::Type::Reply, request.signature, request.header.flags,
+				  connection->getPool());
+	reply.header.id = request.header.id;
+	// The large results are referenced instead of copied.
+	reply.buffer.setReferenceThreshold(Message::REFERENCE_THRESHOLD);
+
+	std::size_t size = reply.buffer.measure(outcomes.size());
+	for (auto& outcome : outcomes) {
+		if (outcome.succeeded)
+			size += reply.buffer.measure(true, 0u, BlobView(outcome.result.get(),
+															outcome.result.size()));
+		else
+			size += reply.buffer.measure(false, outcome.error);
+	}
+	reply.buffer.reserve(size);
+
+	reply.enclose(outcomes.size());
+	for (auto& outcome : outcomes) {
+		if (!outcome.succeeded) {
+			reply.enclose(false, outcome.error);
+			continue;
+		}
+
+		const auto& results = outcome.result.getDescriptors();
+		reply.enclose(true, static_cast<unsigned int>(results.size()),
+					  BlobView(outcome.result.get(), outcome.result.size()));
+		for (const auto& descriptor : results)
+			reply.buffer.addDescriptor(descriptor);
+	}
+
+	connection->send(reply);
 }
 
 } // namespace application
@@ -21,14 +21,21 @@
 
 #pragma once
 
-#include <set>
+#include <map>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <mutex>
 #include <memory>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "guard.hxx"
 
 #include "../klass/functor.hxx"
 #include "../event/mainloop.hxx"
+#include "../event/executor.hxx"
 #include "../transport/socket.hxx"
 #include "../transport/connection.hxx"
 
@@ -41,7 +48,8 @@ namespace application {
 
 class Server {
 public:
-	explicit Server() = default;
+	// The io_uring backend falls back to epoll if not supported. (see Mainloop)
+	explicit Server(Mainloop::Backend backend = Mainloop::Backend::Epoll);
 	virtual ~Server() = default;
 
 	Server(const Server&) = delete;
@@ -50,38 +58,161 @@ public:
 	Server(Server&&) = delete;
 	Server& operator=(Server&&) = delete;
 
+	// Run the mainloop on the calling thread, and the reactors if set.
 	void start(void);
 	void stop(void);
 
-	void listen(const std::string& socketPath);
-
+	enum class Balance {
+		RoundRobin,
+		// To the reactor which has the fewest connections.
+		LeastLoaded
+	};
+
+	// Serve the connections on count reactor threads, each of which runs its own
+	// mainloop, and only accept them on the calling thread. (before start)
+	// By default (count 1), all are served on the calling thread.
+	void setReactors(std::size_t count, Balance balance = Balance::RoundRobin);
+	// The number of connections on each reactor.
+	std::vector<std::size_t> getReactorLoads(void) const;
+
+	// Invoke the methods on count worker threads, so the reactors keep reading
+	// and writing meanwhile. (before start) By default (count 0), on reactors.
+	// The requests of a connection run in any order unless it is negotiated
+	// with Message::Flag::Ordered or OrderedPerObject.
+	void setWorkers(std::size_t count);
+	std::vector<Executor::Statistics> getWorkerStatistics(void) const;
+
+	// The address is unix:<path> or tcp:<host>:<port>. (see Socket)
+	// The accepted connections take the options.
+	void listen(const std::string& address,
+				const Socket::Options& options = Socket::Options());
+
+	// Applied to the connections accepted after this.
+	void setCompressionThreshold(std::size_t threshold) noexcept;
+	// Reading from a connection is paused while its replies are queued over
+	// high watermark, and resumed once they are flushed down to low watermark.
+	// (see Connection::setWatermarks)
+	void setWatermarks(std::size_t high, std::size_t low);
+
+	struct Backpressure {
+		// How many times reading was paused and resumed.
+		std::size_t paused;
+		std::size_t resumed;
+		// The most reply bytes which were queued at once on a connection.
+		std::size_t peakBytes;
+	};
+	Backpressure getBackpressure(void) const noexcept;
+
+	// The methods of an object run concurrently by its policy, and the const
+	// methods are readers. The methods of other objects run independently.
+	using Concurrency = Guard::Policy;
+
+	// Exposing is visible to the requests being dispatched at once.
+	// Throw std::invalid_argument if the object is exposed with another policy.
 	template<typename O, typename F>
-	void expose(O&& object, const std::string& name, F&& func);
+	void expose(O&& object, const std::string& name, F&& func,
+				Concurrency concurrency = Concurrency::Exclusive);
 
 private:
-	using ConnectionMap = std::unordered_map<int, std::shared_ptr<Connection>>;
+	struct Reactor {
+		explicit Reactor(Mainloop::Backend backend) : mainloop(backend) {}
+
+		Mainloop mainloop;
+		std::thread thread;
+		std::atomic<std::size_t> connections{0};
+		// The connections not being read. (only on the reactor thread)
+		std::unordered_set<int> paused;
+	};
+	// The connection is served on one reactor until it is closed.
+	struct Session {
+		std::shared_ptr<Connection> connection;
+		Reactor* reactor;
+	};
+	using ConnectionMap = std::unordered_map<int, Session>;
+
+	struct Exposed {
+		std::shared_ptr<AbstractFunctor> functor;
+		std::shared_ptr<Guard> guard;
+	};
+	using ExposedMap = std::unordered_map<std::string, Exposed>;
+
+	// Copy the exposed ones with the new one, and swap the snapshot.
+	void publish(const std::string& name, std::shared_ptr<AbstractFunctor>&& functor,
+				 Concurrency concurrency);
+	// Without exposeMutex, and the result keeps its snapshot alive.
+	std::shared_ptr<const Exposed> find(const std::string& name) const noexcept;
+
+	// The reactor which the accepted connection is handed to.
+	Reactor& select(void);
 
 	void onAccept(std::shared_ptr<Connection>&& connection);
-	void onClose(const std::shared_ptr<Connection>& connection);
+	void onRead(Reactor& reactor, const std::shared_ptr<Connection>& connection);
+	void onReceive(Reactor& reactor, const std::shared_ptr<Connection>& connection,
+				   const unsigned char* bytes, std::size_t size, std::vector<int>& fds);
+	void onWritable(Reactor& reactor, const std::shared_ptr<Connection>& connection);
+	// The shared memory has new requests or room for the queued replies.
+	void onNotified(Reactor& reactor, const std::shared_ptr<Connection>& connection);
+	void onClose(Reactor& reactor, const std::shared_ptr<Connection>& connection);
+
+	// Dispatch the received requests, and return false if it stopped
+	// since the connection is congested. (All if force is set)
+	// Then the connection is paused until resume() succeeds.
+	bool process(Reactor& reactor, const std::shared_ptr<Connection>& connection,
+				 bool force);
+	// Return false if the connection is still congested.
+	// (Whoever has flushed the replies, the reactor or the workers.)
+	bool resume(Reactor& reactor, const std::shared_ptr<Connection>& connection);
+	void updatePeak(const std::shared_ptr<Connection>& connection) noexcept;
+
+	void handshake(Reactor& reactor, const std::shared_ptr<Connection>& connection,
+				   Message& request);
+	// Dispatch on the executor if it is set.
+	void execute(Reactor& reactor, const std::shared_ptr<Connection>& connection,
+				 Message&& request);
+	void dispatch(const std::shared_ptr<Connection>& connection, Message& request);
+	// Invoke the calls in order, and reply the result or error of each.
+	void dispatchBatch(const std::shared_ptr<Connection>& connection, Message& request);
+	// Reply the error instead of result, so the caller does not wait forever.
+	void reject(const std::shared_ptr<Connection>& connection, const Message& request,
+				const std::string& error);
+
+	// Accepts, and serves the connections unless there are reactors.
+	Reactor primary;
+	std::vector<std::unique_ptr<Reactor>> reactors;
+	Balance balance = Balance::RoundRobin;
+	std::size_t nextReactor = 0;
+
+	std::map<std::string, Socket::Options> addresses;
 
-	void dispatch(const std::shared_ptr<Connection>& connection);
+	ConnectionMap connectionMap;
+	std::mutex connectionMutex;
 
-	Mainloop mainloop;
+	// The readers load the snapshot atomically, and the former one is freed
+	// once the last of them is done. (std::atomic_load, std::atomic_store)
+	// libstdc++ implements them with a pool of spinlocks, not lock-free.
+	std::shared_ptr<const ExposedMap> exposed;
+	// The guard of each exposed object. (guarded by exposeMutex)
+	std::unordered_map<const void*, std::shared_ptr<Guard>> guards;
+	std::mutex exposeMutex;
 
-	std::set<std::string> socketPaths;
+	std::size_t compressionThreshold = Connection::COMPRESSION_THRESHOLD;
+	std::size_t highWatermark = Connection::HIGH_WATERMARK;
+	std::size_t lowWatermark = Connection::LOW_WATERMARK;
 
-	ConnectionMap connectionMap;
-	std::mutex connectionMutex;
+	std::atomic<std::size_t> paused{0};
+	std::atomic<std::size_t> resumed{0};
+	std::atomic<std::size_t> peakBytes{0};
 
-	FunctorMap functorMap;
-	std::mutex functorMutex;
+	// Destroyed first, since the tasks refer to the others.
+	std::unique_ptr<Executor> executor;
 };
 
 template<typename O, typename F>
-void Server::expose(O&& object, const std::string& name, F&& func)
+void Server::expose(O&& object, const std::string& name, F&& func, Concurrency concurrency)
 {
-	auto functor = make_functor_ptr(std::forward<O>(object), std::forward<F>(func));
-	this->functorMap[name] = functor;
+	std::shared_ptr<AbstractFunctor> functor = make_functor_ptr(std::forward<O>(object),
+																std::forward<F>(func));
+	this->publish(name, std::move(functor), concurrency);
 }
 
 } // namespace application
@@ -0,0 +1,215 @@
+/*
+ *  Copyright (c) 2018 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * @file        executor.cpp
+ * @author      Sangwan Kwon (sangwan.kwon@samsung.com)
+ * @brief       Implementation of executor.
+ */
+
+#include "executor.hxx"
+
+#include <stdexcept>
+
+#include <ho/logger.hxx>
+
+namespace rmi {
+namespace event {
+
+namespace {
+
+// The worker which runs on this thread.
+thread_local const Executor* currentExecutor = nullptr;
+thread_local std::size_t currentWorker = 0;
+
+} // anonymous namespace
+
+Executor::Executor(std::size_t workers) : started(std::chrono::steady_clock::now())
+{
+	if (workers == 0)
+		throw std::invalid_argument("Executor needs a worker at least.");
+
+	for (std::size_t i = 0; i < workers; i++)
+		this->workers.emplace_back(new Worker);
+
+	for (std::size_t i = 0; i < workers; i++)
+		this->workers[i]->thread = std::thread(&Executor::run, this, i);
+}
+
+Executor::~Executor()
+{
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->stopped = true;
+	}
+	this->condition.notify_all();
+
+	for (auto& worker : this->workers)
+		worker->thread.join();
+}
+
+void Executor::submit(Task&& task)
+{
+	this->push(std::move(task));
+}
+
+void Executor::submit(const void* key, Task&& task)
+{
+	{
+		std::lock_guard<std::mutex> lock(this->serialMutex);
+
+		auto& tasks = this->serials[key];
+		tasks.push_back(std::move(task));
+		if (tasks.size() > 1)
+			return;
+	}
+
+	this->push([this, key]() { this->drain(key); });
+}
+
+std::size_t Executor::size(void) const noexcept
+{
+	return this->workers.size();
+}
+
+std::vector<Executor::Statistics> Executor::getStatistics(void) const
+{
+	auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now() - this->started).count();
+
+	std::vector<Statistics> statistics;
+	for (const auto& worker : this->workers) {
+		double busy = static_cast<double>(worker->busy.load());
+		statistics.push_back({worker->executed.load(), worker->steals.load(),
+							  elapsed > 0 ? busy / elapsed : 0.0});
+	}
+
+	return statistics;
+}
+
+void Executor::push(Task&& task)
+{
+	std::size_t index;
+	if (currentExecutor == this)
+		index = currentWorker;
+	else
+		index = this->next++ % this->workers.size();
+
+	{
+		std::lock_guard<std::mutex> lock(this->workers[index]->mutex);
+		this->workers[index]->tasks.push_back(std::move(task));
+	}
+
+	// Notified under mutex, so the worker going to sleep does not miss it.
+	this->queued++;
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->condition.notify_one();
+}
+
+bool Executor::take(std::size_t index, Task& task)
+{
+	auto& own = *this->workers[index];
+	{
+		std::lock_guard<std::mutex> lock(own.mutex);
+		if (!own.tasks.empty()) {
+			task = std::move(own.tasks.front());
+			own.tasks.pop_front();
+			this->queued--;
+			return true;
+		}
+	}
+
+	for (std::size_t i = 1; i < this->workers.size(); i++) {
+		auto& victim = *this->workers[(index + i) % this->workers.size()];
+
+		std::lock_guard<std::mutex> lock(victim.mutex);
+		if (victim.tasks.empty())
+			continue;
+
+		task = std::move(victim.tasks.back());
+		victim.tasks.pop_back();
+		this->queued--;
+		own.steals++;
+		return true;
+	}
+
+	return false;
+}
+
+void Executor::run(std::size_t index)
+{
+	currentExecutor = this;
+	currentWorker = index;
+
+	auto& worker = *this->workers[index];
+	while (true) {
+		Task task;
+		if (!this->take(index, task)) {
+			std::unique_lock<std::mutex> lock(this->mutex);
+			this->condition.wait(lock, [this]() {
+				return this->stopped || this->queued > 0;
+			});
+
+			if (this->stopped && this->queued == 0)
+				return;
+			continue;
+		}
+
+		auto begin = std::chrono::steady_clock::now();
+		try {
+			task();
+		} catch (std::exception& e) {
+			ho::log(DEBUG, std::string("EXCEPTION ON EXECUTOR") + e.what());
+		}
+
+		worker.busy += std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now() - begin).count();
+		worker.executed++;
+	}
+}
+
+void Executor::drain(const void* key)
+{
+	Task task;
+	{
+		std::lock_guard<std::mutex> lock(this->serialMutex);
+
+		// Left as a placeholder, so the later ones are queued behind.
+		task = std::move(this->serials[key].front());
+	}
+
+	try {
+		task();
+	} catch (std::exception& e) {
+		ho::log(DEBUG, std::string("EXCEPTION ON EXECUTOR") + e.what());
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(this->serialMutex);
+
+		auto iter = this->serials.find(key);
+		iter->second.pop_front();
+		if (iter->second.empty()) {
+			this->serials.erase(iter);
+			return;
+		}
+	}
+
+	// One by one, so a long serial does not hold the worker.
+	this->push([this, key]() { this->drain(key); });
+}
+
+} // namespace event
+} // namespace rmi
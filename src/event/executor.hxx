@@ -0,0 +1,108 @@
+/*
+ *  Copyright (c) 2018 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * @file        executor.hxx
+ * @author      Sangwan Kwon (sangwan.kwon@samsung.com)
+ * @brief       Work-stealing thread pool which runs the tasks apart from mainloop.
+ * @details     Each worker has its own queue, and takes the oldest task of it.
+ *              The idle worker steals the newest task of the others.
+ *              The tasks submitted with the same key run one by one in order.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace rmi {
+namespace event {
+
+class Executor final {
+public:
+	using Task = std::function<void(void)>;
+
+	explicit Executor(std::size_t workers);
+	// Run the tasks left, then join the workers.
+	~Executor();
+
+	Executor(const Executor&) = delete;
+	Executor& operator=(const Executor&) = delete;
+
+	Executor(Executor&&) = delete;
+	Executor& operator=(Executor&&) = delete;
+
+	// The task submitted on a worker goes to its own queue.
+	void submit(Task&& task);
+	// The task runs after the former ones of the same key are done.
+	void submit(const void* key, Task&& task);
+
+	std::size_t size(void) const noexcept;
+
+	struct Statistics {
+		// The tasks which the worker ran.
+		std::size_t tasks;
+		// The tasks which the worker took from the others.
+		std::size_t steals;
+		// The ratio of time running tasks since the executor started.
+		double utilization;
+	};
+	std::vector<Statistics> getStatistics(void) const;
+
+private:
+	struct Worker {
+		std::deque<Task> tasks;
+		std::mutex mutex;
+		std::thread thread;
+
+		std::atomic<std::size_t> executed{0};
+		std::atomic<std::size_t> steals{0};
+		std::atomic<std::uint64_t> busy{0};
+	};
+
+	void run(std::size_t index);
+	void push(Task&& task);
+	// Take from own queue, or steal from the others.
+	bool take(std::size_t index, Task& task);
+	// Run the first task of key, and schedule the next one.
+	void drain(const void* key);
+
+	std::vector<std::unique_ptr<Worker>> workers;
+	std::atomic<std::size_t> next{0};
+
+	// The idle workers sleep until a task is queued.
+	std::mutex mutex;
+	std::condition_variable condition;
+	std::atomic<std::size_t> queued{0};
+	bool stopped = false;
+
+	// The first task of each key is running or scheduled.
+	std::mutex serialMutex;
+	std::unordered_map<const void*, std::deque<Task>> serials;
+
+	std::chrono::steady_clock::time_point started;
+};
+
+} // namespace event
+} // namespace rmi
@@ -23,6 +23,7 @@
 
 #include <unistd.h>
 #include <errno.h>
+#include <poll.h>
 
 #include <cstring>
 
@@ -31,41 +32,277 @@
 namespace rmi {
 namespace event {
 
-Mainloop::Mainloop() :
-	epollFd(::epoll_create1(EPOLL_CLOEXEC)),
-	stopped(false)
+namespace {
+
+// The kinds of operation which are submitted for a handler. (io_uring)
+enum Operation : std::uint32_t {
+	Main = 0,
+	Writable = 1,
+	Cancel = 2
+};
+
+// The low bits of token are for operation.
+const std::uint32_t TOKEN_STEP = 4;
+const std::size_t MAX_DESCRIPTORS = 64;
+const std::size_t CONTROL_SIZE = CMSG_SPACE(sizeof(int) * MAX_DESCRIPTORS);
+
+std::uint64_t pack(std::uint32_t token, Operation operation, int fd) noexcept
+{
+	return (static_cast<std::uint64_t>(token | operation) << 32) |
+		   static_cast<std::uint32_t>(fd);
+}
+
+// Take the descriptors out of control messages.
+void take_descriptors(::msghdr& message, std::vector<int>& fds)
+{
+	for (auto header = CMSG_FIRSTHDR(&message); header != nullptr;
+		 header = CMSG_NXTHDR(&message, header)) {
+		if (header->cmsg_level != SOL_SOCKET || header->cmsg_type != SCM_RIGHTS)
+			continue;
+
+		auto count = (header->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+		auto begin = fds.size();
+		fds.resize(begin + count);
+		std::memcpy(fds.data() + begin, CMSG_DATA(header), sizeof(int) * count);
+	}
+}
+
+void close_descriptors(std::vector<int>& fds)
+{
+	for (auto fd : fds)
+		::close(fd);
+	fds.clear();
+}
+
+} // anonymous namespace
+
+constexpr unsigned int Mainloop::URING_ENTRIES;
+constexpr unsigned int Mainloop::URING_BUFFERS;
+constexpr std::size_t Mainloop::URING_BUFFER_SIZE;
+
+Mainloop::Mainloop(Backend backend) : stopped(false)
 {
+	std::memset(&this->header, 0, sizeof(this->header));
+	this->header.msg_controllen = CONTROL_SIZE;
+
+	if (backend == Backend::IoUring && IoUring::isSupported()) {
+		try {
+			this->ring.reset(new IoUring(URING_ENTRIES, URING_BUFFERS, URING_BUFFER_SIZE));
+			return;
+		} catch (const std::runtime_error& e) {
+			ho::log(INFO, std::string("Fall back to epoll: ") + e.what());
+		}
+	}
+
+	this->epollFd = ::epoll_create1(EPOLL_CLOEXEC);
 	if (epollFd == -1)
 		throw std::runtime_error("Failed to create epoll instance.");
 }
 
 Mainloop::~Mainloop()
 {
-	::close(this->epollFd);
+	if (this->epollFd != -1)
+		::close(this->epollFd);
+}
+
+Mainloop::Backend Mainloop::getBackend(void) const noexcept
+{
+	return (this->ring != nullptr) ? Backend::IoUring : Backend::Epoll;
 }
 
 void Mainloop::addHandler(const int fd, OnEvent&& onEvent, OnError&& onError)
+{
+	auto onErrorPtr = (onError != nullptr) ? std::make_shared<OnError>(onError) : nullptr;
+	Handler handler = {std::make_shared<OnEvent>(onEvent), nullptr, std::move(onErrorPtr),
+					   Kind::Level, nullptr, nullptr, 0, false};
+
+	this->addHandler(fd, EPOLLIN | EPOLLHUP | EPOLLRDHUP, std::move(handler));
+}
+
+void Mainloop::addEdgeHandler(const int fd, OnEvent&& onReadable, OnEvent&& onWritable,
+							  OnError&& onError)
+{
+	auto onErrorPtr = (onError != nullptr) ? std::make_shared<OnError>(onError) : nullptr;
+	Handler handler = {std::make_shared<OnEvent>(onReadable),
+					   std::make_shared<OnEvent>(onWritable),
+					   std::move(onErrorPtr), Kind::Edge, nullptr, nullptr, 0, false};
+
+	this->addHandler(fd, EPOLLIN | EPOLLOUT | EPOLLET | EPOLLHUP | EPOLLRDHUP,
+					 std::move(handler));
+}
+
+void Mainloop::addAcceptHandler(const int fd, OnAccept&& onAccept, OnError&& onError)
+{
+	auto onErrorPtr = (onError != nullptr) ? std::make_shared<OnError>(onError) : nullptr;
+	Handler handler = {nullptr, nullptr, std::move(onErrorPtr), Kind::Accept,
+					   std::make_shared<OnAccept>(onAccept), nullptr, 0, false};
+
+	this->addHandler(fd, EPOLLIN, std::move(handler));
+}
+
+void Mainloop::addReceiveHandler(const int fd, OnReceive&& onReceive, OnEvent&& onWritable,
+								 OnError&& onError)
+{
+	auto onErrorPtr = (onError != nullptr) ? std::make_shared<OnError>(onError) : nullptr;
+	Handler handler = {nullptr, std::make_shared<OnEvent>(onWritable), std::move(onErrorPtr),
+					   Kind::Receive, nullptr, std::make_shared<OnReceive>(onReceive), 0, false};
+
+	this->addHandler(fd, EPOLLIN | EPOLLOUT | EPOLLET | EPOLLHUP | EPOLLRDHUP,
+					 std::move(handler));
+}
+
+void Mainloop::addHandler(const int fd, unsigned int events, Handler&& handler)
 {
 	std::lock_guard<Mutex> lock(mutex);
 
 	if (this->listener.find(fd) != this->listener.end())
 		throw std::runtime_error("Event is already registered.");
 
+	if (this->ring != nullptr) {
+		handler.token = (this->nextToken += TOKEN_STEP);
+		this->arm(fd, handler);
+		this->listener.insert({fd, std::move(handler)});
+		return;
+	}
+
 	::epoll_event event;
 	std::memset(&event, 0, sizeof(epoll_event));
 
-	event.events = EPOLLIN | EPOLLHUP | EPOLLRDHUP;
+	event.events = events;
 	event.data.fd = fd;
 
 	if (::epoll_ctl(this->epollFd, EPOLL_CTL_ADD, fd, &event) == -1)
 		throw std::runtime_error("Failed to add event source.");
 
-	auto onEventPtr = std::make_shared<OnEvent>(onEvent);
-	auto onErrorPtr = (onError != nullptr) ? std::make_shared<OnError>(onError) : nullptr;
+	this->listener.insert({fd, std::move(handler)});
+}
 
-	auto handler = std::make_pair(std::move(onEventPtr), std::move(onErrorPtr));
+void Mainloop::arm(const int fd, const Handler& handler)
+{
+	auto entry = this->ring->prepare();
+	entry->fd = fd;
+	entry->user_data = pack(handler.token, Operation::Main, fd);
+
+	switch (handler.kind) {
+	case Kind::Level:
+		// Oneshot, and armed again after the handler. (reported while readable)
+		entry->opcode = IORING_OP_POLL_ADD;
+		entry->poll32_events = POLLIN | POLLRDHUP;
+		break;
+	case Kind::Edge:
+		// Multishot poll is reported on each wakeup as edge-triggered.
+		entry->opcode = IORING_OP_POLL_ADD;
+		entry->poll32_events = POLLIN | POLLOUT | POLLRDHUP;
+		entry->len = IORING_POLL_ADD_MULTI;
+		break;
+	case Kind::Accept:
+		entry->opcode = IORING_OP_ACCEPT;
+		entry->ioprio = IORING_ACCEPT_MULTISHOT;
+		entry->accept_flags = SOCK_CLOEXEC;
+		break;
+	case Kind::Receive:
+		entry->opcode = IORING_OP_RECVMSG;
+		entry->addr = reinterpret_cast<std::uintptr_t>(&this->header);
+		entry->len = 1;
+		entry->ioprio = IORING_RECV_MULTISHOT;
+		entry->flags = IOSQE_BUFFER_SELECT;
+		entry->buf_group = IoUring::BUFFER_GROUP;
+		entry->msg_flags = MSG_CMSG_CLOEXEC;
+		break;
+	}
+
+	this->ring->submit();
+}
+
+void Mainloop::watchWritable(const int fd)
+{
+	std::lock_guard<Mutex> lock(mutex);
+
+	auto iter = this->listener.find(fd);
+	if (iter == this->listener.end())
+		return;
+
+	if (this->ring == nullptr) {
+		if (iter->second.kind != Kind::Edge && iter->second.kind != Kind::Receive)
+			return;
+
+		// Modifying tests the readiness again, so the edge is reported once more
+		// even if nothing was written since the last one.
+		::epoll_event event;
+		std::memset(&event, 0, sizeof(epoll_event));
+		event.events = iter->second.paused ? EPOLLOUT | EPOLLET
+										   : EPOLLIN | EPOLLOUT | EPOLLET | EPOLLHUP | EPOLLRDHUP;
+		event.data.fd = fd;
+
+		if (::epoll_ctl(this->epollFd, EPOLL_CTL_MOD, fd, &event) == -1)
+			throw std::runtime_error("Failed to modify event source.");
+		return;
+	}
+
+	auto entry = this->ring->prepare();
+	entry->opcode = IORING_OP_POLL_ADD;
+	entry->fd = fd;
+	entry->poll32_events = POLLOUT;
+	entry->user_data = pack(iter->second.token, Operation::Writable, fd);
+
+	this->ring->submit();
+}
+
+void Mainloop::pauseReceive(const int fd)
+{
+	std::lock_guard<Mutex> lock(mutex);
+
+	auto iter = this->listener.find(fd);
+	if (iter == this->listener.end() || iter->second.kind != Kind::Receive ||
+		iter->second.paused)
+		return;
+
+	iter->second.paused = true;
+
+	if (this->ring == nullptr) {
+		// Only the writable edges are reported while paused.
+		::epoll_event event;
+		std::memset(&event, 0, sizeof(epoll_event));
+		event.events = EPOLLOUT | EPOLLET;
+		event.data.fd = fd;
+
+		if (::epoll_ctl(this->epollFd, EPOLL_CTL_MOD, fd, &event) == -1)
+			throw std::runtime_error("Failed to modify event source.");
+		return;
+	}
+
+	// The multishot receive is cancelled, and armed again on resume.
+	auto entry = this->ring->prepare();
+	entry->opcode = IORING_OP_ASYNC_CANCEL;
+	entry->addr = pack(iter->second.token, Operation::Main, fd);
+	entry->user_data = pack(iter->second.token, Operation::Cancel, fd);
+
+	this->ring->submit();
+}
+
+void Mainloop::resumeReceive(const int fd)
+{
+	std::lock_guard<Mutex> lock(mutex);
 
-	this->listener.insert({fd, handler});
+	auto iter = this->listener.find(fd);
+	if (iter == this->listener.end() || !iter->second.paused)
+		return;
+
+	iter->second.paused = false;
+
+	if (this->ring == nullptr) {
+		// Modifying tests the readiness again, so the bytes left are reported.
+		::epoll_event event;
+		std::memset(&event, 0, sizeof(epoll_event));
+		event.events = EPOLLIN | EPOLLOUT | EPOLLET | EPOLLHUP | EPOLLRDHUP;
+		event.data.fd = fd;
+
+		if (::epoll_ctl(this->epollFd, EPOLL_CTL_MOD, fd, &event) == -1)
+			throw std::runtime_error("Failed to modify event source.");
+		return;
+	}
+
+	this->arm(fd, iter->second);
 }
 
 void Mainloop::removeHandler(const int fd)
@@ -76,9 +313,23 @@ void Mainloop::removeHandler(const int fd)
 	if (iter == this->listener.end())
 		return;
 
+	auto token = iter->second.token;
 	this->listener.erase(iter);
 
-	::epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, NULL);
+	if (this->ring == nullptr) {
+		::epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, NULL);
+		return;
+	}
+
+	// Cancelled before fd is closed by caller. (The late completions are
+	// told by token, since fd can be reused.)
+	auto entry = this->ring->prepare();
+	entry->opcode = IORING_OP_ASYNC_CANCEL;
+	entry->fd = fd;
+	entry->cancel_flags = IORING_ASYNC_CANCEL_FD | IORING_ASYNC_CANCEL_ALL;
+	entry->user_data = pack(token, Operation::Cancel, fd);
+
+	this->ring->submit();
 }
 
 bool Mainloop::prepare(void)
@@ -90,10 +341,107 @@ bool Mainloop::prepare(void)
 	};
 
 	this->addHandler(this->wakeupSignal.getFd(), wakeup);
+
+	return true;
+}
+
+bool Mainloop::isRegistered(const int fd, const Handler& handler)
+{
+	std::lock_guard<Mutex> lock(mutex);
+
+	// The handler may be removed by the former callback. (and fd reused)
+	auto iter = this->listener.find(fd);
+	return iter != this->listener.end() && iter->second.token == handler.token &&
+		   iter->second.onEvent == handler.onEvent &&
+		   iter->second.onReceive == handler.onReceive &&
+		   iter->second.onAccept == handler.onAccept;
+}
+
+bool Mainloop::isReceiving(const int fd, const Handler& handler)
+{
+	std::lock_guard<Mutex> lock(mutex);
+
+	return this->isRegistered(fd, handler) && !this->listener[fd].paused;
+}
+
+void Mainloop::notify(const Handler& handler, unsigned int events)
+{
+	bool hungup = events & (EPOLLHUP | EPOLLRDHUP | EPOLLERR);
+
+	try {
+		// The edge is not reported again, so drain the data before hangup.
+		if (handler.kind == Kind::Edge) {
+			if (events & EPOLLIN)
+				(*handler.onEvent)();
+			if ((events & EPOLLOUT) && !hungup)
+				(*handler.onWritable)();
+		} else if (!hungup) {
+			(*handler.onEvent)();
+		}
+	} catch (std::exception& e) {
+		ho::log(DEBUG, std::string("EXCEPTION ON MAINLOOP") + e.what());
+	}
+}
+
+void Mainloop::notifyError(const int fd, const Handler& handler)
+{
+	if (handler.onError == nullptr || !this->isRegistered(fd, handler))
+		return;
+
+	try {
+		(*handler.onError)();
+	} catch (std::exception& e) {
+		ho::log(DEBUG, std::string("EXCEPTION ON MAINLOOP") + e.what());
+	}
+}
+
+bool Mainloop::receive(const int fd, const Handler& handler)
+{
+	if (this->input.size() < URING_BUFFER_SIZE)
+		this->input.resize(URING_BUFFER_SIZE);
+
+	unsigned char control[CONTROL_SIZE];
+	while (this->isReceiving(fd, handler)) {
+		::iovec vector = {this->input.data(), this->input.size()};
+		::msghdr message;
+		std::memset(&message, 0, sizeof(message));
+		message.msg_iov = &vector;
+		message.msg_iovlen = 1;
+		message.msg_control = control;
+		message.msg_controllen = sizeof(control);
+
+		auto bytes = ::recvmsg(fd, &message, MSG_DONTWAIT | MSG_CMSG_CLOEXEC);
+		if (bytes == 0)
+			return false;
+
+		if (bytes == -1) {
+			if (errno == EINTR)
+				continue;
+			return errno == EAGAIN || errno == EWOULDBLOCK;
+		}
+
+		take_descriptors(message, this->fds);
+		if (message.msg_flags & MSG_CTRUNC) {
+			close_descriptors(this->fds);
+			return false;
+		}
+
+		try {
+			(*handler.onReceive)(this->input.data(), static_cast<std::size_t>(bytes), this->fds);
+		} catch (std::exception& e) {
+			ho::log(DEBUG, std::string("EXCEPTION ON MAINLOOP") + e.what());
+		}
+		close_descriptors(this->fds);
+	}
+
+	return true;
 }
 
 bool Mainloop::dispatch(int timeout) noexcept
 {
+	if (this->ring != nullptr)
+		return this->dispatchUring(timeout);
+
 	int nfds;
 	::epoll_event event[MAX_EPOLL_EVENTS];
 
@@ -106,36 +454,208 @@ bool Mainloop::dispatch(int timeout) noexcept
 		return false;
 
 	for (int i = 0; i < nfds; i++) {
-		std::shared_ptr<OnEvent> onEvent;
-		std::shared_ptr<OnError> onError;
+		Handler handler;
+		int fd = event[i].data.fd;
 
 		{
 			std::lock_guard<Mutex> lock(mutex);
 
-			auto iter = this->listener.find(event[i].data.fd);
+			auto iter = this->listener.find(fd);
 			if (iter == this->listener.end())
 				continue;
 
-			onEvent = iter->second.first;
-			onError = iter->second.second;
+			handler = iter->second;
 		}
 
-		try {
-			if ((event[i].events & (EPOLLHUP | EPOLLRDHUP))) {
-				if (onError != nullptr)
-					(*onError)();
-			} else {
-				(*onEvent)();
+		auto events = event[i].events;
+		bool hungup = events & (EPOLLHUP | EPOLLRDHUP | EPOLLERR);
+
+		switch (handler.kind) {
+		case Kind::Accept: {
+			int accepted = ::accept4(fd, nullptr, nullptr, SOCK_CLOEXEC);
+			if (accepted == -1) {
+				hungup = errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR &&
+						 errno != ECONNABORTED;
+				break;
 			}
 
-		} catch (std::exception& e) {
-			ho::log(DEBUG, std::string("EXCEPTION ON MAINLOOP") + e.what());
+			try {
+				(*handler.onAccept)(accepted);
+			} catch (std::exception& e) {
+				ho::log(DEBUG, std::string("EXCEPTION ON MAINLOOP") + e.what());
+			}
+			break;
 		}
+		case Kind::Receive:
+			if ((events & EPOLLIN) && !this->receive(fd, handler))
+				hungup = true;
+
+			if ((events & EPOLLOUT) && !hungup) {
+				try {
+					(*handler.onWritable)();
+				} catch (std::exception& e) {
+					ho::log(DEBUG, std::string("EXCEPTION ON MAINLOOP") + e.what());
+				}
+			}
+			break;
+		default:
+			this->notify(handler, events);
+			break;
+		}
+
+		if (hungup)
+			this->notifyError(fd, handler);
 	}
 
 	return true;
 }
 
+bool Mainloop::dispatchUring(int timeout) noexcept
+{
+	try {
+		if (!this->ring->wait(this->completions, timeout))
+			return false;
+	} catch (std::exception& e) {
+		ho::log(ERROR, std::string("EXCEPTION ON MAINLOOP") + e.what());
+		return false;
+	}
+
+	for (const auto& completion : this->completions)
+		this->complete(completion);
+
+	return true;
+}
+
+void Mainloop::complete(const ::io_uring_cqe& completion)
+{
+	int fd = static_cast<int>(completion.user_data & 0xFFFFFFFF);
+	auto key = static_cast<std::uint32_t>(completion.user_data >> 32);
+	auto operation = static_cast<Operation>(key % TOKEN_STEP);
+	auto token = key - operation;
+
+	bool buffered = completion.flags & IORING_CQE_F_BUFFER;
+	auto id = static_cast<std::uint16_t>(completion.flags >> IORING_CQE_BUFFER_SHIFT);
+
+	Handler handler;
+	{
+		std::lock_guard<Mutex> lock(mutex);
+
+		auto iter = this->listener.find(fd);
+		if (operation == Operation::Cancel || iter == this->listener.end() ||
+			iter->second.token != token) {
+			// The late one of removed handler.
+			if (buffered)
+				this->ring->recycle(id);
+			return;
+		}
+
+		handler = iter->second;
+	}
+
+	bool more = completion.flags & IORING_CQE_F_MORE;
+	bool rearm = !more;
+
+	if (operation == Operation::Writable) {
+		if (completion.res > 0 && !(completion.res & (POLLERR | POLLHUP))) {
+			try {
+				(*handler.onWritable)();
+			} catch (std::exception& e) {
+				ho::log(DEBUG, std::string("EXCEPTION ON MAINLOOP") + e.what());
+			}
+		}
+		return;
+	}
+
+	if (completion.res == -ECANCELED)
+		return;
+
+	switch (handler.kind) {
+	case Kind::Level:
+	case Kind::Edge: {
+		if (completion.res < 0) {
+			this->notifyError(fd, handler);
+			return;
+		}
+
+		unsigned int events = static_cast<unsigned int>(completion.res);
+		this->notify(handler, events);
+		if (events & (POLLHUP | POLLRDHUP | POLLERR)) {
+			this->notifyError(fd, handler);
+			rearm = handler.kind == Kind::Level;
+		}
+		break;
+	}
+	case Kind::Accept:
+		if (completion.res >= 0) {
+			try {
+				(*handler.onAccept)(completion.res);
+			} catch (std::exception& e) {
+				ho::log(DEBUG, std::string("EXCEPTION ON MAINLOOP") + e.what());
+			}
+		} else if (completion.res != -EAGAIN && completion.res != -ECONNABORTED &&
+				   completion.res != -EINTR) {
+			this->notifyError(fd, handler);
+		}
+		break;
+	case Kind::Receive:
+		if (buffered) {
+			this->onReceived(fd, handler, completion);
+			this->ring->recycle(id);
+		}
+
+		// Out of the provided buffers, and the rest is left on socket.
+		if (completion.res == -ENOBUFS)
+			break;
+
+		if (completion.res <= 0 || !buffered) {
+			this->notifyError(fd, handler);
+			rearm = false;
+		}
+		break;
+	}
+
+	if (!rearm || !this->isReceiving(fd, handler))
+		return;
+
+	std::lock_guard<Mutex> lock(mutex);
+	this->arm(fd, handler);
+}
+
+void Mainloop::onReceived(const int fd, const Handler& handler, const ::io_uring_cqe& completion)
+{
+	auto id = static_cast<std::uint16_t>(completion.flags >> IORING_CQE_BUFFER_SHIFT);
+	auto buffer = this->ring->getBuffer(id);
+
+	// [out][name][control][payload] (see io_uring_recvmsg_out)
+	std::size_t size = completion.res > 0 ? static_cast<std::size_t>(completion.res) : 0;
+	std::size_t offset = sizeof(::io_uring_recvmsg_out) + this->header.msg_namelen +
+						 this->header.msg_controllen;
+	if (size < offset)
+		return;
+
+	auto out = reinterpret_cast<::io_uring_recvmsg_out*>(buffer);
+	::msghdr message;
+	std::memset(&message, 0, sizeof(message));
+	message.msg_control = buffer + sizeof(*out) + this->header.msg_namelen;
+	message.msg_controllen = out->controllen;
+	take_descriptors(message, this->fds);
+
+	std::size_t length = std::min<std::size_t>(out->payloadlen, size - offset);
+	bool closed = length == 0 && this->fds.empty();
+	if ((out->flags & MSG_CTRUNC) || closed) {
+		close_descriptors(this->fds);
+		this->notifyError(fd, handler);
+		return;
+	}
+
+	try {
+		(*handler.onReceive)(buffer + offset, length, this->fds);
+	} catch (std::exception& e) {
+		ho::log(DEBUG, std::string("EXCEPTION ON MAINLOOP") + e.what());
+	}
+	close_descriptors(this->fds);
+}
+
 void Mainloop::run(int timeout)
 {
 	bool done = false;
@@ -17,11 +17,18 @@
  * @file        mainloop.hxx
  * @author      Sangwan Kwon (sangwan.kwon@samsung.com)
  * @brief       The loop for events.
+ * @details     The backend is chosen at construction.
+ *              - Epoll: readiness events, and the handlers do system calls.
+ *              - IoUring: the readiness is polled on io_uring, and accept and
+ *                receive handlers get the results of multishot operations
+ *                without system calls for each. (provided buffers)
+ *                It falls back to epoll if the kernel does not support.
  */
 
 #pragma once
 
 #include <sys/epoll.h>
+#include <sys/socket.h>
 
 #include <string>
 #include <functional>
@@ -30,8 +37,10 @@
 #include <mutex>
 #include <atomic>
 #include <stdexcept>
+#include <vector>
 
 #include "eventfd.hxx"
+#include "uring.hxx"
 
 namespace rmi {
 namespace event {
@@ -40,8 +49,18 @@ class Mainloop {
 public:
 	using OnEvent = std::function<void(void)>;
 	using OnError = std::function<void(void)>;
-
-	Mainloop();
+	using OnAccept = std::function<void(int fd)>;
+	// The received bytes are valid only during the call,
+	// and the descriptors which are not taken are closed after it.
+	using OnReceive = std::function<void(const unsigned char* data, std::size_t size,
+										 std::vector<int>& fds)>;
+
+	enum class Backend {
+		Epoll,
+		IoUring
+	};
+
+	explicit Mainloop(Backend backend = Backend::Epoll);
 	virtual ~Mainloop();
 
 	Mainloop(const Mainloop&) = delete;
@@ -50,30 +69,100 @@ public:
 	Mainloop(Mainloop&&) = delete;
 	Mainloop& operator=(Mainloop&&) = delete;
 
+	// Level-triggered: onEvent is called while fd is readable.
 	void addHandler(const int fd, OnEvent&& onEvent, OnError&& = nullptr);
+	// Edge-triggered (EPOLLET): each is called once fd becomes readable or
+	// writable, so they should transfer until EAGAIN. (non-blocking fd)
+	// onError is called after them when the peer is hung up.
+	void addEdgeHandler(const int fd, OnEvent&& onReadable, OnEvent&& onWritable,
+						OnError&& onError = nullptr);
+	// Completion-based, so no system call follows each event. (on io_uring)
+	// onAccept takes the accepted fd. (epoll: accept4() on each readable)
+	void addAcceptHandler(const int fd, OnAccept&& onAccept, OnError&& onError = nullptr);
+	// onReceive takes what is received on stream socket with the descriptors.
+	// (epoll: recvmsg() until EAGAIN on each edge, so fd should be non-blocking.)
+	// onError is called when the peer is closed or receiving fails.
+	void addReceiveHandler(const int fd, OnReceive&& onReceive, OnEvent&& onWritable,
+						   OnError&& onError = nullptr);
+	// Call onWritable of the edge or receive handler once fd becomes writable,
+	// even if it is writable already. (It may be called from other threads.)
+	void watchWritable(const int fd);
+	// Stop receiving on fd, so the bytes are left on socket and the sender
+	// blocks once it is full. (The bytes already received are still reported.)
+	// onWritable of receive handler is called while paused.
+	void pauseReceive(const int fd);
+	void resumeReceive(const int fd);
 	void removeHandler(const int fd);
 
 	void run(int timeout = -1);
 	void stop(void);
 
+	Backend getBackend(void) const noexcept;
+
+	static constexpr unsigned int URING_ENTRIES = 256;
+	static constexpr unsigned int URING_BUFFERS = 128;
+	static constexpr std::size_t URING_BUFFER_SIZE = 32 * 1024;
+
 private:
 	// recursive_mutex makes additional calls to lock in calling thread.
 	// And other threads will block (for calls to lock).
 	// So, addHandler() can be called during dispatch().
 	using Mutex = std::recursive_mutex;
-	using Handler = std::pair<std::shared_ptr<OnEvent>, std::shared_ptr<OnError>>;
+	enum class Kind {
+		Level,
+		Edge,
+		Accept,
+		Receive
+	};
+	struct Handler {
+		std::shared_ptr<OnEvent> onEvent;
+		std::shared_ptr<OnEvent> onWritable;
+		std::shared_ptr<OnError> onError;
+		Kind kind;
+		std::shared_ptr<OnAccept> onAccept;
+		std::shared_ptr<OnReceive> onReceive;
+		// Tells the completions of former handler on the same fd. (io_uring)
+		std::uint32_t token;
+		// Receiving is paused. (Kind::Receive)
+		bool paused;
+	};
 	using Listener = std::unordered_map<int, Handler>;
 
+	void addHandler(const int fd, unsigned int events, Handler&& handler);
+
+	bool isRegistered(const int fd, const Handler& handler);
+	// Registered and not paused.
+	bool isReceiving(const int fd, const Handler& handler);
+
 	bool prepare(void);
 
 	bool dispatch(const int timeout) noexcept;
+	bool dispatchUring(const int timeout) noexcept;
+	void notify(const Handler& handler, unsigned int events);
+	void notifyError(const int fd, const Handler& handler);
+
+	// Receive until EAGAIN, and return false if the peer is closed. (epoll)
+	bool receive(const int fd, const Handler& handler);
+	void complete(const ::io_uring_cqe& completion);
+	void onReceived(const int fd, const Handler& handler, const ::io_uring_cqe& completion);
+	// Submit the operation of handler. (under mutex)
+	void arm(const int fd, const Handler& handler);
 
 	Mutex mutex;
 	Listener listener;
 	EventFD wakeupSignal;
 
-	int epollFd;
+	int epollFd = -1;
+	std::unique_ptr<IoUring> ring;
 	std::atomic<bool> stopped;
+	std::uint32_t nextToken = 0;
+
+	// Reused by dispatch thread.
+	std::vector<::io_uring_cqe> completions;
+	std::vector<unsigned char> input;
+	std::vector<int> fds;
+	// The message header of multishot recvmsg. (read by kernel on each)
+	::msghdr header;
 
 	const int MAX_EPOLL_EVENTS = 16;
 };
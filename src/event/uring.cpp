@@ -0,0 +1,286 @@
+/*
+ *  Copyright (c) 2018 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * @file        uring.cpp
+ * @author      Sangwan Kwon (sangwan.kwon@samsung.com)
+ * @brief       Implementation of io_uring.
+ */
+
+#include "uring.hxx"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+namespace rmi {
+namespace event {
+
+namespace {
+
+int io_uring_setup(unsigned int entries, ::io_uring_params* params) noexcept
+{
+	return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+}
+
+int io_uring_register(int fd, unsigned int opcode, void* arg, unsigned int count) noexcept
+{
+	return static_cast<int>(::syscall(__NR_io_uring_register, fd, opcode, arg, count));
+}
+
+unsigned int load_acquire(const unsigned int* value) noexcept
+{
+	return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+}
+
+void store_release(unsigned int* value, unsigned int desired) noexcept
+{
+	__atomic_store_n(value, desired, __ATOMIC_RELEASE);
+}
+
+template<typename T>
+T* at(void* base, std::size_t offset) noexcept
+{
+	return reinterpret_cast<T*>(reinterpret_cast<unsigned char*>(base) + offset);
+}
+
+} // anonymous namespace
+
+constexpr std::uint16_t IoUring::BUFFER_GROUP;
+
+bool IoUring::isSupported(void) noexcept
+{
+	::io_uring_params params;
+	std::memset(&params, 0, sizeof(params));
+
+	int fd = io_uring_setup(2, &params);
+	if (fd == -1)
+		return false;
+
+	// The opcode of Linux 6.0 tells multishot recv is also there.
+	std::vector<unsigned char> memory(sizeof(::io_uring_probe) +
+									  256 * sizeof(::io_uring_probe_op));
+	auto probe = reinterpret_cast<::io_uring_probe*>(memory.data());
+	bool supported = (params.features & IORING_FEAT_SINGLE_MMAP) &&
+					 (params.features & IORING_FEAT_NODROP) &&
+					 io_uring_register(fd, IORING_REGISTER_PROBE, probe, 256) == 0 &&
+					 probe->last_op >= IORING_OP_SEND_ZC;
+
+	::close(fd);
+
+	return supported;
+}
+
+IoUring::IoUring(unsigned int entries, unsigned int bufferCount, std::size_t bufferSize) :
+	bufferCount(bufferCount), bufferSize(bufferSize)
+{
+	if (bufferCount == 0 || bufferCount > 32768 || (bufferCount & (bufferCount - 1)) != 0)
+		throw std::invalid_argument("Count of buffers should be power of 2.");
+
+	::io_uring_params params;
+	std::memset(&params, 0, sizeof(params));
+	// The completions are not dropped while the handlers run.
+	params.flags = IORING_SETUP_CQSIZE;
+	params.cq_entries = entries * 4;
+
+	this->fd = io_uring_setup(entries, &params);
+	if (this->fd == -1)
+		throw std::runtime_error("Failed to set up io_uring.");
+
+	this->sqSize = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+	this->cqSize = params.cq_off.cqes + params.cq_entries * sizeof(::io_uring_cqe);
+	if (params.features & IORING_FEAT_SINGLE_MMAP)
+		this->sqSize = this->cqSize = std::max(this->sqSize, this->cqSize);
+
+	this->sqMemory = ::mmap(nullptr, this->sqSize, PROT_READ | PROT_WRITE,
+							MAP_SHARED | MAP_POPULATE, this->fd, IORING_OFF_SQ_RING);
+	if (this->sqMemory == MAP_FAILED) {
+		::close(this->fd);
+		throw std::runtime_error("Failed to map submission queue.");
+	}
+
+	this->cqMemory = this->sqMemory;
+	if (!(params.features & IORING_FEAT_SINGLE_MMAP)) {
+		this->cqMemory = ::mmap(nullptr, this->cqSize, PROT_READ | PROT_WRITE,
+								MAP_SHARED | MAP_POPULATE, this->fd, IORING_OFF_CQ_RING);
+		if (this->cqMemory == MAP_FAILED) {
+			::munmap(this->sqMemory, this->sqSize);
+			::close(this->fd);
+			throw std::runtime_error("Failed to map completion queue.");
+		}
+	}
+
+	this->entriesSize = params.sq_entries * sizeof(::io_uring_sqe);
+	auto memory = ::mmap(nullptr, this->entriesSize, PROT_READ | PROT_WRITE,
+						 MAP_SHARED | MAP_POPULATE, this->fd, IORING_OFF_SQES);
+	this->entries = reinterpret_cast<::io_uring_sqe*>(memory);
+
+	this->sqHead = at<unsigned int>(this->sqMemory, params.sq_off.head);
+	this->sqTail = at<unsigned int>(this->sqMemory, params.sq_off.tail);
+	this->sqMask = at<unsigned int>(this->sqMemory, params.sq_off.ring_mask);
+	this->sqArray = at<unsigned int>(this->sqMemory, params.sq_off.array);
+	this->cqHead = at<unsigned int>(this->cqMemory, params.cq_off.head);
+	this->cqTail = at<unsigned int>(this->cqMemory, params.cq_off.tail);
+	this->cqMask = at<unsigned int>(this->cqMemory, params.cq_off.ring_mask);
+	this->cqes = at<::io_uring_cqe>(this->cqMemory, params.cq_off.cqes);
+
+	// The buffer ring and the buffers are page aligned.
+	this->bufferRingSize = bufferCount * sizeof(::io_uring_buf);
+	auto ring = ::mmap(nullptr, this->bufferRingSize, PROT_READ | PROT_WRITE,
+					   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	auto pool = ::mmap(nullptr, bufferCount * bufferSize, PROT_READ | PROT_WRITE,
+					   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	this->bufferRing = reinterpret_cast<::io_uring_buf_ring*>(ring);
+	this->buffers = reinterpret_cast<unsigned char*>(pool);
+
+	::io_uring_buf_reg registration;
+	std::memset(&registration, 0, sizeof(registration));
+	registration.ring_addr = reinterpret_cast<std::uintptr_t>(ring);
+	registration.ring_entries = bufferCount;
+	registration.bgid = BUFFER_GROUP;
+
+	if (memory == MAP_FAILED || ring == MAP_FAILED || pool == MAP_FAILED ||
+		io_uring_register(this->fd, IORING_REGISTER_PBUF_RING, &registration, 1) != 0) {
+		if (memory != MAP_FAILED)
+			::munmap(memory, this->entriesSize);
+		if (ring != MAP_FAILED)
+			::munmap(ring, this->bufferRingSize);
+		if (pool != MAP_FAILED)
+			::munmap(pool, bufferCount * bufferSize);
+		if (this->cqMemory != this->sqMemory)
+			::munmap(this->cqMemory, this->cqSize);
+		::munmap(this->sqMemory, this->sqSize);
+		::close(this->fd);
+		throw std::runtime_error("Failed to provide buffers to io_uring.");
+	}
+
+	for (unsigned int i = 0; i < bufferCount; i++)
+		this->recycle(static_cast<std::uint16_t>(i));
+}
+
+IoUring::~IoUring(void)
+{
+	::munmap(this->entries, this->entriesSize);
+	::munmap(this->bufferRing, this->bufferRingSize);
+	::munmap(this->buffers, this->bufferCount * this->bufferSize);
+	if (this->cqMemory != this->sqMemory)
+		::munmap(this->cqMemory, this->cqSize);
+	::munmap(this->sqMemory, this->sqSize);
+	::close(this->fd);
+}
+
+::io_uring_sqe* IoUring::prepare(void)
+{
+	unsigned int tail = *this->sqTail + this->prepared;
+	if (tail - load_acquire(this->sqHead) > *this->sqMask) {
+		this->submit();
+		tail = *this->sqTail;
+	}
+
+	unsigned int index = tail & *this->sqMask;
+	this->sqArray[index] = index;
+	this->prepared++;
+
+	auto entry = &this->entries[index];
+	std::memset(entry, 0, sizeof(*entry));
+
+	return entry;
+}
+
+void IoUring::submit(void)
+{
+	if (this->prepared == 0)
+		return;
+
+	store_release(this->sqTail, *this->sqTail + this->prepared);
+	auto count = this->prepared;
+	this->prepared = 0;
+
+	while (count > 0) {
+		int submitted = this->enter(count, 0, 0, nullptr, 0);
+		if (submitted < 0) {
+			if (errno == EINTR || errno == EAGAIN || errno == EBUSY)
+				continue;
+			throw std::runtime_error("Failed to submit to io_uring.");
+		}
+
+		count -= static_cast<unsigned int>(submitted);
+	}
+}
+
+bool IoUring::wait(std::vector<::io_uring_cqe>& completions, int timeout)
+{
+	completions.clear();
+
+	unsigned int head = *this->cqHead;
+	if (load_acquire(this->cqTail) == head) {
+		::__kernel_timespec time = {timeout / 1000, (timeout % 1000) * 1000000L};
+		::io_uring_getevents_arg arg;
+		std::memset(&arg, 0, sizeof(arg));
+		if (timeout >= 0)
+			arg.ts = reinterpret_cast<std::uintptr_t>(&time);
+
+		if (this->enter(0, 1, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG,
+						&arg, sizeof(arg)) < 0 &&
+			errno != EINTR && errno != ETIME)
+			throw std::runtime_error("Failed to wait for io_uring.");
+	}
+
+	unsigned int tail = load_acquire(this->cqTail);
+	for (; head != tail; head++)
+		completions.push_back(this->cqes[head & *this->cqMask]);
+	store_release(this->cqHead, head);
+
+	return !completions.empty();
+}
+
+unsigned char* IoUring::getBuffer(std::uint16_t id) const noexcept
+{
+	return this->buffers + static_cast<std::size_t>(id) * this->bufferSize;
+}
+
+std::size_t IoUring::getBufferSize(void) const noexcept
+{
+	return this->bufferSize;
+}
+
+void IoUring::recycle(std::uint16_t id) noexcept
+{
+	// The entries start at the ring, not at bufs which C++ may place after
+	// the empty member of __DECLARE_FLEX_ARRAY.
+	auto entries = reinterpret_cast<::io_uring_buf*>(this->bufferRing);
+	auto& entry = entries[this->bufferTail & (this->bufferCount - 1)];
+	entry.addr = reinterpret_cast<std::uintptr_t>(this->getBuffer(id));
+	entry.len = static_cast<unsigned int>(this->bufferSize);
+	entry.bid = id;
+
+	this->bufferTail++;
+	__atomic_store_n(&this->bufferRing->tail, this->bufferTail, __ATOMIC_RELEASE);
+}
+
+int IoUring::enter(unsigned int submit, unsigned int complete, unsigned int flags,
+				   const void* arg, std::size_t size) noexcept
+{
+	return static_cast<int>(::syscall(__NR_io_uring_enter, this->fd, submit, complete,
+									  flags, arg, size));
+}
+
+} // namespace event
+} // namespace rmi
@@ -0,0 +1,104 @@
+/*
+ *  Copyright (c) 2018 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * @file        uring.hxx
+ * @author      Sangwan Kwon (sangwan.kwon@samsung.com)
+ * @brief       Minimal io_uring on system calls. (without liburing)
+ * @details     The submission entries are prepared under the caller's lock,
+ *              and the completions are consumed by a single thread.
+ *              The buffers of group 0 are provided to the kernel through
+ *              the buffer ring, so multishot receives pick them by itself.
+ */
+
+#pragma once
+
+#include <linux/io_uring.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace rmi {
+namespace event {
+
+class IoUring final {
+public:
+	// Throw std::runtime_error if the kernel does not support. (see isSupported)
+	explicit IoUring(unsigned int entries, unsigned int bufferCount,
+					 std::size_t bufferSize);
+	~IoUring(void);
+
+	IoUring(const IoUring&) = delete;
+	IoUring& operator=(const IoUring&) = delete;
+
+	IoUring(IoUring&&) = delete;
+	IoUring& operator=(IoUring&&) = delete;
+
+	// Multishot accept/recv and the buffer ring are available. (Linux 6.0+)
+	static bool isSupported(void) noexcept;
+
+	// Return the cleared entry, submitting the prepared ones if it is full.
+	::io_uring_sqe* prepare(void);
+	// Submit the prepared entries.
+	void submit(void);
+	// Wait for completions, then take them out in order.
+	// Return false on timeout. (-1: infinite, in milliseconds)
+	// (Only this is called without the lock of prepare() and submit().)
+	bool wait(std::vector<::io_uring_cqe>& completions, int timeout);
+
+	// The provided buffer of the completion which has IORING_CQE_F_BUFFER.
+	unsigned char* getBuffer(std::uint16_t id) const noexcept;
+	std::size_t getBufferSize(void) const noexcept;
+	// Give back the buffer to be picked again.
+	void recycle(std::uint16_t id) noexcept;
+
+	static constexpr std::uint16_t BUFFER_GROUP = 0;
+
+private:
+	int enter(unsigned int submit, unsigned int complete, unsigned int flags,
+			  const void* arg, std::size_t size) noexcept;
+
+	int fd;
+
+	void* sqMemory;
+	std::size_t sqSize;
+	void* cqMemory;
+	std::size_t cqSize;
+	::io_uring_sqe* entries;
+	std::size_t entriesSize;
+
+	unsigned int* sqHead;
+	unsigned int* sqTail;
+	unsigned int* sqMask;
+	unsigned int* sqArray;
+	unsigned int* cqHead;
+	unsigned int* cqTail;
+	unsigned int* cqMask;
+	::io_uring_cqe* cqes;
+
+	// The prepared entries which are not submitted.
+	unsigned int prepared = 0;
+
+	::io_uring_buf_ring* bufferRing;
+	std::size_t bufferRingSize;
+	unsigned char* buffers;
+	unsigned int bufferCount;
+	std::size_t bufferSize;
+	std::uint16_t bufferTail = 0;
+};
+
+} // namespace event
+} // namespace rmi
@@ -21,6 +21,7 @@
 
 #pragma once
 
+#include <tuple>
 #include <type_traits>
 
 namespace rmi {
@@ -33,21 +34,36 @@ using remove_ref_t = typename std::remove_reference<T>::type;
 template<typename T>
 using remove_cv_ref_t = remove_cv_t<remove_ref_t<T>>;
 
+// The const member function is held with const Klass.
+template<typename R, typename K, typename... Ps>
+struct MemberPointer {
+	using Type = R (K::*)(Ps...);
+};
+
+template<typename R, typename K, typename... Ps>
+struct MemberPointer<R, const K, Ps...> {
+	using Type = R (K::*)(Ps...) const;
+};
+
 template<typename R, typename K, typename... Ps>
 class Function {
 public:
 	using Klass = K;
 	using Return = R;
 	using Parameters = std::tuple<remove_cv_ref_t<Ps>...>;
-	using Pointer = Return (Klass::*)(Ps...);
+	using Pointer = typename MemberPointer<R, K, Ps...>::Type;
 
 	auto get(void) noexcept -> const Pointer&;
+	// The const member function does not change the instance.
+	constexpr bool isConst(void) const noexcept;
 
 private:
 	explicit Function(Pointer pointer);
 
 	template<typename RR, typename KK, typename... PPs>
 	friend Function<RR, KK, PPs...> make_function(RR (KK::* member)(PPs...));
+	template<typename RR, typename KK, typename... PPs>
+	friend Function<RR, const KK, PPs...> make_function(RR (KK::* member)(PPs...) const);
 
 	Pointer pointer;
 };
@@ -63,6 +79,12 @@ auto Function<R, K, Ps...>::get(void) noexcept -> const Pointer&
 	return this->pointer;
 }
 
+template<typename R, typename K, typename... Ps>
+constexpr bool Function<R, K, Ps...>::isConst(void) const noexcept
+{
+	return std::is_const<K>::value;
+}
+
 template<typename R, typename K, typename... Ps>
 Function<R, K, Ps...> make_function(R (K::* member)(Ps...))
 {
@@ -75,5 +97,17 @@ Function<R, K, Ps...> make_function(R (K::* member)(Ps...))
 	return Function<R, K, Ps...>(member);
 }
 
+template<typename R, typename K, typename... Ps>
+Function<R, const K, Ps...> make_function(R (K::* member)(Ps...) const)
+{
+	constexpr bool notVoid = !(std::is_same<R, void>::value);
+	static_assert(notVoid, "Return type cannot be void.");
+
+	using IsValid = std::is_member_function_pointer<decltype(member)>;
+	static_assert(IsValid::value, "Pamameter should be member function type.");
+
+	return Function<R, const K, Ps...>(member);
+}
+
 } // namespace klass
 } // namespace rmi
@@ -23,7 +23,6 @@
 
 #include <memory>
 #include <unordered_map>
-#include <functional>
 #include <stdexcept>
 
 #include "function.hxx"
@@ -40,6 +39,11 @@ struct AbstractFunctor {
 	R invoke(Args&&... args);
 	inline Archive invoke(Archive& archive);
 
+	// The object which the method is called on.
+	virtual const void* getInstance(void) const noexcept = 0;
+	// The method is const member function.
+	virtual bool isConst(void) const noexcept = 0;
+
 protected:
 	virtual Archive dispatch(Archive& archive) = 0;
 };
@@ -51,7 +55,6 @@ class Functor : public AbstractFunctor {
 public:
 	using Klass = K;
 	using MemFunc = Function<R, K, Ps...>;
-	using Invokable = std::function<R(K&, Ps...)>;
 
 	explicit Functor(std::shared_ptr<Klass> instance, MemFunc memFunc);
 
@@ -59,6 +62,9 @@ public:
 	auto operator()(Args&&... args) -> typename MemFunc::Return;
 	inline auto operator()(Archive& archive) -> typename MemFunc::Return;
 
+	inline const void* getInstance(void) const noexcept override;
+	inline bool isConst(void) const noexcept override;
+
 protected:
 	inline Archive dispatch(Archive& archive) override;
 
@@ -99,8 +105,7 @@ template<typename R, typename K, typename... Ps>
 template<typename... Args>
 auto Functor<R, K, Ps...>::operator()(Args&&... args) -> typename MemFunc::Return
 {
-	const Invokable& invokable = this->memFunc.get();
-	return invokable(*this->instance, std::forward<Args>(args)...);
+	return (this->instance.get()->*this->memFunc.get())(std::forward<Args>(args)...);
 }
 
 template<typename R, typename K, typename... Ps>
@@ -115,11 +120,28 @@ auto Functor<R, K, Ps...>::operator()(Archive& archive) -> typename MemFunc::Ret
 	return (*this)(params, make_index_sequence<size>());
 }
 
+template<typename R, typename K, typename... Ps>
+const void* Functor<R, K, Ps...>::getInstance(void) const noexcept
+{
+	return this->instance.get();
+}
+
+template<typename R, typename K, typename... Ps>
+bool Functor<R, K, Ps...>::isConst(void) const noexcept
+{
+	return this->memFunc.isConst();
+}
+
 template<typename R, typename K, typename... Ps>
 Archive Functor<R, K, Ps...>::dispatch(Archive& archive)
 {
+	// The result recycles the buffer through the pool of the request.
 	Archive ret;
-	return (ret << (*this)(archive));
+	ret.setPool(archive.getPool());
+	ret.setEncoding(archive.getEncoding());
+	ret << (*this)(archive);
+
+	return ret;
 }
 
 template<typename R, typename K, typename... Ps>
@@ -147,6 +169,16 @@ Functor<R, K, Ps...> make_functor(std::shared_ptr<K> instance, R (K::* member)(P
 	return Functor<R, K, Ps...>(instance, make_function(member));
 }
 
+template<typename R, typename K, typename... Ps>
+Functor<R, const K, Ps...> make_functor(std::shared_ptr<K> instance,
+										R (K::* member)(Ps...) const)
+{
+	if (instance == nullptr)
+		throw std::invalid_argument("Instance can't be nullptr.");
+
+	return Functor<R, const K, Ps...>(instance, make_function(member));
+}
+
 template<typename R, typename K, typename... Ps>
 std::shared_ptr<Functor<R, K, Ps...>> make_functor_ptr(std::shared_ptr<K> instance,
 													   R (K::* member)(Ps...))
@@ -157,5 +189,15 @@ std::shared_ptr<Functor<R, K, Ps...>> make_functor_ptr(std::shared_ptr<K> instan
 	return std::make_shared<Functor<R, K, Ps...>>(instance, make_function(member));
 }
 
+template<typename R, typename K, typename... Ps>
+std::shared_ptr<Functor<R, const K, Ps...>> make_functor_ptr(std::shared_ptr<K> instance,
+															 R (K::* member)(Ps...) const)
+{
+	if (instance == nullptr)
+		throw std::invalid_argument("Instance can't be nullptr.");
+
+	return std::make_shared<Functor<R, const K, Ps...>>(instance, make_function(member));
+}
+
 } // namespace klass
 } // namespace rmi
@@ -0,0 +1,89 @@
+/*
+ *  Copyright (c) 2018 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * @file        archive-view.cpp
+ * @author      Sangwan Kwon (sangwan.kwon@samsung.com)
+ * @brief       Implementation of archive view.
+ */
+
+#include "archive-view.hxx"
+
+#include <stdexcept>
+
+namespace rmi {
+namespace stream {
+
+ArchiveView::ArchiveView(const void* bytes, std::size_t size) noexcept :
+	data(reinterpret_cast<const unsigned char*>(bytes)), length(size)
+{
+}
+
+ArchiveView::ArchiveView(const Archive& archive) :
+	data(archive.peek()), length(archive.remaining())
+{
+	// The referenced bytes are not placed after the contiguous ones.
+	if (!archive.segments.empty())
+		throw std::invalid_argument("Archive should be flattened to be viewed.");
+}
+
+unsigned char* ArchiveView::get(void)
+{
+	throw std::logic_error("ArchiveView is read-only.");
+}
+
+const unsigned char* ArchiveView::get(void) const noexcept
+{
+	return this->data;
+}
+
+std::size_t ArchiveView::size(void) const noexcept
+{
+	return this->length;
+}
+
+void ArchiveView::save(const void*, std::size_t)
+{
+	throw std::logic_error("ArchiveView is read-only.");
+}
+
+void ArchiveView::reference(const void*, std::size_t)
+{
+	throw std::logic_error("ArchiveView is read-only.");
+}
+
+const unsigned char* ArchiveView::borrow(std::size_t size)
+{
+	if (size > this->remaining())
+		throw std::out_of_range("Archive has not enough bytes to read.");
+
+	auto bytes = this->peek();
+	this->current += size;
+
+	return bytes;
+}
+
+const unsigned char* ArchiveView::peek(void) const noexcept
+{
+	return this->data + this->current;
+}
+
+std::size_t ArchiveView::remaining(void) const noexcept
+{
+	return this->length - this->current;
+}
+
+} // namespace stream
+} // namespace rmi
@@ -0,0 +1,59 @@
+/*
+ *  Copyright (c) 2018 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * @file        archive-view.hxx
+ * @author      Sangwan Kwon (sangwan.kwon@samsung.com)
+ * @brief       Read-only archive over the existing bytes. (non-owning)
+ * @details     The bytes should outlive the view and the borrowed values
+ *              (StringView, BlobView) deserialized from it.
+ */
+
+#pragma once
+
+#include "archive.hxx"
+
+namespace rmi {
+namespace stream {
+
+class ArchiveView : public Archive {
+public:
+	explicit ArchiveView(const void* bytes, std::size_t size) noexcept;
+	// View the unread bytes of archive.
+	// Throw std::invalid_argument if it has referenced bytes. (see flatten)
+	explicit ArchiveView(const Archive& archive);
+	virtual ~ArchiveView() = default;
+
+	// Throw std::logic_error since the bytes are not writable.
+	unsigned char* get(void) override;
+	const unsigned char* get(void) const noexcept override;
+	std::size_t size(void) const noexcept override;
+
+protected:
+	void save(const void* bytes, std::size_t size) override;
+	void reference(const void* bytes, std::size_t size) override;
+
+	const unsigned char* borrow(std::size_t size) override;
+	const unsigned char* peek(void) const noexcept override;
+	std::size_t remaining(void) const noexcept override;
+
+private:
+	const unsigned char* data;
+	std::size_t length;
+	std::size_t current = 0;
+};
+
+} // namespace stream
+} // namespace rmi
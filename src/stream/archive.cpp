@@ -20,14 +20,51 @@
  */
 
 #include "archive.hxx"
+#include "archive-view.hxx"
 
 #include <algorithm>
 #include <cstring>
-#include <iterator>
+#include <stdexcept>
+#include <utility>
 
 namespace rmi {
 namespace stream {
 
+constexpr std::size_t Archive::GROWTH_FACTOR;
+constexpr std::size_t Archive::MIN_CAPACITY;
+constexpr std::size_t Archive::VARINT_CHUNK;
+
+Archive::~Archive()
+{
+	if (this->pool != nullptr)
+		this->pool->release(std::move(this->buffer));
+}
+
+Archive& Archive::operator=(Archive&& archive)
+{
+	if (this == &archive)
+		return *this;
+
+	if (this->pool != nullptr)
+		this->pool->release(std::move(this->buffer));
+
+	this->buffer = std::move(archive.buffer);
+	this->current = archive.current;
+	this->encoding = archive.encoding;
+	this->segments = std::move(archive.segments);
+	this->referenced = archive.referenced;
+	this->threshold = archive.threshold;
+	this->descriptors = std::move(archive.descriptors);
+	this->descriptorIndex = archive.descriptorIndex;
+	this->pool = std::move(archive.pool);
+
+	archive.current = 0;
+	archive.referenced = 0;
+	archive.descriptorIndex = 0;
+
+	return *this;
+}
+
 void Archive::pack(void)
 {
 }
@@ -38,66 +75,373 @@ void Archive::unpack(void)
 
 Archive& Archive::operator<<(const Archive& archive)
 {
-	auto data = archive.buffer;
-	auto index = archive.current;
-	std::copy(data.begin() + index, data.end(), std::back_inserter(this->buffer));
+	if (this == &archive) {
+		// The copy dies here, so it is saved inline even over threshold.
+		Archive copy;
+		copy << archive;
+		this->descriptors.insert(this->descriptors.end(), copy.descriptors.begin(),
+								 copy.descriptors.end());
+		this->save(copy.buffer.data(), copy.buffer.size());
+
+		return *this;
+	}
+
+	this->descriptors.insert(this->descriptors.end(),
+							 archive.descriptors.begin() + archive.descriptorIndex,
+							 archive.descriptors.end());
+
+	// Through the unread bytes of archive, which may be a view.
+	if (archive.segments.empty()) {
+		this->saveBytes(archive.peek(), archive.remaining());
+		return *this;
+	}
+
+	for (const auto& piece : archive.gather())
+		this->saveBytes(piece.data(), piece.size());
+
+	return *this;
+}
+
+Archive& Archive::operator<<(const Descriptor& descriptor)
+{
+	*this << descriptor.valid();
+	if (descriptor.valid())
+		this->descriptors.push_back(descriptor);
+
+	return *this;
+}
+
+Archive& Archive::operator<<(const SealedBlob& blob)
+{
+	// The receiver should not see the bytes changing.
+	if (blob.getDescriptor().valid() && !blob.isSealed())
+		throw std::invalid_argument("Blob should be sealed before sent.");
+
+	return *this << blob.getDescriptor();
 }
 
 Archive& Archive::operator<<(const std::string& value)
 {
 	std::size_t size = value.size();
-	this->save(reinterpret_cast<const void*>(&size), sizeof(size));
-
-	this->save(reinterpret_cast<const void*>(value.c_str()), value.size());
+	this->saveLength(size);
+	this->saveBytes(reinterpret_cast<const void*>(value.data()), size);
 
 	return *this;
 }
 
 Archive& Archive::operator>>(Archive& archive)
 {
-	auto data = this->buffer;
-	auto index = this->current;
-	std::copy(data.begin() + index, data.end(), std::back_inserter(archive.buffer));
+	archive << *this;
+
+	return *this;
 }
 
 Archive& Archive::operator>>(std::string& value)
 {
-	std::size_t size;
-	this->load(reinterpret_cast<void*>(&size), sizeof(size));
+	std::size_t size = this->loadLength(1);
+	auto bytes = this->borrow(size);
+	value.assign(reinterpret_cast<const char*>(bytes), size);
 
-	value.resize(size);
-	this->load(reinterpret_cast<void*>(&value.front()), size);
+	return *this;
+}
+
+Archive& Archive::operator>>(Descriptor& descriptor)
+{
+	bool valid;
+	*this >> valid;
+	if (!valid) {
+		descriptor = Descriptor();
+		return *this;
+	}
+
+	if (this->descriptorIndex >= this->descriptors.size())
+		throw std::out_of_range("Archive has not enough descriptors to read.");
+
+	// Moved out, so the reader owns it alone.
+	descriptor = std::move(this->descriptors[this->descriptorIndex++]);
 
 	return *this;
 }
 
-unsigned char* Archive::get(void) noexcept
+Archive& Archive::operator>>(SealedBlob& blob)
+{
+	Descriptor descriptor;
+	*this >> descriptor;
+	blob = descriptor.valid() ? SealedBlob(std::move(descriptor)) : SealedBlob();
+
+	return *this;
+}
+
+unsigned char* Archive::get(void)
+{
+	return this->buffer.data();
+}
+
+const unsigned char* Archive::get(void) const noexcept
 {
 	return this->buffer.data();
 }
 
 std::size_t Archive::size(void) const noexcept
 {
-	return this->buffer.size();
+	return this->buffer.size() + this->referenced;
 }
 
-void Archive::reserve(std::size_t size) noexcept
+void Archive::reserve(std::size_t size)
 {
+	this->acquire(size);
 	this->buffer.reserve(size);
 }
 
+void Archive::resize(std::size_t size)
+{
+	this->acquire(size);
+	this->buffer.resize(size);
+}
+
+void Archive::setEncoding(Encoding encoding) noexcept
+{
+	this->encoding = encoding;
+}
+
+Archive::Encoding Archive::getEncoding(void) const noexcept
+{
+	return this->encoding;
+}
+
+std::size_t Archive::measureImpl(void) const noexcept
+{
+	return 0;
+}
+
+std::size_t Archive::measureOne(const std::string& value) const noexcept
+{
+	return this->lengthSize(value.size()) + this->bytesSize(value.size());
+}
+
+std::size_t Archive::measureOne(const Descriptor&) const noexcept
+{
+	return sizeof(bool);
+}
+
+std::size_t Archive::measureOne(const SealedBlob&) const noexcept
+{
+	return sizeof(bool);
+}
+
+std::size_t Archive::measureOne(const Archive& archive) const noexcept
+{
+	std::size_t size = archive.remaining();
+	for (const auto& segment : archive.segments)
+		size += this->bytesSize(segment.size);
+
+	return size;
+}
+
+std::size_t Archive::measureOne(const ArchiveView& view) const noexcept
+{
+	return this->measureOne(static_cast<const Archive&>(view));
+}
+
+std::size_t Archive::lengthSize(std::size_t length) const noexcept
+{
+	if (this->encoding == Encoding::Compact)
+		return varintSize(length);
+
+	return sizeof(length);
+}
+
+std::size_t Archive::bytesSize(std::size_t size) const noexcept
+{
+	if (this->threshold == 0 || size < this->threshold)
+		return size;
+
+	return 0;
+}
+
+void Archive::setReferenceThreshold(std::size_t threshold) noexcept
+{
+	this->threshold = threshold;
+}
+
+std::vector<BlobView> Archive::gather(void) const
+{
+	std::vector<BlobView> pieces;
+	this->gather(pieces);
+
+	return pieces;
+}
+
+void Archive::gather(std::vector<BlobView>& pieces) const
+{
+	pieces.clear();
+	pieces.reserve(this->segments.size() * 2 + 1);
+
+	// The referenced bytes are flattened before reading, so current is 0.
+	std::size_t offset = this->current;
+	for (const auto& segment : this->segments) {
+		if (segment.offset > offset)
+			pieces.emplace_back(this->buffer.data() + offset, segment.offset - offset);
+
+		pieces.emplace_back(segment.data, segment.size);
+		offset = segment.offset;
+	}
+
+	if (this->buffer.size() > offset)
+		pieces.emplace_back(this->buffer.data() + offset, this->buffer.size() - offset);
+}
+
+void Archive::flatten(void)
+{
+	if (this->segments.empty())
+		return;
+
+	std::vector<unsigned char> flat;
+	flat.reserve(this->size() - this->current);
+	for (const auto& piece : this->gather())
+		flat.insert(flat.end(), piece.begin(), piece.end());
+
+	this->buffer.swap(flat);
+	this->current = 0;
+	this->segments.clear();
+	this->referenced = 0;
+}
+
+void Archive::setPool(const std::shared_ptr<BufferPool>& pool) noexcept
+{
+	this->pool = pool;
+}
+
+const std::shared_ptr<BufferPool>& Archive::getPool(void) const noexcept
+{
+	return this->pool;
+}
+
+const std::vector<Descriptor>& Archive::getDescriptors(void) const noexcept
+{
+	return this->descriptors;
+}
+
+void Archive::addDescriptor(Descriptor descriptor)
+{
+	this->descriptors.push_back(std::move(descriptor));
+}
+
+void Archive::saveBytes(const void* bytes, std::size_t size)
+{
+	if (this->threshold == 0 || size < this->threshold)
+		return this->save(bytes, size);
+
+	this->reference(bytes, size);
+}
+
+void Archive::reference(const void* bytes, std::size_t size)
+{
+	auto data = reinterpret_cast<const unsigned char*>(bytes);
+	this->segments.push_back({this->buffer.size(), data, size});
+	this->referenced += size;
+}
+
+void Archive::saveLength(std::size_t length)
+{
+	if (this->encoding == Encoding::Compact)
+		return this->saveVarint(length);
+
+	this->save(reinterpret_cast<const void*>(&length), sizeof(length));
+}
+
+std::size_t Archive::loadLength(std::size_t unit)
+{
+	std::size_t length;
+	if (this->encoding == Encoding::Compact)
+		length = static_cast<std::size_t>(this->loadVarint());
+	else
+		this->load(reinterpret_cast<void*>(&length), sizeof(length));
+
+	if (unit > 0 && length > this->remaining() / unit)
+		throw std::out_of_range("Archive has not enough bytes to read.");
+
+	return length;
+}
+
+void Archive::saveVarint(std::uint64_t value)
+{
+	unsigned char bytes[MAX_VARINT_SIZE];
+	this->save(bytes, encodeVarint(value, bytes));
+}
+
+std::uint64_t Archive::loadVarint(void)
+{
+	this->flatten();
+
+	std::uint64_t value;
+	auto size = decodeVarint(this->peek(), this->remaining(), value);
+	if (size == 0)
+		throw std::out_of_range("Archive has truncated or malformed varint.");
+
+	this->borrow(size);
+
+	return value;
+}
+
+void Archive::grow(std::size_t size)
+{
+	auto required = this->buffer.size() + size;
+	if (required <= this->buffer.capacity())
+		return;
+
+	auto capacity = std::max(this->buffer.capacity() * GROWTH_FACTOR, MIN_CAPACITY);
+	capacity = std::max(capacity, required);
+
+	this->acquire(capacity);
+	this->buffer.reserve(capacity);
+}
+
+void Archive::acquire(std::size_t capacity)
+{
+	if (this->pool == nullptr || this->buffer.capacity() != 0 || capacity == 0)
+		return;
+
+	this->buffer = this->pool->acquire(capacity);
+}
+
 void Archive::save(const void* bytes, std::size_t size)
 {
-	auto binary = reinterpret_cast<unsigned char*>(const_cast<void*>(bytes));
-	std::vector<unsigned char> next(binary, binary + size);
+	if (size == 0)
+		return;
+
+	this->grow(size);
 
-	std::copy(next.begin(), next.end(), std::back_inserter(this->buffer));
+	auto binary = reinterpret_cast<const unsigned char*>(bytes);
+	this->buffer.insert(this->buffer.end(), binary, binary + size);
 }
 
 void Archive::load(void* bytes, std::size_t size)
 {
-	std::memcpy(bytes, reinterpret_cast<void*>(this->buffer.data() + current), size);
-	current += size;
+	std::memcpy(bytes, this->borrow(size), size);
+}
+
+const unsigned char* Archive::borrow(std::size_t size)
+{
+	this->flatten();
+
+	if (size > this->remaining())
+		throw std::out_of_range("Archive has not enough bytes to read.");
+
+	auto bytes = this->peek();
+	this->current += size;
+
+	return bytes;
+}
+
+const unsigned char* Archive::peek(void) const noexcept
+{
+	return this->buffer.data() + this->current;
+}
+
+std::size_t Archive::remaining(void) const noexcept
+{
+	return this->buffer.size() - this->current;
 }
 
 } // namespace stream
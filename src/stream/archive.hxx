@@ -18,34 +18,67 @@
  * @author      Sangwan Kwon (sangwan.kwon@samsung.com)
  * @brief       Define archive interface for serializer and parameter-pack.
  * @details     1. Serializer: Serialize/deserialize below types.
- *                 (fundamental types, archival object, unique_ptr, shared_ptr)
- *              2. Parameter-pack: Pack/unpack zero or more template arguments.
+ *                 (fundamental types, archival object, unique_ptr, shared_ptr,
+ *                  string and views of string or blob,
+ *                  descriptor and sealed blob,
+ *                  vector, array, pair, tuple, map, unordered_map, set)
+ *                 Contiguous arithmetic elements are copied at once.
+ *                 The large bytes can be referenced instead of copied.
+ *                 (scatter-gather, see setReferenceThreshold())
+ *              2. Encoding: Fixed (native width) or Compact.
+ *                 On compact, integers and lengths are varint encoded.
+ *                 (zigzag for signed)
+ *              3. Parameter-pack: Pack/unpack zero or more template arguments.
  */
 
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <set>
 #include <string>
+#include <tuple>
 #include <type_traits>
+#include <unordered_map>
+#include <utility>
 #include <vector>
-#include <memory>
-#include <tuple>
 
+#include "buffer-pool.hxx"
+#include "descriptor.hxx"
 #include "index-sequence.hxx"
+#include "kernel.hxx"
+#include "serializable.hxx"
+#include "traits.hxx"
+#include "varint.hxx"
+#include "view.hxx"
 
 namespace rmi {
 namespace stream {
 
-class Archival;
-
-template<typename T>
-using IsFundamental = typename std::enable_if<std::is_fundamental<T>::value, int>::type;
-
-template<typename T>
-using IsArchival = typename std::enable_if<std::is_base_of<Archival, T>::value, int>::type;
+class ArchiveView;
 
 class Archive {
 public:
-	virtual ~Archive() = default;
+	enum class Encoding : unsigned char {
+		Fixed,
+		Compact
+	};
+
+	Archive() = default;
+	virtual ~Archive();
+
+	Archive(const Archive&) = default;
+	Archive& operator=(const Archive&) = default;
+
+	Archive(Archive&&) = default;
+	// The replaced buffer is released to the pool.
+	Archive& operator=(Archive&& archive);
 
 	template<typename Front, typename... Rest>
 	void pack(const Front& front, const Rest&... rest);
@@ -58,46 +91,289 @@ public:
 	template<typename... Ts>
 	void transform(std::tuple<Ts...>& tuple);
 
+	// Return the bytes which values take on this archive, which is exact or
+	// the upper bound on compact encoding. (see SerializedSize)
+	// But the archival without fields() is counted as 0 unless SerializedSize
+	// is specialized for it, so the result is only a lower bound with it.
+	template<typename... Ts>
+	std::size_t measure(const Ts&... values) const;
+	// Reserve at once for the values to be packed. (see grow)
+	// The archival counted as 0 by measure() grows the buffer as it is packed.
+	template<typename... Ts>
+	void prepare(const Ts&... values);
+
 	// serialize method
 	template<typename T, IsFundamental<T> = 0>
 	Archive& operator<<(const T& value);
 	template<typename T, IsArchival<T> = 0>
 	Archive& operator<<(const T& object);
+	template<typename T, IsSerializable<T> = 0>
+	Archive& operator<<(const T& object);
 	template<typename T>
 	Archive& operator<<(const std::unique_ptr<T>& pointer);
 	template<typename T>
 	Archive& operator<<(const std::shared_ptr<T>& pointer);
+	template<typename CharT>
+	Archive& operator<<(const BasicView<CharT>& view);
 	Archive& operator<<(const std::string& value);
+	Archive& operator<<(const Descriptor& descriptor);
+	// Throw std::invalid_argument if the blob is not sealed.
+	Archive& operator<<(const SealedBlob& blob);
 	Archive& operator<<(const Archive& archive);
 
+	template<typename T, typename A>
+	Archive& operator<<(const std::vector<T, A>& vector);
+	template<typename T, std::size_t N>
+	Archive& operator<<(const std::array<T, N>& array);
+	template<typename T1, typename T2>
+	Archive& operator<<(const std::pair<T1, T2>& pair);
+	template<typename... Ts>
+	Archive& operator<<(const std::tuple<Ts...>& tuple);
+	template<typename K, typename V, typename C, typename A>
+	Archive& operator<<(const std::map<K, V, C, A>& map);
+	template<typename K, typename V, typename H, typename E, typename A>
+	Archive& operator<<(const std::unordered_map<K, V, H, E, A>& map);
+	template<typename K, typename C, typename A>
+	Archive& operator<<(const std::set<K, C, A>& set);
+
 	// deserialize method
 	template<typename T, IsFundamental<T> = 0>
 	Archive& operator>>(T& value);
 	template<typename T, IsArchival<T> = 0>
 	Archive& operator>>(T& object);
+	template<typename T, IsSerializable<T> = 0>
+	Archive& operator>>(T& object);
 	template<typename T>
 	Archive& operator>>(std::unique_ptr<T>& pointer);
 	template<typename T>
 	Archive& operator>>(std::shared_ptr<T>& pointer);
+	// The view points into this archive without copying.
+	template<typename CharT>
+	Archive& operator>>(BasicView<CharT>& view);
 	Archive& operator>>(std::string& value);
+	// The descriptor is taken from this archive in order.
+	Archive& operator>>(Descriptor& descriptor);
+	Archive& operator>>(SealedBlob& blob);
 	Archive& operator>>(Archive& archive);
 
-	unsigned char* get(void) noexcept;
-	std::size_t size(void) const noexcept;
-	void reserve(std::size_t size) noexcept;
+	template<typename T, typename A>
+	Archive& operator>>(std::vector<T, A>& vector);
+	template<typename T, std::size_t N>
+	Archive& operator>>(std::array<T, N>& array);
+	template<typename T1, typename T2>
+	Archive& operator>>(std::pair<T1, T2>& pair);
+	template<typename... Ts>
+	Archive& operator>>(std::tuple<Ts...>& tuple);
+	template<typename K, typename V, typename C, typename A>
+	Archive& operator>>(std::map<K, V, C, A>& map);
+	template<typename K, typename V, typename H, typename E, typename A>
+	Archive& operator>>(std::unordered_map<K, V, H, E, A>& map);
+	template<typename K, typename C, typename A>
+	Archive& operator>>(std::set<K, C, A>& set);
+
+	// The contiguous bytes. (The referenced bytes are not included.)
+	virtual unsigned char* get(void);
+	virtual const unsigned char* get(void) const noexcept;
+	// The total bytes including the referenced bytes.
+	virtual std::size_t size(void) const noexcept;
+	// Reserve exactly the given capacity. (not rounded by the growth policy)
+	void reserve(std::size_t size);
+	// Resize the bytes to be filled through get(). (e.g. socket receive)
+	void resize(std::size_t size);
+
+	void setEncoding(Encoding encoding) noexcept;
+	Encoding getEncoding(void) const noexcept;
+
+	// Reference the bytes of string, view and bulk elements instead of
+	// copying them when they are equal or larger than threshold. (0: never)
+	// The referenced bytes should outlive the archive.
+	void setReferenceThreshold(std::size_t threshold) noexcept;
+	// Split the unread bytes into contiguous pieces in order.
+	std::vector<BlobView> gather(void) const;
+	// Same as above but reuse the given vector. (no allocation in steady state)
+	void gather(std::vector<BlobView>& pieces) const;
+	// Copy the referenced bytes into the archive. (reading does it implicitly)
+	void flatten(void);
+
+	// Acquire the buffer from the pool and release it on destruction.
+	void setPool(const std::shared_ptr<BufferPool>& pool) noexcept;
+	const std::shared_ptr<BufferPool>& getPool(void) const noexcept;
+
+	// The descriptors which are passed along with the bytes. (in order)
+	const std::vector<Descriptor>& getDescriptors(void) const noexcept;
+	// Append the received descriptor to be read.
+	void addDescriptor(Descriptor descriptor);
 
 protected:
 	virtual void save(const void* bytes, std::size_t size);
 	virtual void load(void* bytes, std::size_t size);
+	// Append the bytes without copy. (saveBytes over threshold)
+	virtual void reference(const void* bytes, std::size_t size);
+
+	// Return the unread bytes in place and skip them.
+	virtual const unsigned char* borrow(std::size_t size);
+	// Return the unread bytes in place without skipping.
+	virtual const unsigned char* peek(void) const noexcept;
+	virtual std::size_t remaining(void) const noexcept;
 
 private:
+	struct Segment {
+		// The position in buffer where the referenced bytes are placed.
+		std::size_t offset;
+		const unsigned char* data;
+		std::size_t size;
+	};
+
+	// Grow capacity geometrically to make appending amortized O(1).
+	void grow(std::size_t size);
+	// Take the pooled buffer before the first allocation.
+	void acquire(std::size_t capacity);
+
+	// Save or reference the bytes by threshold.
+	void saveBytes(const void* bytes, std::size_t size);
+
+	void saveLength(std::size_t length);
+	// Read the length of elements which occupy at least unit bytes each.
+	std::size_t loadLength(std::size_t unit = 0);
+
+	void saveVarint(std::uint64_t value);
+	std::uint64_t loadVarint(void);
+
+	template<typename T>
+	void saveValue(const T& value, std::true_type);
+	template<typename T>
+	void saveValue(const T& value, std::false_type);
+	template<typename T>
+	void loadValue(T& value, std::true_type);
+	template<typename T>
+	void loadValue(T& value, std::false_type);
+
+	template<typename T>
+	void saveElements(const T* elements, std::size_t count, std::true_type);
+	template<typename T>
+	void saveElements(const T* elements, std::size_t count, std::false_type);
+	template<typename T>
+	void loadElements(T* elements, std::size_t count, std::true_type);
+	template<typename T>
+	void loadElements(T* elements, std::size_t count, std::false_type);
+
+	// Compact integers of 4 or 8 bytes are coded by vectorized kernels.
+	template<typename T>
+	void saveVarints(const T* elements, std::size_t count, std::true_type);
+	template<typename T>
+	void saveVarints(const T* elements, std::size_t count, std::false_type);
+	template<typename T>
+	void loadVarints(T* elements, std::size_t count, std::true_type);
+	template<typename T>
+	void loadVarints(T* elements, std::size_t count, std::false_type);
+
+	template<typename T, typename A>
+	void saveVector(const std::vector<T, A>& vector, std::true_type);
+	template<typename T, typename A>
+	void saveVector(const std::vector<T, A>& vector, std::false_type);
+	template<typename T, typename A>
+	void loadVector(std::vector<T, A>& vector, std::true_type);
+	template<typename T, typename A>
+	void loadVector(std::vector<T, A>& vector, std::false_type);
+
+	std::size_t measureImpl(void) const noexcept;
+	template<typename Front, typename... Rest>
+	std::size_t measureImpl(const Front& front, const Rest&... rest) const;
+
+	template<typename T>
+	std::size_t measureOne(const T& value) const;
+	template<typename T>
+	std::size_t measureObject(const T& value, std::false_type) const noexcept;
+	template<typename T>
+	std::size_t measureObject(const T& object, std::true_type) const;
+	template<typename T>
+	std::size_t measureOne(const std::unique_ptr<T>& pointer) const;
+	template<typename T>
+	std::size_t measureOne(const std::shared_ptr<T>& pointer) const;
+	template<typename CharT>
+	std::size_t measureOne(const BasicView<CharT>& view) const noexcept;
+	std::size_t measureOne(const std::string& value) const noexcept;
+	std::size_t measureOne(const Descriptor& descriptor) const noexcept;
+	std::size_t measureOne(const SealedBlob& blob) const noexcept;
+	std::size_t measureOne(const Archive& archive) const noexcept;
+	// Not by the generic one above.
+	std::size_t measureOne(const ArchiveView& view) const noexcept;
+	template<typename T, typename A>
+	std::size_t measureOne(const std::vector<T, A>& vector) const;
+	template<typename T, std::size_t N>
+	std::size_t measureOne(const std::array<T, N>& array) const;
+	template<typename T1, typename T2>
+	std::size_t measureOne(const std::pair<T1, T2>& pair) const;
+	template<typename... Ts>
+	std::size_t measureOne(const std::tuple<Ts...>& tuple) const;
+	template<typename K, typename V, typename C, typename A>
+	std::size_t measureOne(const std::map<K, V, C, A>& map) const;
+	template<typename K, typename V, typename H, typename E, typename A>
+	std::size_t measureOne(const std::unordered_map<K, V, H, E, A>& map) const;
+	template<typename K, typename C, typename A>
+	std::size_t measureOne(const std::set<K, C, A>& set) const;
+
+	template<typename T>
+	std::size_t measureTuple(const T& tuple, EmptySequence) const noexcept;
+	template<typename T, std::size_t... I>
+	std::size_t measureTuple(const T& tuple, IndexSequence<I...>) const;
+	template<typename T>
+	std::size_t measureElements(const T& container) const;
+
+	template<typename T>
+	std::size_t fixedSize(void) const noexcept;
+	std::size_t lengthSize(std::size_t length) const noexcept;
+	// The referenced bytes do not take the buffer.
+	std::size_t bytesSize(std::size_t size) const noexcept;
+
 	template<typename T>
 	void transformImpl(T& tuple, EmptySequence);
 	template<typename T, std::size_t... I>
 	void transformImpl(T& tuple, IndexSequence<I...>);
+	template<typename T>
+	void packImpl(const T& tuple, EmptySequence);
+	template<typename T, std::size_t... I>
+	void packImpl(const T& tuple, IndexSequence<I...>);
+
+	// The fields of serializable. (the tuple of references)
+	template<typename T>
+	void saveFields(const T& fields, std::true_type);
+	template<typename T>
+	void saveFields(const T& fields, std::false_type);
+	template<typename T>
+	void loadFields(T& fields, std::true_type);
+	template<typename T>
+	void loadFields(T& fields, std::false_type);
+
+	template<typename T>
+	static void copyFields(unsigned char* block, const T& fields, EmptySequence) noexcept;
+	template<typename T, std::size_t... I>
+	static void copyFields(unsigned char* block, const T& fields, IndexSequence<I...>) noexcept;
+	template<typename T>
+	static void copyFields(T& fields, const unsigned char* block, EmptySequence) noexcept;
+	template<typename T, std::size_t... I>
+	static void copyFields(T& fields, const unsigned char* block, IndexSequence<I...>) noexcept;
 
 	std::vector<unsigned char> buffer;
 	std::size_t current = 0;
+
+	Encoding encoding = Encoding::Fixed;
+
+	std::vector<Segment> segments;
+	std::size_t referenced = 0;
+	std::size_t threshold = 0;
+
+	std::vector<Descriptor> descriptors;
+	// The next one to be read.
+	std::size_t descriptorIndex = 0;
+
+	std::shared_ptr<BufferPool> pool;
+
+	static constexpr std::size_t GROWTH_FACTOR = 2;
+	static constexpr std::size_t MIN_CAPACITY = 64;
+	static constexpr std::size_t VARINT_CHUNK = 256;
+
+	friend class ArchiveView;
 };
 
 class Archival {
@@ -129,8 +405,150 @@ void Archive::transform(std::tuple<Ts...>& tuple)
 	this->transformImpl(tuple, make_index_sequence<size>());
 }
 
+template<typename... Ts>
+std::size_t Archive::measure(const Ts&... values) const
+{
+	using Size = PackSize<Ts...>;
+	if (Size::fixed)
+		return (this->encoding == Encoding::Fixed) ? Size::size : Size::bound;
+
+	return this->measureImpl(values...);
+}
+
+template<typename... Ts>
+void Archive::prepare(const Ts&... values)
+{
+	// By the growth policy, so packing in a loop does not reallocate each time.
+	this->grow(this->measure(values...));
+}
+
+template<typename Front, typename... Rest>
+std::size_t Archive::measureImpl(const Front& front, const Rest&... rest) const
+{
+	return this->measureOne(front) + this->measureImpl(rest...);
+}
+
 template<typename T>
-void Archive::transformImpl(T& tuple, EmptySequence)
+std::size_t Archive::fixedSize(void) const noexcept
+{
+	using Size = SerializedSize<T>;
+	return (this->encoding == Encoding::Fixed) ? Size::size : Size::bound;
+}
+
+template<typename T>
+std::size_t Archive::measureOne(const T& value) const
+{
+	return this->measureObject(value, HasFields<T>());
+}
+
+template<typename T>
+std::size_t Archive::measureObject(const T&, std::false_type) const noexcept
+{
+	return this->fixedSize<T>();
+}
+
+template<typename T>
+std::size_t Archive::measureObject(const T& object, std::true_type) const
+{
+	return this->measureOne(object.fields());
+}
+
+template<typename T>
+std::size_t Archive::measureOne(const std::unique_ptr<T>& pointer) const
+{
+	return this->measureOne(*pointer);
+}
+
+template<typename T>
+std::size_t Archive::measureOne(const std::shared_ptr<T>& pointer) const
+{
+	return this->measureOne(*pointer);
+}
+
+template<typename CharT>
+std::size_t Archive::measureOne(const BasicView<CharT>& view) const noexcept
+{
+	std::size_t size = view.size() * sizeof(CharT);
+	return this->lengthSize(size) + this->bytesSize(size);
+}
+
+template<typename T, typename A>
+std::size_t Archive::measureOne(const std::vector<T, A>& vector) const
+{
+	std::size_t size = this->lengthSize(vector.size());
+	if (IsBulk<T>::value && !(IsVarint<T>::value && this->encoding == Encoding::Compact))
+		return size + this->bytesSize(sizeof(T) * vector.size());
+
+	return size + this->measureElements(vector);
+}
+
+template<typename T, std::size_t N>
+std::size_t Archive::measureOne(const std::array<T, N>& array) const
+{
+	if (SerializedSize<T>::fixed)
+		return this->fixedSize<std::array<T, N>>();
+
+	return this->measureElements(array);
+}
+
+template<typename T1, typename T2>
+std::size_t Archive::measureOne(const std::pair<T1, T2>& pair) const
+{
+	return this->measureOne(pair.first) + this->measureOne(pair.second);
+}
+
+template<typename... Ts>
+std::size_t Archive::measureOne(const std::tuple<Ts...>& tuple) const
+{
+	return this->measureTuple(tuple, make_index_sequence<sizeof...(Ts)>());
+}
+
+template<typename K, typename V, typename C, typename A>
+std::size_t Archive::measureOne(const std::map<K, V, C, A>& map) const
+{
+	return this->lengthSize(map.size()) + this->measureElements(map);
+}
+
+template<typename K, typename V, typename H, typename E, typename A>
+std::size_t Archive::measureOne(const std::unordered_map<K, V, H, E, A>& map) const
+{
+	return this->lengthSize(map.size()) + this->measureElements(map);
+}
+
+template<typename K, typename C, typename A>
+std::size_t Archive::measureOne(const std::set<K, C, A>& set) const
+{
+	return this->lengthSize(set.size()) + this->measureElements(set);
+}
+
+template<typename T>
+std::size_t Archive::measureTuple(const T&, EmptySequence) const noexcept
+{
+	return 0;
+}
+
+template<typename T, std::size_t... I>
+std::size_t Archive::measureTuple(const T& tuple, IndexSequence<I...>) const
+{
+	return this->measureImpl(std::get<I>(tuple)...);
+}
+
+template<typename T>
+std::size_t Archive::measureElements(const T& container) const
+{
+	using Element = typename std::decay<decltype(*container.begin())>::type;
+	if (SerializedSize<Element>::fixed)
+		return this->fixedSize<Element>() * container.size();
+
+	std::size_t size = 0;
+	for (const auto& element : container)
+		size += this->measureOne(static_cast<const Element&>(element));
+
+	return size;
+}
+
+template<typename T>
+void Archive::transformImpl(T&, EmptySequence)
 {
 }
 
@@ -140,10 +558,241 @@ void Archive::transformImpl(T& tuple, IndexSequence<I...>)
 	this->unpack(std::get<I>(tuple)...);
 }
 
+template<typename T>
+void Archive::packImpl(const T&, EmptySequence)
+{
+}
+
+template<typename T, std::size_t... I>
+void Archive::packImpl(const T& tuple, IndexSequence<I...>)
+{
+	this->pack(std::get<I>(tuple)...);
+}
+
+template<typename T>
+void Archive::saveFields(const T& fields, std::true_type)
+{
+	if (this->encoding == Encoding::Compact)
+		return this->saveFields(fields, std::false_type());
+
+	// Assemble the block inline, then save the whole object at once.
+	std::array<unsigned char, SerializedSize<T>::size> block;
+	copyFields(block.data(), fields, make_index_sequence<std::tuple_size<T>::value>());
+	this->save(block.data(), block.size());
+}
+
+template<typename T>
+void Archive::saveFields(const T& fields, std::false_type)
+{
+	this->packImpl(fields, make_index_sequence<std::tuple_size<T>::value>());
+}
+
+template<typename T>
+void Archive::loadFields(T& fields, std::true_type)
+{
+	if (this->encoding == Encoding::Compact)
+		return this->loadFields(fields, std::false_type());
+
+	auto block = this->borrow(SerializedSize<T>::size);
+	copyFields(fields, block, make_index_sequence<std::tuple_size<T>::value>());
+}
+
+template<typename T>
+void Archive::loadFields(T& fields, std::false_type)
+{
+	this->transformImpl(fields, make_index_sequence<std::tuple_size<T>::value>());
+}
+
+template<typename T>
+void Archive::copyFields(unsigned char*, const T&, EmptySequence) noexcept
+{
+}
+
+template<typename T, std::size_t... I>
+void Archive::copyFields(unsigned char* block, const T& fields, IndexSequence<I...>) noexcept
+{
+	using Expand = int[];
+	(void)Expand{0, (std::memcpy(block, &std::get<I>(fields), sizeof(std::get<I>(fields))),
+					 block += sizeof(std::get<I>(fields)), 0)...};
+}
+
+template<typename T>
+void Archive::copyFields(T&, const unsigned char*, EmptySequence) noexcept
+{
+}
+
+template<typename T, std::size_t... I>
+void Archive::copyFields(T& fields, const unsigned char* block, IndexSequence<I...>) noexcept
+{
+	using Expand = int[];
+	(void)Expand{0, (std::memcpy(&std::get<I>(fields), block, sizeof(std::get<I>(fields))),
+					 block += sizeof(std::get<I>(fields)), 0)...};
+}
+
+template<typename T>
+void Archive::saveElements(const T* elements, std::size_t count, std::true_type)
+{
+	if (IsVarint<T>::value && this->encoding == Encoding::Compact)
+		return this->saveVarints(elements, count, IsWideVarint<T>());
+
+	this->saveBytes(reinterpret_cast<const void*>(elements), sizeof(T) * count);
+}
+
+template<typename T>
+void Archive::saveElements(const T* elements, std::size_t count, std::false_type)
+{
+	for (std::size_t i = 0; i < count; i++)
+		*this << elements[i];
+}
+
+template<typename T>
+void Archive::loadElements(T* elements, std::size_t count, std::true_type)
+{
+	if (IsVarint<T>::value && this->encoding == Encoding::Compact)
+		return this->loadVarints(elements, count, IsWideVarint<T>());
+
+	this->load(reinterpret_cast<void*>(elements), sizeof(T) * count);
+}
+
+template<typename T>
+void Archive::loadElements(T* elements, std::size_t count, std::false_type)
+{
+	for (std::size_t i = 0; i < count; i++)
+		*this >> elements[i];
+}
+
+template<typename T>
+void Archive::saveVarints(const T* elements, std::size_t count, std::true_type)
+{
+	using Word = typename std::conditional<sizeof(T) == 4, std::uint32_t, std::uint64_t>::type;
+
+	unsigned char chunk[VARINT_CHUNK * MAX_VARINT_SIZE];
+	for (std::size_t i = 0; i < count; i += VARINT_CHUNK) {
+		auto size = kernel::encodeVarints(reinterpret_cast<const Word*>(elements + i),
+										  std::min(VARINT_CHUNK, count - i),
+										  chunk, std::is_signed<T>::value);
+		this->save(chunk, size);
+	}
+}
+
+template<typename T>
+void Archive::saveVarints(const T* elements, std::size_t count, std::false_type)
+{
+	this->saveElements(elements, count, std::false_type());
+}
+
+template<typename T>
+void Archive::loadVarints(T* elements, std::size_t count, std::true_type)
+{
+	using Word = typename std::conditional<sizeof(T) == 4, std::uint32_t, std::uint64_t>::type;
+
+	if (count == 0)
+		return;
+
+	this->flatten();
+
+	auto size = kernel::decodeVarints(this->peek(), this->remaining(),
+									  reinterpret_cast<Word*>(elements), count,
+									  std::is_signed<T>::value);
+	if (size == 0)
+		throw std::out_of_range("Archive has truncated or malformed varint.");
+
+	this->borrow(size);
+}
+
+template<typename T>
+void Archive::loadVarints(T* elements, std::size_t count, std::false_type)
+{
+	this->loadElements(elements, count, std::false_type());
+}
+
+template<typename T, typename A>
+void Archive::saveVector(const std::vector<T, A>& vector, std::true_type)
+{
+	this->saveElements(vector.data(), vector.size(), std::true_type());
+}
+
+template<typename T, typename A>
+void Archive::saveVector(const std::vector<T, A>& vector, std::false_type)
+{
+	// vector<bool> is not contiguous, so iterate it.
+	for (const auto& element : vector)
+		*this << static_cast<const T&>(element);
+}
+
+template<typename T, typename A>
+void Archive::loadVector(std::vector<T, A>& vector, std::true_type)
+{
+	// Compact integer takes 1 byte at least.
+	bool compact = IsVarint<T>::value && this->encoding == Encoding::Compact;
+	std::size_t length = this->loadLength(compact ? 1 : sizeof(T));
+	vector.resize(length);
+	this->loadElements(vector.data(), length, std::true_type());
+}
+
+template<typename T, typename A>
+void Archive::loadVector(std::vector<T, A>& vector, std::false_type)
+{
+	std::size_t length = this->loadLength();
+	vector.clear();
+	vector.reserve(std::min(length, this->remaining()));
+	for (std::size_t i = 0; i < length; i++) {
+		T element;
+		*this >> element;
+		vector.push_back(std::move(element));
+	}
+}
+
+template<typename T>
+void Archive::saveValue(const T& value, std::true_type)
+{
+	if (this->encoding == Encoding::Fixed)
+		return this->saveValue(value, std::false_type());
+
+	if (std::is_signed<T>::value)
+		this->saveVarint(zigzag(static_cast<std::int64_t>(value)));
+	else
+		this->saveVarint(static_cast<std::uint64_t>(value));
+}
+
+template<typename T>
+void Archive::saveValue(const T& value, std::false_type)
+{
+	this->save(reinterpret_cast<const void*>(&value), sizeof(value));
+}
+
+template<typename T>
+void Archive::loadValue(T& value, std::true_type)
+{
+	if (this->encoding == Encoding::Fixed)
+		return this->loadValue(value, std::false_type());
+
+	auto raw = this->loadVarint();
+	if (std::is_signed<T>::value) {
+		auto decoded = unzigzag(raw);
+		if (decoded < static_cast<std::int64_t>(std::numeric_limits<T>::min()) ||
+			decoded > static_cast<std::int64_t>(std::numeric_limits<T>::max()))
+			throw std::out_of_range("Varint overflows the integer type.");
+
+		value = static_cast<T>(decoded);
+	} else {
+		if (raw > static_cast<std::uint64_t>(std::numeric_limits<T>::max()))
+			throw std::out_of_range("Varint overflows the integer type.");
+
+		value = static_cast<T>(raw);
+	}
+}
+
+template<typename T>
+void Archive::loadValue(T& value, std::false_type)
+{
+	this->load(reinterpret_cast<void*>(&value), sizeof(value));
+}
+
 template<typename T, IsFundamental<T>>
 Archive& Archive::operator<<(const T& value)
 {
-	this->save(reinterpret_cast<const void*>(&value), sizeof(value));
+	this->saveValue(value, IsVarint<T>());
 
 	return *this;
 }
@@ -168,10 +817,90 @@ Archive& Archive::operator<<(const T& object)
 	return *this;
 }
 
+template<typename T, IsSerializable<T>>
+Archive& Archive::operator<<(const T& object)
+{
+	using Fields = decltype(object.fields());
+	this->saveFields(object.fields(), IsFlat<Fields>());
+
+	return *this;
+}
+
+template<typename CharT>
+Archive& Archive::operator<<(const BasicView<CharT>& view)
+{
+	std::size_t size = view.size() * sizeof(CharT);
+	this->saveLength(size);
+	this->saveBytes(reinterpret_cast<const void*>(view.data()), size);
+
+	return *this;
+}
+
+template<typename T, typename A>
+Archive& Archive::operator<<(const std::vector<T, A>& vector)
+{
+	this->saveLength(vector.size());
+	this->saveVector(vector, IsBulk<T>());
+
+	return *this;
+}
+
+template<typename T, std::size_t N>
+Archive& Archive::operator<<(const std::array<T, N>& array)
+{
+	this->saveElements(array.data(), N, IsBulk<T>());
+
+	return *this;
+}
+
+template<typename T1, typename T2>
+Archive& Archive::operator<<(const std::pair<T1, T2>& pair)
+{
+	return *this << pair.first << pair.second;
+}
+
+template<typename... Ts>
+Archive& Archive::operator<<(const std::tuple<Ts...>& tuple)
+{
+	this->packImpl(tuple, make_index_sequence<sizeof...(Ts)>());
+
+	return *this;
+}
+
+template<typename K, typename V, typename C, typename A>
+Archive& Archive::operator<<(const std::map<K, V, C, A>& map)
+{
+	this->saveLength(map.size());
+	for (const auto& pair : map)
+		*this << pair;
+
+	return *this;
+}
+
+template<typename K, typename V, typename H, typename E, typename A>
+Archive& Archive::operator<<(const std::unordered_map<K, V, H, E, A>& map)
+{
+	this->saveLength(map.size());
+	for (const auto& pair : map)
+		*this << pair;
+
+	return *this;
+}
+
+template<typename K, typename C, typename A>
+Archive& Archive::operator<<(const std::set<K, C, A>& set)
+{
+	this->saveLength(set.size());
+	for (const auto& key : set)
+		*this << key;
+
+	return *this;
+}
+
 template<typename T, IsFundamental<T>>
 Archive& Archive::operator>>(T& value)
 {
-	this->load(reinterpret_cast<void*>(&value), sizeof(value));
+	this->loadValue(value, IsVarint<T>());
 
 	return *this;
 }
@@ -194,6 +923,93 @@ Archive& Archive::operator>>(std::shared_ptr<T>& pointer)
 	return *this >> *pointer;
 }
 
+template<typename CharT>
+Archive& Archive::operator>>(BasicView<CharT>& view)
+{
+	std::size_t size = this->loadLength(1);
+	auto bytes = this->borrow(size);
+	view = BasicView<CharT>(reinterpret_cast<const CharT*>(bytes), size / sizeof(CharT));
+
+	return *this;
+}
+
+template<typename T, typename A>
+Archive& Archive::operator>>(std::vector<T, A>& vector)
+{
+	this->loadVector(vector, IsBulk<T>());
+
+	return *this;
+}
+
+template<typename T, std::size_t N>
+Archive& Archive::operator>>(std::array<T, N>& array)
+{
+	this->loadElements(array.data(), N, IsBulk<T>());
+
+	return *this;
+}
+
+template<typename T1, typename T2>
+Archive& Archive::operator>>(std::pair<T1, T2>& pair)
+{
+	return *this >> pair.first >> pair.second;
+}
+
+template<typename... Ts>
+Archive& Archive::operator>>(std::tuple<Ts...>& tuple)
+{
+	this->transform(tuple);
+
+	return *this;
+}
+
+template<typename K, typename V, typename C, typename A>
+Archive& Archive::operator>>(std::map<K, V, C, A>& map)
+{
+	map.clear();
+
+	std::size_t length = this->loadLength();
+	for (std::size_t i = 0; i < length; i++) {
+		std::pair<K, V> pair;
+		*this >> pair;
+		// Serialized in order, so the hint makes insertion amortized O(1).
+		map.emplace_hint(map.end(), std::move(pair));
+	}
+
+	return *this;
+}
+
+template<typename K, typename V, typename H, typename E, typename A>
+Archive& Archive::operator>>(std::unordered_map<K, V, H, E, A>& map)
+{
+	map.clear();
+
+	std::size_t length = this->loadLength();
+	map.reserve(std::min(length, this->remaining()));
+	for (std::size_t i = 0; i < length; i++) {
+		std::pair<K, V> pair;
+		*this >> pair;
+		map.emplace(std::move(pair));
+	}
+
+	return *this;
+}
+
+template<typename K, typename C, typename A>
+Archive& Archive::operator>>(std::set<K, C, A>& set)
+{
+	set.clear();
+
+	std::size_t length = this->loadLength();
+	for (std::size_t i = 0; i < length; i++) {
+		K key;
+		*this >> key;
+		set.emplace_hint(set.end(), std::move(key));
+	}
+
+	return *this;
+}
+
 template<typename T, IsArchival<T>>
 Archive& Archive::operator>>(T& object)
 {
@@ -202,5 +1018,14 @@ Archive& Archive::operator>>(T& object)
 	return *this;
 }
 
+template<typename T, IsSerializable<T>>
+Archive& Archive::operator>>(T& object)
+{
+	auto fields = object.fields();
+	this->loadFields(fields, IsFlat<decltype(fields)>());
+
+	return *this;
+}
+
 } // namespace stream
 } // namespace rmi
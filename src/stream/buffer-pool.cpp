@@ -0,0 +1,95 @@
+/*
+ *  Copyright (c) 2018 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * @file        buffer-pool.cpp
+ * @author      Sangwan Kwon (sangwan.kwon@samsung.com)
+ * @brief       Implementation of buffer pool.
+ */
+
+#include "buffer-pool.hxx"
+
+#include <utility>
+
+namespace rmi {
+namespace stream {
+
+BufferPool::BufferPool(std::size_t maxBuffers, std::size_t maxCapacity) noexcept :
+	maxBuffers(maxBuffers), maxCapacity(maxCapacity)
+{
+}
+
+BufferPool::Buffer BufferPool::acquire(std::size_t capacity)
+{
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+
+		// The recently released one is the most likely to be hot in cache.
+		for (auto iter = this->buffers.rbegin(); iter != this->buffers.rend(); iter++) {
+			if (iter->capacity() < capacity)
+				continue;
+
+			Buffer buffer = std::move(*iter);
+			this->buffers.erase(std::next(iter).base());
+			this->statistics.hits++;
+
+			return buffer;
+		}
+
+		this->statistics.misses++;
+	}
+
+	Buffer buffer;
+	buffer.reserve(capacity);
+
+	return buffer;
+}
+
+void BufferPool::release(Buffer&& buffer) noexcept
+{
+	if (buffer.capacity() == 0)
+		return;
+
+	std::lock_guard<std::mutex> lock(this->mutex);
+
+	if (buffer.capacity() > this->maxCapacity || this->buffers.size() >= this->maxBuffers) {
+		this->statistics.dropped++;
+		return;
+	}
+
+	if (this->buffers.capacity() == 0)
+		this->buffers.reserve(this->maxBuffers);
+
+	buffer.clear();
+	this->buffers.push_back(std::move(buffer));
+	this->statistics.recycled++;
+}
+
+BufferPool::Statistics BufferPool::getStatistics(void) const noexcept
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return this->statistics;
+}
+
+double BufferPool::getHitRate(void) const noexcept
+{
+	auto statistics = this->getStatistics();
+	auto total = statistics.hits + statistics.misses;
+
+	return (total == 0) ? 0.0 : static_cast<double>(statistics.hits) / total;
+}
+
+} // namespace stream
+} // namespace rmi
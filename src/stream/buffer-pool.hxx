@@ -0,0 +1,77 @@
+/*
+ *  Copyright (c) 2018 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * @file        buffer-pool.hxx
+ * @author      Sangwan Kwon (sangwan.kwon@samsung.com)
+ * @brief       Recycle the buffers of archive.
+ * @details     The archive which has the pool acquires its buffer from the pool,
+ *              and releases the buffer to the pool on destruction.
+ *              So, steady request/reply loop reuses the same buffers.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+namespace rmi {
+namespace stream {
+
+class BufferPool final {
+public:
+	using Buffer = std::vector<unsigned char>;
+
+	struct Statistics {
+		// acquire() served by the pooled buffer
+		std::size_t hits;
+		// acquire() which needs new allocation
+		std::size_t misses;
+		// release() which keeps the buffer
+		std::size_t recycled;
+		// release() which frees the buffer by caps
+		std::size_t dropped;
+	};
+
+	// The buffers over the caps are freed instead of pooled.
+	explicit BufferPool(std::size_t maxBuffers = 64,
+						std::size_t maxCapacity = 1024 * 1024) noexcept;
+	~BufferPool() = default;
+
+	BufferPool(const BufferPool&) = delete;
+	BufferPool& operator=(const BufferPool&) = delete;
+
+	BufferPool(BufferPool&&) = delete;
+	BufferPool& operator=(BufferPool&&) = delete;
+
+	// Return the empty buffer of which capacity is at least the given one.
+	Buffer acquire(std::size_t capacity);
+	void release(Buffer&& buffer) noexcept;
+
+	Statistics getStatistics(void) const noexcept;
+	double getHitRate(void) const noexcept;
+
+private:
+	std::vector<Buffer> buffers;
+	std::size_t maxBuffers;
+	std::size_t maxCapacity;
+
+	Statistics statistics = {0, 0, 0, 0};
+	mutable std::mutex mutex;
+};
+
+} // namespace stream
+} // namespace rmi
@@ -0,0 +1,385 @@
+/*
+ *  Copyright (c) 2018 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * @file        compression.cpp
+ * @author      Sangwan Kwon (sangwan.kwon@samsung.com)
+ * @brief       Implementation of block compressor.
+ */
+
+#include "compression.hxx"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+namespace rmi {
+namespace stream {
+
+namespace {
+
+const std::size_t MIN_MATCH = 4;
+// The last match should start before this and the last literals are kept.
+const std::size_t MATCH_LIMIT = 12;
+const std::size_t LAST_LITERALS = 5;
+const std::size_t MAX_OFFSET = 65535;
+
+const unsigned int HASH_LOG = 12;
+const unsigned int SKIP_TRIGGER = 6;
+
+const unsigned char RUN_MASK = 15;
+
+const std::size_t FRAME_BLOCK_SIZE = 4 * 1024 * 1024;
+const std::size_t FRAME_BLOCK_HEADER_SIZE = 2 * sizeof(std::uint32_t);
+
+template<typename T>
+void write(unsigned char* bytes, T value) noexcept
+{
+	std::memcpy(bytes, &value, sizeof(value));
+}
+
+template<typename T>
+T read(const unsigned char* bytes) noexcept
+{
+	T value;
+	std::memcpy(&value, bytes, sizeof(value));
+	return value;
+}
+
+inline std::uint32_t read32(const unsigned char* bytes) noexcept
+{
+	std::uint32_t value;
+	std::memcpy(&value, bytes, sizeof(value));
+	return value;
+}
+
+inline std::uint64_t read64(const unsigned char* bytes) noexcept
+{
+	std::uint64_t value;
+	std::memcpy(&value, bytes, sizeof(value));
+	return value;
+}
+
+// The length of common prefix, compared by 8 bytes at once.
+inline std::size_t common(const unsigned char* left, const unsigned char* right,
+						  const unsigned char* limit) noexcept
+{
+	const unsigned char* begin = left;
+	while (left + sizeof(std::uint64_t) <= limit) {
+		std::uint64_t diff = read64(left) ^ read64(right);
+		if (diff != 0)
+			return left - begin + (__builtin_ctzll(diff) >> 3);
+
+		left += sizeof(std::uint64_t);
+		right += sizeof(std::uint64_t);
+	}
+
+	while (left < limit && *left == *right) {
+		left++;
+		right++;
+	}
+
+	return left - begin;
+}
+
+inline std::uint32_t hash(std::uint32_t sequence) noexcept
+{
+	return (sequence * 2654435761U) >> (32 - HASH_LOG);
+}
+
+class Output {
+public:
+	Output(unsigned char* bytes, std::size_t capacity) noexcept :
+		bytes(bytes), capacity(capacity) {}
+
+	bool reserve(std::size_t size) const noexcept
+	{
+		return size <= this->capacity - this->position;
+	}
+
+	void put(unsigned char byte) noexcept
+	{
+		this->bytes[this->position++] = byte;
+	}
+
+	void put(const unsigned char* source, std::size_t size) noexcept
+	{
+		std::memcpy(this->bytes + this->position, source, size);
+		this->position += size;
+	}
+
+	// The remains of length over the nibble of token.
+	void putLength(std::size_t length) noexcept
+	{
+		for (; length >= 255; length -= 255)
+			this->put(255);
+		this->put(static_cast<unsigned char>(length));
+	}
+
+	std::size_t size(void) const noexcept
+	{
+		return this->position;
+	}
+
+private:
+	unsigned char* bytes;
+	std::size_t capacity;
+	std::size_t position = 0;
+};
+
+bool emit(Output& output, const unsigned char* literals, std::size_t literalSize,
+		  std::size_t offset, std::size_t matchSize) noexcept
+{
+	bool last = (matchSize == 0);
+
+	std::size_t required = 1 + literalSize + literalSize / 255 + 1;
+	if (!last)
+		required += 2 + (matchSize - MIN_MATCH) / 255 + 1;
+	if (!output.reserve(required))
+		return false;
+
+	std::size_t matchCode = last ? 0 : matchSize - MIN_MATCH;
+	unsigned char token = (literalSize >= RUN_MASK ? RUN_MASK : literalSize) << 4;
+	token |= (matchCode >= RUN_MASK ? RUN_MASK : matchCode);
+
+	output.put(token);
+	if (literalSize >= RUN_MASK)
+		output.putLength(literalSize - RUN_MASK);
+	output.put(literals, literalSize);
+
+	if (last)
+		return true;
+
+	output.put(static_cast<unsigned char>(offset & 0xFF));
+	output.put(static_cast<unsigned char>(offset >> 8));
+	if (matchCode >= RUN_MASK)
+		output.putLength(matchCode - RUN_MASK);
+
+	return true;
+}
+
+std::size_t readLength(const unsigned char* source, std::size_t length, std::size_t& position)
+{
+	std::size_t total = 0;
+	unsigned char byte;
+	do {
+		if (position >= length)
+			throw std::runtime_error("Compressed block is truncated.");
+
+		byte = source[position++];
+		total += byte;
+	} while (byte == 255);
+
+	return total;
+}
+
+} // anonymous namespace
+
+std::size_t compressBound(std::size_t size) noexcept
+{
+	return size + size / 255 + 16;
+}
+
+std::size_t compress(const unsigned char* source, std::size_t size,
+					 unsigned char* destination, std::size_t capacity) noexcept
+{
+	Output output(destination, capacity);
+
+	std::size_t anchor = 0;
+	if (size > MATCH_LIMIT) {
+		// The positions of recent 4-byte sequences by hash.
+		std::uint32_t table[1 << HASH_LOG] = {0, };
+
+		std::size_t limit = size - MATCH_LIMIT;
+		std::size_t matchEnd = size - LAST_LITERALS;
+		std::size_t position = 0;
+		std::size_t attempts = 1 << SKIP_TRIGGER;
+
+		while (position < limit) {
+			std::uint32_t sequence = read32(source + position);
+			auto& slot = table[hash(sequence)];
+			std::size_t candidate = slot;
+			slot = static_cast<std::uint32_t>(position);
+
+			if (candidate >= position || position - candidate > MAX_OFFSET ||
+				read32(source + candidate) != sequence) {
+				// Skip faster over incompressible bytes.
+				position += attempts++ >> SKIP_TRIGGER;
+				continue;
+			}
+			attempts = 1 << SKIP_TRIGGER;
+
+			while (position > anchor && candidate > 0 &&
+				   source[position - 1] == source[candidate - 1]) {
+				position--;
+				candidate--;
+			}
+
+			std::size_t matchSize = MIN_MATCH;
+			matchSize += common(source + position + MIN_MATCH, source + candidate + MIN_MATCH,
+								source + matchEnd);
+
+			if (!emit(output, source + anchor, position - anchor,
+					  position - candidate, matchSize))
+				return 0;
+
+			position += matchSize;
+			anchor = position;
+		}
+	}
+
+	if (!emit(output, source + anchor, size - anchor, 0, 0))
+		return 0;
+
+	return output.size();
+}
+
+void decompress(const unsigned char* source, std::size_t length,
+				unsigned char* destination, std::size_t size)
+{
+	std::size_t input = 0;
+	std::size_t output = 0;
+
+	while (input < length) {
+		unsigned char token = source[input++];
+
+		std::size_t literalSize = token >> 4;
+		if (literalSize == RUN_MASK)
+			literalSize += readLength(source, length, input);
+
+		if (literalSize > length - input || literalSize > size - output)
+			throw std::runtime_error("Compressed block has wrong literal length.");
+
+		std::memcpy(destination + output, source + input, literalSize);
+		input += literalSize;
+		output += literalSize;
+
+		// The last sequence has only literals.
+		if (input == length)
+			break;
+
+		if (length - input < 2)
+			throw std::runtime_error("Compressed block is truncated.");
+
+		std::size_t offset = source[input] | (source[input + 1] << 8);
+		input += 2;
+		if (offset == 0 || offset > output)
+			throw std::runtime_error("Compressed block has wrong offset.");
+
+		std::size_t matchSize = token & RUN_MASK;
+		if (matchSize == RUN_MASK)
+			matchSize += readLength(source, length, input);
+		matchSize += MIN_MATCH;
+
+		if (matchSize > size - output)
+			throw std::runtime_error("Compressed block has wrong match length.");
+
+		unsigned char* match = destination + output - offset;
+		if (offset >= matchSize) {
+			std::memcpy(destination + output, match, matchSize);
+		} else {
+			// Overlapped copy repeats the pattern.
+			for (std::size_t i = 0; i < matchSize; i++)
+				destination[output + i] = match[i];
+		}
+		output += matchSize;
+	}
+
+	if (output != size)
+		throw std::runtime_error("Compressed block has wrong size.");
+}
+
+std::size_t compressFrame(const std::vector<BlobView>& pieces, std::uint64_t size,
+						  unsigned char* destination, std::size_t capacity) noexcept
+{
+	if (capacity < sizeof(size))
+		return 0;
+
+	write(destination, size);
+	std::size_t position = sizeof(size);
+
+	for (const auto& piece : pieces) {
+		for (std::size_t offset = 0; offset < piece.size(); offset += FRAME_BLOCK_SIZE) {
+			auto raw = std::min(FRAME_BLOCK_SIZE, piece.size() - offset);
+			auto source = piece.data() + offset;
+
+			if (capacity - position < FRAME_BLOCK_HEADER_SIZE)
+				return 0;
+
+			auto block = destination + position + FRAME_BLOCK_HEADER_SIZE;
+			auto available = capacity - position - FRAME_BLOCK_HEADER_SIZE;
+			auto stored = compress(source, raw, block, std::min(available, raw - 1));
+			if (stored == 0) {
+				if (available < raw)
+					return 0;
+
+				std::memcpy(block, source, raw);
+				stored = raw;
+			}
+
+			write(destination + position, static_cast<std::uint32_t>(raw));
+			write(destination + position + sizeof(std::uint32_t),
+				  static_cast<std::uint32_t>(stored));
+			position += FRAME_BLOCK_HEADER_SIZE + stored;
+		}
+	}
+
+	return position;
+}
+
+std::uint64_t frameSize(const unsigned char* source, std::size_t length)
+{
+	if (length < sizeof(std::uint64_t))
+		throw std::runtime_error("Compressed frame is truncated.");
+
+	return read<std::uint64_t>(source);
+}
+
+void decompressFrame(const unsigned char* source, std::size_t length,
+					 unsigned char* destination, std::size_t size)
+{
+	if (frameSize(source, length) != size)
+		throw std::runtime_error("Compressed frame has wrong size.");
+
+	std::size_t position = sizeof(std::uint64_t);
+	std::size_t offset = 0;
+
+	while (position < length) {
+		if (length - position < FRAME_BLOCK_HEADER_SIZE)
+			throw std::runtime_error("Compressed frame is truncated.");
+
+		std::size_t raw = read<std::uint32_t>(source + position);
+		std::size_t stored = read<std::uint32_t>(source + position + sizeof(std::uint32_t));
+		position += FRAME_BLOCK_HEADER_SIZE;
+
+		if (stored > length - position || raw > size - offset || stored > raw)
+			throw std::runtime_error("Compressed frame has wrong block size.");
+
+		if (stored == raw)
+			std::memcpy(destination + offset, source + position, raw);
+		else
+			decompress(source + position, stored, destination + offset, raw);
+
+		position += stored;
+		offset += raw;
+	}
+
+	if (offset != size)
+		throw std::runtime_error("Compressed frame has wrong size.");
+}
+
+} // namespace stream
+} // namespace rmi
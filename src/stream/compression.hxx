@@ -0,0 +1,64 @@
+/*
+ *  Copyright (c) 2018 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * @file        compression.hxx
+ * @author      Sangwan Kwon (sangwan.kwon@samsung.com)
+ * @brief       Fast block compressor. (LZ4 block format)
+ * @details     The block is a sequence of literals and back-references
+ *              within 64KB window. It favors speed over ratio, so that
+ *              compressing costs less than sending the saved bytes.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "view.hxx"
+
+namespace rmi {
+namespace stream {
+
+// The maximum compressed size of the given bytes. (incompressible case)
+std::size_t compressBound(std::size_t size) noexcept;
+
+// Return the compressed size, or 0 if it does not fit in capacity.
+std::size_t compress(const unsigned char* source, std::size_t size,
+					 unsigned char* destination, std::size_t capacity) noexcept;
+
+// Decompress exactly size bytes. Throw std::runtime_error if malformed.
+void decompress(const unsigned char* source, std::size_t length,
+				unsigned char* destination, std::size_t size);
+
+// The frame compresses the scattered pieces by blocks:
+//   [raw size(8)] [[raw(4)] [stored(4)] [block]]...
+// The block is stored as is if it is not compressible. (stored == raw)
+// Return the frame size, or 0 if it does not fit in capacity.
+std::size_t compressFrame(const std::vector<BlobView>& pieces, std::uint64_t size,
+						  unsigned char* destination, std::size_t capacity) noexcept;
+
+// The raw size of frame. Throw std::runtime_error if truncated.
+std::uint64_t frameSize(const unsigned char* source, std::size_t length);
+
+void decompressFrame(const unsigned char* source, std::size_t length,
+					 unsigned char* destination, std::size_t size);
+
+// The ratio of compressor can't be higher than this.
+constexpr std::size_t MAX_COMPRESSION_RATIO = 256;
+
+} // namespace stream
+} // namespace rmi
@@ -0,0 +1,188 @@
+/*
+ *  Copyright (c) 2018 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * @file        descriptor.cpp
+ * @author      Sangwan Kwon (sangwan.kwon@samsung.com)
+ * @brief       Implementation of descriptor and sealed blob.
+ */
+
+#include "descriptor.hxx"
+
+#include <stdexcept>
+#include <utility>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace rmi {
+namespace stream {
+
+namespace {
+
+const int SEALS = F_SEAL_WRITE | F_SEAL_SHRINK | F_SEAL_GROW;
+
+} // anonymous namespace
+
+Descriptor::Descriptor(int fd)
+{
+	if (fd < 0)
+		throw std::invalid_argument("Wrong descriptor.");
+
+	this->handle.reset(new int(fd), [](int* fd) {
+		if (*fd != -1)
+			::close(*fd);
+		delete fd;
+	});
+}
+
+Descriptor Descriptor::duplicate(int fd)
+{
+	int copy = ::fcntl(fd, F_DUPFD_CLOEXEC, 0);
+	if (copy == -1)
+		throw std::runtime_error("Failed to duplicate descriptor.");
+
+	return Descriptor(copy);
+}
+
+int Descriptor::get(void) const noexcept
+{
+	return (this->handle != nullptr) ? *this->handle : -1;
+}
+
+bool Descriptor::valid(void) const noexcept
+{
+	return this->handle != nullptr;
+}
+
+int Descriptor::release(void)
+{
+	if (this->handle == nullptr)
+		return -1;
+
+	if (this->handle.use_count() != 1)
+		throw std::runtime_error("Descriptor is shared.");
+
+	int fd = *this->handle;
+	*this->handle = -1;
+	this->handle.reset();
+
+	return fd;
+}
+
+SealedBlob::SealedBlob(std::size_t size) : length(size)
+{
+	int fd = ::memfd_create("rmi-sealed-blob", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+	if (fd == -1)
+		throw std::runtime_error("Failed to create memfd.");
+
+	this->descriptor = Descriptor(fd);
+	if (::ftruncate(fd, size) == -1)
+		throw std::runtime_error("Failed to size memfd.");
+
+	this->map(true);
+}
+
+SealedBlob::SealedBlob(Descriptor descriptor) :
+	descriptor(std::move(descriptor)), sealed(true)
+{
+	int fd = this->descriptor.get();
+	auto seals = ::fcntl(fd, F_GET_SEALS);
+	if (seals == -1 || (seals & SEALS) != SEALS)
+		throw std::runtime_error("Blob is not sealed.");
+
+	struct stat status;
+	if (::fstat(fd, &status) == -1)
+		throw std::runtime_error("Failed to get size of blob.");
+
+	this->length = static_cast<std::size_t>(status.st_size);
+	this->map(false);
+}
+
+void SealedBlob::seal(void)
+{
+	if (this->sealed)
+		return;
+
+	// The writable mapping prevents F_SEAL_WRITE, so the copies should not share it.
+	if (this->mapping.use_count() > 1)
+		throw std::runtime_error("Blob is still mapped by its copies.");
+
+	this->mapping.reset();
+	if (::fcntl(this->descriptor.get(), F_ADD_SEALS, SEALS | F_SEAL_SEAL) == -1) {
+		// Map it back to be written and sealed again. (e.g. EBUSY)
+		this->map(true);
+		throw std::runtime_error("Failed to seal blob.");
+	}
+
+	this->sealed = true;
+	this->map(false);
+}
+
+bool SealedBlob::isSealed(void) const noexcept
+{
+	return this->sealed;
+}
+
+unsigned char* SealedBlob::writable(void)
+{
+	if (this->sealed)
+		throw std::runtime_error("Blob is sealed.");
+
+	return this->mapping.get();
+}
+
+const unsigned char* SealedBlob::data(void) const noexcept
+{
+	return this->mapping.get();
+}
+
+std::size_t SealedBlob::size(void) const noexcept
+{
+	return this->length;
+}
+
+BlobView SealedBlob::view(void) const noexcept
+{
+	return BlobView(this->mapping.get(), this->length);
+}
+
+const Descriptor& SealedBlob::getDescriptor(void) const noexcept
+{
+	return this->descriptor;
+}
+
+void SealedBlob::map(bool writable)
+{
+	// Mapping zero bytes fails.
+	if (this->length == 0)
+		return;
+
+	int protection = writable ? (PROT_READ | PROT_WRITE) : PROT_READ;
+	auto address = ::mmap(nullptr, this->length, protection, MAP_SHARED,
+						  this->descriptor.get(), 0);
+	if (address == MAP_FAILED)
+		throw std::runtime_error("Failed to map blob.");
+
+	auto size = this->length;
+	this->mapping.reset(reinterpret_cast<unsigned char*>(address),
+						[size](unsigned char* address) { ::munmap(address, size); });
+}
+
+} // namespace stream
+} // namespace rmi
@@ -0,0 +1,91 @@
+/*
+ *  Copyright (c) 2018 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * @file        descriptor.hxx
+ * @author      Sangwan Kwon (sangwan.kwon@samsung.com)
+ * @brief       File descriptors which are passed with archive.
+ * @details     Descriptor and SealedBlob are serialized as a presence flag,
+ *              and the descriptors themselves are kept aside by archive to
+ *              be passed through the Unix socket. (SCM_RIGHTS)
+ *              SealedBlob is a memfd which can not be changed once sealed,
+ *              so the large bytes are shared between processes without copy,
+ *              and the receiver maps them read-only.
+ */
+
+#pragma once
+
+#include "view.hxx"
+
+#include <cstddef>
+#include <memory>
+
+namespace rmi {
+namespace stream {
+
+class Descriptor final {
+public:
+	Descriptor(void) noexcept = default;
+	// Take the ownership of fd. (The copies share it, and the last one closes.)
+	explicit Descriptor(int fd);
+
+	// Own the duplicate, leaving fd to the caller.
+	static Descriptor duplicate(int fd);
+
+	// Return -1 if empty.
+	int get(void) const noexcept;
+	bool valid(void) const noexcept;
+
+	// Give up the ownership to the caller.
+	// Throw std::runtime_error if it is shared with the copies.
+	int release(void);
+
+private:
+	std::shared_ptr<int> handle;
+};
+
+class SealedBlob final {
+public:
+	SealedBlob(void) noexcept = default;
+	// Create the writable memory to be filled through writable() before seal().
+	explicit SealedBlob(std::size_t size);
+	// Map the received one read-only.
+	// Throw std::runtime_error if it is not sealed against writing and resizing.
+	explicit SealedBlob(Descriptor descriptor);
+
+	// Forbid writing and resizing for good, then remap read-only.
+	// (The unsealed copies should be released before.)
+	void seal(void);
+	bool isSealed(void) const noexcept;
+
+	// The memory to be filled. (Throw std::runtime_error if it is sealed.)
+	unsigned char* writable(void);
+	const unsigned char* data(void) const noexcept;
+	std::size_t size(void) const noexcept;
+	BlobView view(void) const noexcept;
+
+	const Descriptor& getDescriptor(void) const noexcept;
+
+private:
+	void map(bool writable);
+
+	Descriptor descriptor;
+	std::shared_ptr<unsigned char> mapping;
+	std::size_t length = 0;
+	bool sealed = false;
+};
+
+} // namespace stream
+} // namespace rmi
@@ -0,0 +1,854 @@
+/*
+ *  Copyright (c) 2018 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * @file        kernel.cpp
+ * @author      Sangwan Kwon (sangwan.kwon@samsung.com)
+ * @brief       Implementation of vectorized kernels.
+ */
+
+#include "kernel.hxx"
+#include "varint.hxx"
+
+#include <atomic>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define RMI_KERNEL_X86
+#include <immintrin.h>
+#endif
+
+#define RMI_TARGET_SSE41 __attribute__((target("sse4.1")))
+#define RMI_TARGET_AVX2 __attribute__((target("avx2")))
+
+namespace rmi {
+namespace stream {
+namespace kernel {
+
+namespace {
+
+std::atomic<int> selected(-1);
+
+// The elements are accessed by memcpy, since the callers pass
+// the other integer types of the same size. (e.g. long long as uint64_t)
+template<typename T>
+inline T loadAt(const T* array, std::size_t index) noexcept
+{
+	T value;
+	std::memcpy(&value, array + index, sizeof(value));
+	return value;
+}
+
+template<typename T>
+inline void storeAt(T* array, std::size_t index, T value) noexcept
+{
+	std::memcpy(array + index, &value, sizeof(value));
+}
+
+inline std::uint32_t zigzag32(std::uint32_t value) noexcept
+{
+	return (value << 1) ^ static_cast<std::uint32_t>(static_cast<std::int32_t>(value) >> 31);
+}
+
+inline std::uint32_t unzigzag32(std::uint32_t value) noexcept
+{
+	return (value >> 1) ^ (0U - (value & 1));
+}
+
+inline std::uint64_t zigzag64(std::uint64_t value) noexcept
+{
+	return (value << 1) ^ static_cast<std::uint64_t>(static_cast<std::int64_t>(value) >> 63);
+}
+
+inline std::uint64_t unzigzag64(std::uint64_t value) noexcept
+{
+	return (value >> 1) ^ (0ULL - (value & 1));
+}
+
+std::size_t encodeScalar(const std::uint32_t* values, std::size_t begin, std::size_t end,
+						 unsigned char* out, bool zigzag) noexcept
+{
+	std::size_t size = 0;
+	for (std::size_t i = begin; i < end; i++) {
+		auto value = loadAt(values, i);
+		size += encodeVarint(zigzag ? zigzag32(value) : value, out + size);
+	}
+
+	return size;
+}
+
+std::size_t encodeScalar(const std::uint64_t* values, std::size_t begin, std::size_t end,
+						 unsigned char* out, bool zigzag) noexcept
+{
+	std::size_t size = 0;
+	for (std::size_t i = begin; i < end; i++) {
+		auto value = loadAt(values, i);
+		size += encodeVarint(zigzag ? zigzag64(value) : value, out + size);
+	}
+
+	return size;
+}
+
+inline std::size_t decodeOne(const unsigned char* in, std::size_t size,
+							 std::uint32_t& value, bool zigzag) noexcept
+{
+	std::uint64_t raw;
+	auto length = decodeVarint(in, size, raw);
+	if (length == 0 || raw > 0xFFFFFFFFULL)
+		return 0;
+
+	value = static_cast<std::uint32_t>(raw);
+	if (zigzag)
+		value = unzigzag32(value);
+
+	return length;
+}
+
+inline std::size_t decodeOne(const unsigned char* in, std::size_t size,
+							 std::uint64_t& value, bool zigzag) noexcept
+{
+	auto length = decodeVarint(in, size, value);
+	if (length != 0 && zigzag)
+		value = unzigzag64(value);
+
+	return length;
+}
+
+template<typename T>
+std::size_t decodeScalar(const unsigned char* in, std::size_t size,
+						 T* values, std::size_t count, bool zigzag) noexcept
+{
+	std::size_t position = 0;
+	for (std::size_t i = 0; i < count; i++) {
+		T value;
+		auto length = decodeOne(in + position, size - position, value, zigzag);
+		if (length == 0)
+			return 0;
+
+		storeAt(values, i, value);
+		position += length;
+	}
+
+	return position;
+}
+
+inline std::uint16_t swapOne(std::uint16_t value) noexcept
+{
+	return __builtin_bswap16(value);
+}
+
+inline std::uint32_t swapOne(std::uint32_t value) noexcept
+{
+	return __builtin_bswap32(value);
+}
+
+inline std::uint64_t swapOne(std::uint64_t value) noexcept
+{
+	return __builtin_bswap64(value);
+}
+
+template<typename T>
+void swapScalar(const T* in, T* out, std::size_t begin, std::size_t end) noexcept
+{
+	for (std::size_t i = begin; i < end; i++)
+		storeAt(out, i, swapOne(loadAt(in, i)));
+}
+
+// Going backward keeps the unread elements when in and out are the same.
+template<typename T>
+void deltaEncodeScalar(const T* in, T* out, std::size_t end) noexcept
+{
+	using U = typename std::make_unsigned<T>::type;
+	for (std::size_t i = end; i-- > 1;) {
+		auto delta = static_cast<U>(loadAt(in, i)) - static_cast<U>(loadAt(in, i - 1));
+		storeAt(out, i, static_cast<T>(delta));
+	}
+
+	if (end > 0)
+		storeAt(out, 0, loadAt(in, 0));
+}
+
+template<typename T>
+void deltaDecodeScalar(const T* in, T* out, std::size_t begin, std::size_t count, T sum) noexcept
+{
+	using U = typename std::make_unsigned<T>::type;
+	auto total = static_cast<U>(sum);
+	for (std::size_t i = begin; i < count; i++) {
+		total += static_cast<U>(loadAt(in, i));
+		storeAt(out, i, static_cast<T>(total));
+	}
+}
+
+#ifdef RMI_KERNEL_X86
+
+// SSE4.1
+
+RMI_TARGET_SSE41
+inline __m128i unzigzag32(__m128i value)
+{
+	__m128i sign = _mm_sub_epi32(_mm_setzero_si128(), _mm_and_si128(value, _mm_set1_epi32(1)));
+	return _mm_xor_si128(_mm_srli_epi32(value, 1), sign);
+}
+
+RMI_TARGET_SSE41
+inline __m128i unzigzag64(__m128i value)
+{
+	__m128i sign = _mm_sub_epi64(_mm_setzero_si128(), _mm_and_si128(value, _mm_set1_epi64x(1)));
+	return _mm_xor_si128(_mm_srli_epi64(value, 1), sign);
+}
+
+RMI_TARGET_SSE41
+std::size_t encodeSSE41(const std::uint32_t* values, std::size_t count,
+						unsigned char* out, bool zigzag) noexcept
+{
+	const __m128i zero = _mm_setzero_si128();
+	std::size_t size = 0;
+	std::size_t i = 0;
+	for (; i + 4 <= count; i += 4) {
+		__m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+		if (zigzag)
+			x = _mm_xor_si128(_mm_slli_epi32(x, 1), _mm_srai_epi32(x, 31));
+
+		__m128i high = _mm_srli_epi32(x, 7);
+		int small = _mm_movemask_epi8(_mm_cmpeq_epi32(high, zero));
+		if (small == 0xFFFF) {
+			// 1 byte each
+			__m128i bytes = _mm_packus_epi16(_mm_packus_epi32(x, x), zero);
+			int word = _mm_cvtsi128_si32(bytes);
+			std::memcpy(out + size, &word, sizeof(word));
+			size += 4;
+			continue;
+		}
+
+		int medium = _mm_movemask_epi8(_mm_cmpeq_epi32(_mm_srli_epi32(x, 14), zero));
+		if (small == 0 && medium == 0xFFFF) {
+			// 2 bytes each
+			__m128i low = _mm_or_si128(_mm_and_si128(x, _mm_set1_epi32(0x7F)), _mm_set1_epi32(0x80));
+			__m128i words = _mm_or_si128(low, _mm_slli_epi32(high, 8));
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(out + size), _mm_packus_epi32(words, words));
+			size += 8;
+			continue;
+		}
+
+		size += encodeScalar(values, i, i + 4, out + size, zigzag);
+	}
+
+	return size + encodeScalar(values, i, count, out + size, zigzag);
+}
+
+RMI_TARGET_SSE41
+std::size_t encodeSSE41(const std::uint64_t* values, std::size_t count,
+						unsigned char* out, bool zigzag) noexcept
+{
+	const __m128i zero = _mm_setzero_si128();
+	std::size_t size = 0;
+	std::size_t i = 0;
+	for (; i + 2 <= count; i += 2) {
+		__m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+		if (zigzag) {
+			__m128i sign = _mm_shuffle_epi32(_mm_srai_epi32(x, 31), _MM_SHUFFLE(3, 3, 1, 1));
+			x = _mm_xor_si128(_mm_slli_epi64(x, 1), sign);
+		}
+
+		if (_mm_movemask_epi8(_mm_cmpeq_epi64(_mm_srli_epi64(x, 7), zero)) == 0xFFFF) {
+			out[size++] = static_cast<unsigned char>(_mm_extract_epi8(x, 0));
+			out[size++] = static_cast<unsigned char>(_mm_extract_epi8(x, 8));
+			continue;
+		}
+
+		size += encodeScalar(values, i, i + 2, out + size, zigzag);
+	}
+
+	return size + encodeScalar(values, i, count, out + size, zigzag);
+}
+
+RMI_TARGET_SSE41
+std::size_t decodeSSE41(const unsigned char* in, std::size_t size,
+						std::uint32_t* values, std::size_t count, bool zigzag) noexcept
+{
+	std::size_t position = 0;
+	std::size_t i = 0;
+	while (i < count) {
+		if (count - i >= 16 && size - position >= 16) {
+			__m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + position));
+			int mask = _mm_movemask_epi8(bytes);
+			if (mask == 0) {
+				// 16 values of 1 byte
+				for (std::size_t k = 0; k < 16; k += 4) {
+					std::int32_t word;
+					std::memcpy(&word, in + position + k, sizeof(word));
+					__m128i x = _mm_cvtepu8_epi32(_mm_cvtsi32_si128(word));
+					if (zigzag)
+						x = unzigzag32(x);
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(values + i + k), x);
+				}
+				i += 16;
+				position += 16;
+				continue;
+			}
+
+			if (mask == 0x5555) {
+				// 8 values of 2 bytes
+				__m128i low = _mm_and_si128(bytes, _mm_set1_epi16(0x7F));
+				__m128i high = _mm_slli_epi16(_mm_srli_epi16(bytes, 8), 7);
+				__m128i words = _mm_or_si128(low, high);
+
+				__m128i first = _mm_cvtepu16_epi32(words);
+				__m128i second = _mm_cvtepu16_epi32(_mm_srli_si128(words, 8));
+				if (zigzag) {
+					first = unzigzag32(first);
+					second = unzigzag32(second);
+				}
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(values + i), first);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(values + i + 4), second);
+				i += 8;
+				position += 16;
+				continue;
+			}
+		}
+
+		std::uint32_t value;
+		auto length = decodeOne(in + position, size - position, value, zigzag);
+		if (length == 0)
+			return 0;
+
+		storeAt(values, i++, value);
+		position += length;
+	}
+
+	return position;
+}
+
+RMI_TARGET_SSE41
+std::size_t decodeSSE41(const unsigned char* in, std::size_t size,
+						std::uint64_t* values, std::size_t count, bool zigzag) noexcept
+{
+	std::size_t position = 0;
+	std::size_t i = 0;
+	while (i < count) {
+		if (count - i >= 16 && size - position >= 16) {
+			__m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + position));
+			if (_mm_movemask_epi8(bytes) == 0) {
+				for (std::size_t k = 0; k < 16; k += 2) {
+					std::uint16_t pair;
+					std::memcpy(&pair, in + position + k, sizeof(pair));
+					__m128i x = _mm_cvtepu8_epi64(_mm_cvtsi32_si128(pair));
+					if (zigzag)
+						x = unzigzag64(x);
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(values + i + k), x);
+				}
+				i += 16;
+				position += 16;
+				continue;
+			}
+		}
+
+		std::uint64_t value;
+		auto length = decodeOne(in + position, size - position, value, zigzag);
+		if (length == 0)
+			return 0;
+
+		storeAt(values, i++, value);
+		position += length;
+	}
+
+	return position;
+}
+
+template<typename T>
+RMI_TARGET_SSE41
+void swapSSE41(const T* in, T* out, std::size_t count, __m128i mask) noexcept
+{
+	const std::size_t lanes = sizeof(__m128i) / sizeof(T);
+	std::size_t i = 0;
+	for (; i + lanes <= count; i += lanes) {
+		__m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_shuffle_epi8(x, mask));
+	}
+
+	swapScalar(in, out, i, count);
+}
+
+RMI_TARGET_SSE41
+__m128i swapMask(std::size_t width) noexcept
+{
+	switch (width) {
+	case 2:
+		return _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+	case 4:
+		return _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+	default:
+		return _mm_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+	}
+}
+
+RMI_TARGET_SSE41
+void deltaEncodeSSE41(const std::int32_t* in, std::int32_t* out, std::size_t count) noexcept
+{
+	std::size_t end = count;
+	for (; end >= 5; end -= 4) {
+		__m128i current = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + end - 4));
+		__m128i previous = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + end - 5));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + end - 4),
+						 _mm_sub_epi32(current, previous));
+	}
+
+	deltaEncodeScalar(in, out, end);
+}
+
+RMI_TARGET_SSE41
+void deltaEncodeSSE41(const std::int64_t* in, std::int64_t* out, std::size_t count) noexcept
+{
+	std::size_t end = count;
+	for (; end >= 3; end -= 2) {
+		__m128i current = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + end - 2));
+		__m128i previous = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + end - 3));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + end - 2),
+						 _mm_sub_epi64(current, previous));
+	}
+
+	deltaEncodeScalar(in, out, end);
+}
+
+RMI_TARGET_SSE41
+void deltaDecodeSSE41(const std::int32_t* in, std::int32_t* out, std::size_t count) noexcept
+{
+	__m128i sum = _mm_setzero_si128();
+	std::size_t i = 0;
+	for (; i + 4 <= count; i += 4) {
+		__m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+		x = _mm_add_epi32(x, _mm_slli_si128(x, 4));
+		x = _mm_add_epi32(x, _mm_slli_si128(x, 8));
+		x = _mm_add_epi32(x, sum);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), x);
+		sum = _mm_shuffle_epi32(x, _MM_SHUFFLE(3, 3, 3, 3));
+	}
+
+	deltaDecodeScalar(in, out, i, count, static_cast<std::int32_t>(_mm_cvtsi128_si32(sum)));
+}
+
+RMI_TARGET_SSE41
+void deltaDecodeSSE41(const std::int64_t* in, std::int64_t* out, std::size_t count) noexcept
+{
+	__m128i sum = _mm_setzero_si128();
+	std::size_t i = 0;
+	for (; i + 2 <= count; i += 2) {
+		__m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+		x = _mm_add_epi64(x, _mm_slli_si128(x, 8));
+		x = _mm_add_epi64(x, sum);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), x);
+		sum = _mm_unpackhi_epi64(x, x);
+	}
+
+	deltaDecodeScalar(in, out, i, count, static_cast<std::int64_t>(_mm_cvtsi128_si64(sum)));
+}
+
+// AVX2
+
+RMI_TARGET_AVX2
+inline __m256i unzigzag32(__m256i value)
+{
+	__m256i sign = _mm256_sub_epi32(_mm256_setzero_si256(),
+									_mm256_and_si256(value, _mm256_set1_epi32(1)));
+	return _mm256_xor_si256(_mm256_srli_epi32(value, 1), sign);
+}
+
+RMI_TARGET_AVX2
+inline __m256i unzigzag64(__m256i value)
+{
+	__m256i sign = _mm256_sub_epi64(_mm256_setzero_si256(),
+									_mm256_and_si256(value, _mm256_set1_epi64x(1)));
+	return _mm256_xor_si256(_mm256_srli_epi64(value, 1), sign);
+}
+
+RMI_TARGET_AVX2
+std::size_t encodeAVX2(const std::uint32_t* values, std::size_t count,
+					   unsigned char* out, bool zigzag) noexcept
+{
+	const __m256i zero = _mm256_setzero_si256();
+	std::size_t size = 0;
+	std::size_t i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+		if (zigzag)
+			x = _mm256_xor_si256(_mm256_slli_epi32(x, 1), _mm256_srai_epi32(x, 31));
+
+		__m256i high = _mm256_srli_epi32(x, 7);
+		int small = _mm256_movemask_epi8(_mm256_cmpeq_epi32(high, zero));
+		if (small == -1) {
+			// 1 byte each
+			__m128i words = _mm_packus_epi32(_mm256_castsi256_si128(x),
+											 _mm256_extracti128_si256(x, 1));
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(out + size),
+							 _mm_packus_epi16(words, words));
+			size += 8;
+			continue;
+		}
+
+		int medium = _mm256_movemask_epi8(_mm256_cmpeq_epi32(_mm256_srli_epi32(x, 14), zero));
+		if (small == 0 && medium == -1) {
+			// 2 bytes each
+			__m256i low = _mm256_or_si256(_mm256_and_si256(x, _mm256_set1_epi32(0x7F)),
+										  _mm256_set1_epi32(0x80));
+			__m256i words = _mm256_or_si256(low, _mm256_slli_epi32(high, 8));
+			__m128i packed = _mm_packus_epi32(_mm256_castsi256_si128(words),
+											  _mm256_extracti128_si256(words, 1));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out + size), packed);
+			size += 16;
+			continue;
+		}
+
+		size += encodeScalar(values, i, i + 8, out + size, zigzag);
+	}
+
+	return size + encodeScalar(values, i, count, out + size, zigzag);
+}
+
+RMI_TARGET_AVX2
+std::size_t encodeAVX2(const std::uint64_t* values, std::size_t count,
+					   unsigned char* out, bool zigzag) noexcept
+{
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i gather = _mm256_setr_epi8(0, 8, -1, -1, -1, -1, -1, -1,
+											-1, -1, -1, -1, -1, -1, -1, -1,
+											0, 8, -1, -1, -1, -1, -1, -1,
+											-1, -1, -1, -1, -1, -1, -1, -1);
+	std::size_t size = 0;
+	std::size_t i = 0;
+	for (; i + 4 <= count; i += 4) {
+		__m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+		if (zigzag)
+			x = _mm256_xor_si256(_mm256_slli_epi64(x, 1), _mm256_cmpgt_epi64(zero, x));
+
+		if (_mm256_movemask_epi8(_mm256_cmpeq_epi64(_mm256_srli_epi64(x, 7), zero)) == -1) {
+			__m256i bytes = _mm256_shuffle_epi8(x, gather);
+			auto first = _mm_extract_epi16(_mm256_castsi256_si128(bytes), 0);
+			auto second = _mm_extract_epi16(_mm256_extracti128_si256(bytes, 1), 0);
+			std::uint32_t word = static_cast<std::uint32_t>(first) |
+								 (static_cast<std::uint32_t>(second) << 16);
+			std::memcpy(out + size, &word, sizeof(word));
+			size += 4;
+			continue;
+		}
+
+		size += encodeScalar(values, i, i + 4, out + size, zigzag);
+	}
+
+	return size + encodeScalar(values, i, count, out + size, zigzag);
+}
+
+RMI_TARGET_AVX2
+std::size_t decodeAVX2(const unsigned char* in, std::size_t size,
+					   std::uint32_t* values, std::size_t count, bool zigzag) noexcept
+{
+	std::size_t position = 0;
+	std::size_t i = 0;
+	while (i < count) {
+		if (count - i >= 32 && size - position >= 32) {
+			__m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + position));
+			int mask = _mm256_movemask_epi8(bytes);
+			if (mask == 0) {
+				// 32 values of 1 byte
+				for (std::size_t k = 0; k < 32; k += 8) {
+					__m128i eight = _mm_loadl_epi64(
+							reinterpret_cast<const __m128i*>(in + position + k));
+					__m256i x = _mm256_cvtepu8_epi32(eight);
+					if (zigzag)
+						x = unzigzag32(x);
+					_mm256_storeu_si256(reinterpret_cast<__m256i*>(values + i + k), x);
+				}
+				i += 32;
+				position += 32;
+				continue;
+			}
+
+			if (mask == 0x55555555) {
+				// 16 values of 2 bytes
+				__m256i low = _mm256_and_si256(bytes, _mm256_set1_epi16(0x7F));
+				__m256i high = _mm256_slli_epi16(_mm256_srli_epi16(bytes, 8), 7);
+				__m256i words = _mm256_or_si256(low, high);
+
+				__m256i first = _mm256_cvtepu16_epi32(_mm256_castsi256_si128(words));
+				__m256i second = _mm256_cvtepu16_epi32(_mm256_extracti128_si256(words, 1));
+				if (zigzag) {
+					first = unzigzag32(first);
+					second = unzigzag32(second);
+				}
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(values + i), first);
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(values + i + 8), second);
+				i += 16;
+				position += 32;
+				continue;
+			}
+		}
+
+		std::uint32_t value;
+		auto length = decodeOne(in + position, size - position, value, zigzag);
+		if (length == 0)
+			return 0;
+
+		storeAt(values, i++, value);
+		position += length;
+	}
+
+	return position;
+}
+
+RMI_TARGET_AVX2
+std::size_t decodeAVX2(const unsigned char* in, std::size_t size,
+					   std::uint64_t* values, std::size_t count, bool zigzag) noexcept
+{
+	std::size_t position = 0;
+	std::size_t i = 0;
+	while (i < count) {
+		if (count - i >= 32 && size - position >= 32) {
+			__m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + position));
+			if (_mm256_movemask_epi8(bytes) == 0) {
+				for (std::size_t k = 0; k < 32; k += 4) {
+					std::int32_t word;
+					std::memcpy(&word, in + position + k, sizeof(word));
+					__m256i x = _mm256_cvtepu8_epi64(_mm_cvtsi32_si128(word));
+					if (zigzag)
+						x = unzigzag64(x);
+					_mm256_storeu_si256(reinterpret_cast<__m256i*>(values + i + k), x);
+				}
+				i += 32;
+				position += 32;
+				continue;
+			}
+		}
+
+		std::uint64_t value;
+		auto length = decodeOne(in + position, size - position, value, zigzag);
+		if (length == 0)
+			return 0;
+
+		storeAt(values, i++, value);
+		position += length;
+	}
+
+	return position;
+}
+
+template<typename T>
+RMI_TARGET_AVX2
+void swapAVX2(const T* in, T* out, std::size_t count, __m128i lane) noexcept
+{
+	const __m256i mask = _mm256_broadcastsi128_si256(lane);
+	const std::size_t lanes = sizeof(__m256i) / sizeof(T);
+	std::size_t i = 0;
+	for (; i + lanes <= count; i += lanes) {
+		__m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_shuffle_epi8(x, mask));
+	}
+
+	swapScalar(in, out, i, count);
+}
+
+RMI_TARGET_AVX2
+void deltaEncodeAVX2(const std::int32_t* in, std::int32_t* out, std::size_t count) noexcept
+{
+	std::size_t end = count;
+	for (; end >= 9; end -= 8) {
+		__m256i current = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + end - 8));
+		__m256i previous = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + end - 9));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + end - 8),
+							_mm256_sub_epi32(current, previous));
+	}
+
+	deltaEncodeScalar(in, out, end);
+}
+
+RMI_TARGET_AVX2
+void deltaEncodeAVX2(const std::int64_t* in, std::int64_t* out, std::size_t count) noexcept
+{
+	std::size_t end = count;
+	for (; end >= 5; end -= 4) {
+		__m256i current = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + end - 4));
+		__m256i previous = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + end - 5));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + end - 4),
+							_mm256_sub_epi64(current, previous));
+	}
+
+	deltaEncodeScalar(in, out, end);
+}
+
+RMI_TARGET_AVX2
+void deltaDecodeAVX2(const std::int32_t* in, std::int32_t* out, std::size_t count) noexcept
+{
+	const __m256i last = _mm256_set1_epi32(7);
+	__m256i sum = _mm256_setzero_si256();
+	std::size_t i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+		// Prefix sum in each lane, then carry the low lane into the high one.
+		x = _mm256_add_epi32(x, _mm256_slli_si256(x, 4));
+		x = _mm256_add_epi32(x, _mm256_slli_si256(x, 8));
+		__m256i carry = _mm256_shuffle_epi32(x, _MM_SHUFFLE(3, 3, 3, 3));
+		x = _mm256_add_epi32(x, _mm256_permute2x128_si256(carry, carry, 0x08));
+		x = _mm256_add_epi32(x, sum);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), x);
+		sum = _mm256_permutevar8x32_epi32(x, last);
+	}
+
+	deltaDecodeScalar(in, out, i, count,
+					  static_cast<std::int32_t>(_mm256_extract_epi32(sum, 0)));
+}
+
+RMI_TARGET_AVX2
+void deltaDecodeAVX2(const std::int64_t* in, std::int64_t* out, std::size_t count) noexcept
+{
+	__m256i sum = _mm256_setzero_si256();
+	std::size_t i = 0;
+	for (; i + 4 <= count; i += 4) {
+		__m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+		x = _mm256_add_epi64(x, _mm256_slli_si256(x, 8));
+		__m256i carry = _mm256_permute4x64_epi64(x, _MM_SHUFFLE(1, 1, 0, 0));
+		x = _mm256_add_epi64(x, _mm256_blend_epi32(_mm256_setzero_si256(), carry, 0xF0));
+		x = _mm256_add_epi64(x, sum);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), x);
+		sum = _mm256_permute4x64_epi64(x, _MM_SHUFFLE(3, 3, 3, 3));
+	}
+
+	deltaDecodeScalar(in, out, i, count,
+					  static_cast<std::int64_t>(_mm256_extract_epi64(sum, 0)));
+}
+
+#endif // RMI_KERNEL_X86
+
+} // anonymous namespace
+
+Isa detect(void) noexcept
+{
+#ifdef RMI_KERNEL_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2"))
+		return Isa::AVX2;
+	if (__builtin_cpu_supports("sse4.1"))
+		return Isa::SSE41;
+#endif
+	return Isa::Scalar;
+}
+
+Isa getIsa(void) noexcept
+{
+	int isa = selected.load(std::memory_order_relaxed);
+	if (isa < 0) {
+		isa = static_cast<int>(detect());
+		selected.store(isa, std::memory_order_relaxed);
+	}
+
+	return static_cast<Isa>(isa);
+}
+
+void setIsa(Isa isa) noexcept
+{
+	if (static_cast<int>(isa) > static_cast<int>(detect()))
+		isa = detect();
+
+	selected.store(static_cast<int>(isa), std::memory_order_relaxed);
+}
+
+#ifdef RMI_KERNEL_X86
+#define RMI_DISPATCH(AVX2_CALL, SSE41_CALL)  \
+	switch (getIsa()) {                       \
+	case Isa::AVX2:                           \
+		return AVX2_CALL;                     \
+	case Isa::SSE41:                          \
+		return SSE41_CALL;                    \
+	default:                                  \
+		break;                                \
+	}
+#else
+#define RMI_DISPATCH(AVX2_CALL, SSE41_CALL)
+#endif
+
+std::size_t encodeVarints(const std::uint32_t* values, std::size_t count,
+						  unsigned char* out, bool zigzag) noexcept
+{
+	RMI_DISPATCH(encodeAVX2(values, count, out, zigzag),
+				 encodeSSE41(values, count, out, zigzag));
+	return encodeScalar(values, 0, count, out, zigzag);
+}
+
+std::size_t encodeVarints(const std::uint64_t* values, std::size_t count,
+						  unsigned char* out, bool zigzag) noexcept
+{
+	RMI_DISPATCH(encodeAVX2(values, count, out, zigzag),
+				 encodeSSE41(values, count, out, zigzag));
+	return encodeScalar(values, 0, count, out, zigzag);
+}
+
+std::size_t decodeVarints(const unsigned char* in, std::size_t size,
+						  std::uint32_t* values, std::size_t count, bool zigzag) noexcept
+{
+	RMI_DISPATCH(decodeAVX2(in, size, values, count, zigzag),
+				 decodeSSE41(in, size, values, count, zigzag));
+	return decodeScalar(in, size, values, count, zigzag);
+}
+
+std::size_t decodeVarints(const unsigned char* in, std::size_t size,
+						  std::uint64_t* values, std::size_t count, bool zigzag) noexcept
+{
+	RMI_DISPATCH(decodeAVX2(in, size, values, count, zigzag),
+				 decodeSSE41(in, size, values, count, zigzag));
+	return decodeScalar(in, size, values, count, zigzag);
+}
+
+void byteSwap(const std::uint16_t* in, std::uint16_t* out, std::size_t count) noexcept
+{
+	RMI_DISPATCH(swapAVX2(in, out, count, swapMask(2)), swapSSE41(in, out, count, swapMask(2)));
+	swapScalar(in, out, 0, count);
+}
+
+void byteSwap(const std::uint32_t* in, std::uint32_t* out, std::size_t count) noexcept
+{
+	RMI_DISPATCH(swapAVX2(in, out, count, swapMask(4)), swapSSE41(in, out, count, swapMask(4)));
+	swapScalar(in, out, 0, count);
+}
+
+void byteSwap(const std::uint64_t* in, std::uint64_t* out, std::size_t count) noexcept
+{
+	RMI_DISPATCH(swapAVX2(in, out, count, swapMask(8)), swapSSE41(in, out, count, swapMask(8)));
+	swapScalar(in, out, 0, count);
+}
+
+void deltaEncode(const std::int32_t* in, std::int32_t* out, std::size_t count) noexcept
+{
+	RMI_DISPATCH(deltaEncodeAVX2(in, out, count), deltaEncodeSSE41(in, out, count));
+	deltaEncodeScalar(in, out, count);
+}
+
+void deltaEncode(const std::int64_t* in, std::int64_t* out, std::size_t count) noexcept
+{
+	RMI_DISPATCH(deltaEncodeAVX2(in, out, count), deltaEncodeSSE41(in, out, count));
+	deltaEncodeScalar(in, out, count);
+}
+
+void deltaDecode(const std::int32_t* in, std::int32_t* out, std::size_t count) noexcept
+{
+	RMI_DISPATCH(deltaDecodeAVX2(in, out, count), deltaDecodeSSE41(in, out, count));
+	deltaDecodeScalar(in, out, 0, count, static_cast<std::int32_t>(0));
+}
+
+void deltaDecode(const std::int64_t* in, std::int64_t* out, std::size_t count) noexcept
+{
+	RMI_DISPATCH(deltaDecodeAVX2(in, out, count), deltaDecodeSSE41(in, out, count));
+	deltaDecodeScalar(in, out, 0, count, static_cast<std::int64_t>(0));
+}
+
+} // namespace kernel
+} // namespace stream
+} // namespace rmi
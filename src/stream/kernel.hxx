@@ -0,0 +1,76 @@
+/*
+ *  Copyright (c) 2018 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * @file        kernel.hxx
+ * @author      Sangwan Kwon (sangwan.kwon@samsung.com)
+ * @brief       Vectorized kernels for numeric arrays.
+ * @details     Each kernel has scalar, SSE4.1 and AVX2 variants, and the best
+ *              one supported by CPU is chosen at runtime. (x86 only for SIMD)
+ *              The varint kernels produce the same bytes as encodeVarint(),
+ *              and take the vector path for the runs of small values.
+ *              The arrays are accessed without alignment requirement.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace rmi {
+namespace stream {
+namespace kernel {
+
+enum class Isa : unsigned char {
+	Scalar,
+	SSE41,
+	AVX2
+};
+
+// The best one supported by CPU.
+Isa detect(void) noexcept;
+// The one used by kernels. (detect() by default)
+Isa getIsa(void) noexcept;
+// Lower the used one to compare or to test. (clamped by detect())
+void setIsa(Isa isa) noexcept;
+
+// Return the written bytes. (out should have MAX_VARINT_SIZE * count bytes)
+// Zigzag maps signed values. (same as zigzag() for the value in range)
+std::size_t encodeVarints(const std::uint32_t* values, std::size_t count,
+						  unsigned char* out, bool zigzag) noexcept;
+std::size_t encodeVarints(const std::uint64_t* values, std::size_t count,
+						  unsigned char* out, bool zigzag) noexcept;
+
+// Return the read bytes, or 0 if truncated, malformed or overflows the type.
+std::size_t decodeVarints(const unsigned char* in, std::size_t size,
+						  std::uint32_t* values, std::size_t count, bool zigzag) noexcept;
+std::size_t decodeVarints(const unsigned char* in, std::size_t size,
+						  std::uint64_t* values, std::size_t count, bool zigzag) noexcept;
+
+// Reverse the byte order of each element. (in and out can be the same)
+void byteSwap(const std::uint16_t* in, std::uint16_t* out, std::size_t count) noexcept;
+void byteSwap(const std::uint32_t* in, std::uint32_t* out, std::size_t count) noexcept;
+void byteSwap(const std::uint64_t* in, std::uint64_t* out, std::size_t count) noexcept;
+
+// out[i] = in[i] - in[i - 1] with wraparound. (in and out can be the same)
+void deltaEncode(const std::int32_t* in, std::int32_t* out, std::size_t count) noexcept;
+void deltaEncode(const std::int64_t* in, std::int64_t* out, std::size_t count) noexcept;
+// The prefix sum which restores deltaEncode(). (in and out can be the same)
+void deltaDecode(const std::int32_t* in, std::int32_t* out, std::size_t count) noexcept;
+void deltaDecode(const std::int64_t* in, std::int64_t* out, std::size_t count) noexcept;
+
+} // namespace kernel
+} // namespace stream
+} // namespace rmi
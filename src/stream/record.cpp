@@ -0,0 +1,72 @@
+/*
+ *  Copyright (c) 2018 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * @file        record.cpp
+ * @author      Sangwan Kwon (sangwan.kwon@samsung.com)
+ * @brief       Implementation of record.
+ */
+
+#include "record.hxx"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace rmi {
+namespace stream {
+
+BlobView Record::field(std::size_t index) const
+{
+	if (index >= this->offsets.size())
+		throw std::out_of_range("Record has no such field.");
+
+	std::size_t begin = (index == 0) ? 0 : this->offsets[index - 1];
+	std::size_t end = this->offsets[index];
+
+	return BlobView(this->body.get() + begin, end - begin);
+}
+
+std::size_t Record::count(void) const noexcept
+{
+	return this->offsets.size();
+}
+
+void Record::pack(Archive& archive) const
+{
+	archive << this->offsets << BlobView(this->body.get(), this->body.size());
+}
+
+void Record::unpack(Archive& archive)
+{
+	BlobView bytes;
+	archive >> this->offsets >> bytes;
+
+	// Validate the table once, so that field() trusts it.
+	std::size_t previous = 0;
+	for (auto offset : this->offsets) {
+		if (offset < previous || offset > bytes.size())
+			throw std::out_of_range("Record has malformed offset table.");
+		previous = offset;
+	}
+
+	// A single copy of the fields. (not decoded until get())
+	this->body = Archive();
+	this->body.resize(bytes.size());
+	if (!bytes.empty())
+		std::memcpy(this->body.get(), bytes.data(), bytes.size());
+}
+
+} // namespace stream
+} // namespace rmi
@@ -0,0 +1,103 @@
+/*
+ *  Copyright (c) 2018 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * @file        record.hxx
+ * @author      Sangwan Kwon (sangwan.kwon@samsung.com)
+ * @brief       Random-access layout of fields. (like flatbuffers)
+ * @details     Record writes the offset table before the fields, so each
+ *              field is decoded lazily in place without unpacking the others.
+ *              The fields are always encoded as Fixed regardless of connection.
+ * @usage       auto record = Record::make(id, name, description, ...);
+ *              auto name = record.get<std::string>(1);
+ */
+
+#pragma once
+
+#include "archive.hxx"
+#include "archive-view.hxx"
+
+#include <cstddef>
+#include <vector>
+
+namespace rmi {
+namespace stream {
+
+class Record : public Archival {
+public:
+	template<typename... Ts>
+	static Record make(const Ts&... fields);
+
+	template<typename T>
+	void add(const T& field);
+
+	// Decode the field at index. (StringView and BlobView borrow the record)
+	template<typename T>
+	T get(std::size_t index) const;
+	template<typename T>
+	void get(std::size_t index, T& field) const;
+
+	// The encoded bytes of the field at index.
+	BlobView field(std::size_t index) const;
+	std::size_t count(void) const noexcept;
+
+	void pack(Archive& archive) const override;
+	void unpack(Archive& archive) override;
+
+private:
+	// The end offset of each field in body.
+	std::vector<std::size_t> offsets;
+	Archive body;
+};
+
+template<typename... Ts>
+Record Record::make(const Ts&... fields)
+{
+	Record record;
+	record.offsets.reserve(sizeof...(Ts));
+	record.body.prepare(fields...);
+
+	using Expand = int[];
+	(void)Expand{0, (record.add(fields), 0)...};
+
+	return record;
+}
+
+template<typename T>
+void Record::add(const T& field)
+{
+	this->body << field;
+	this->offsets.push_back(this->body.size());
+}
+
+template<typename T>
+T Record::get(std::size_t index) const
+{
+	T field;
+	this->get(index, field);
+
+	return field;
+}
+
+template<typename T>
+void Record::get(std::size_t index, T& field) const
+{
+	auto bytes = this->field(index);
+	ArchiveView view(bytes.data(), bytes.size());
+	view >> field;
+}
+
+} // namespace stream
+} // namespace rmi
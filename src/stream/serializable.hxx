@@ -0,0 +1,44 @@
+/*
+ *  Copyright (c) 2018 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * @file        serializable.hxx
+ * @author      Sangwan Kwon (sangwan.kwon@samsung.com)
+ * @brief       Declarative field list for non-virtual serialization.
+ * @details     RMI_SERIALIZE lists the members to be serialized in order.
+ *              Unlike Archival, it generates inline code without virtual
+ *              call, and the fundamental-only fields are copied as a block.
+ * @usage       struct Point {
+ *                  int x;
+ *                  int y;
+ *                  std::string label;
+ *
+ *                  RMI_SERIALIZE(x, y, label)
+ *              };
+ */
+
+#pragma once
+
+#include <tuple>
+
+#define RMI_SERIALIZE(...)                                \
+	auto fields(void) -> decltype(std::tie(__VA_ARGS__))  \
+	{                                                     \
+		return std::tie(__VA_ARGS__);                     \
+	}                                                     \
+	auto fields(void) const -> decltype(std::tie(__VA_ARGS__)) \
+	{                                                     \
+		return std::tie(__VA_ARGS__);                     \
+	}
@@ -0,0 +1,146 @@
+/*
+ *  Copyright (c) 2018 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * @file        traits.hxx
+ * @author      Sangwan Kwon (sangwan.kwon@samsung.com)
+ * @brief       Type traits of serializer.
+ * @details     SerializedSize<T> tells the size of T on wire at compile time,
+ *              when T has always the same size. (fundamental types, array,
+ *              pair and tuple of them) Specialize it for fixed-size archival.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace rmi {
+namespace stream {
+
+class Archival;
+
+template<typename T>
+using IsFundamental = typename std::enable_if<std::is_fundamental<T>::value, int>::type;
+
+template<typename T>
+using IsArchival = typename std::enable_if<std::is_base_of<Archival, T>::value, int>::type;
+
+struct FieldsProbe {
+	template<typename T>
+	static auto test(int) -> decltype(std::declval<const T&>().fields(), std::true_type());
+	template<typename T>
+	static std::false_type test(...);
+};
+
+// The types which list their members by RMI_SERIALIZE().
+template<typename T>
+struct HasFields : decltype(FieldsProbe::test<T>(0)) {};
+
+template<typename T>
+using IsSerializable = typename std::enable_if<HasFields<T>::value &&
+											   !std::is_base_of<Archival, T>::value,
+											   int>::type;
+
+template<typename... Bs>
+struct AllOf : std::true_type {};
+
+template<typename B, typename... Bs>
+struct AllOf<B, Bs...> : std::integral_constant<bool, B::value && AllOf<Bs...>::value> {};
+
+// The fields which are copied as a block on fixed encoding.
+template<typename T>
+struct IsFlat : std::false_type {};
+
+template<typename... Ts>
+struct IsFlat<std::tuple<Ts...>> :
+	AllOf<std::is_fundamental<typename std::decay<Ts>::type>...> {};
+
+// The integers which are varint encoded on compact encoding.
+template<typename T>
+using IsVarint = std::integral_constant<bool, std::is_integral<T>::value &&
+											  !std::is_same<T, bool>::value &&
+											  (sizeof(T) > 1)>;
+
+// The varints which have vectorized kernels.
+template<typename T>
+using IsWideVarint = std::integral_constant<bool, IsVarint<T>::value &&
+												  (sizeof(T) == 4 || sizeof(T) == 8)>;
+
+// The elements which can be copied at once. (vector<bool> is not contiguous)
+template<typename T>
+using IsBulk = std::integral_constant<bool, std::is_arithmetic<T>::value &&
+											!std::is_same<T, bool>::value>;
+
+// fixed: Whether T has always the same size.
+// size: The size on fixed encoding.
+// bound: The upper bound on compact encoding.
+template<typename T, typename Enable = void>
+struct SerializedSize {
+	static constexpr bool fixed = false;
+	static constexpr std::size_t size = 0;
+	static constexpr std::size_t bound = 0;
+};
+
+template<typename... Ts>
+struct PackSize;
+
+template<>
+struct PackSize<> {
+	static constexpr bool fixed = true;
+	static constexpr std::size_t size = 0;
+	static constexpr std::size_t bound = 0;
+};
+
+template<typename Front, typename... Rest>
+struct PackSize<Front, Rest...> {
+	using FrontSize = SerializedSize<typename std::decay<Front>::type>;
+
+	static constexpr bool fixed = FrontSize::fixed && PackSize<Rest...>::fixed;
+	static constexpr std::size_t size = FrontSize::size + PackSize<Rest...>::size;
+	static constexpr std::size_t bound = FrontSize::bound + PackSize<Rest...>::bound;
+};
+
+template<typename T>
+struct SerializedSize<T, typename std::enable_if<std::is_fundamental<T>::value>::type> {
+	static constexpr bool fixed = true;
+	static constexpr std::size_t size = sizeof(T);
+	// 7 bits per byte on varint
+	static constexpr std::size_t bound = IsVarint<T>::value ? (sizeof(T) * 8 + 6) / 7
+															: sizeof(T);
+};
+
+template<typename T, std::size_t N>
+struct SerializedSize<std::array<T, N>> {
+	static constexpr bool fixed = SerializedSize<T>::fixed;
+	static constexpr std::size_t size = SerializedSize<T>::size * N;
+	static constexpr std::size_t bound = SerializedSize<T>::bound * N;
+};
+
+template<typename T1, typename T2>
+struct SerializedSize<std::pair<T1, T2>> : PackSize<T1, T2> {};
+
+template<typename... Ts>
+struct SerializedSize<std::tuple<Ts...>> : PackSize<Ts...> {};
+
+template<typename T>
+struct SerializedSize<T, typename std::enable_if<HasFields<T>::value>::type> :
+	SerializedSize<decltype(std::declval<const T&>().fields())> {};
+
+} // namespace stream
+} // namespace rmi
@@ -0,0 +1,92 @@
+/*
+ *  Copyright (c) 2018 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * @file        varint.hxx
+ * @author      Sangwan Kwon (sangwan.kwon@samsung.com)
+ * @brief       LEB128 variable-length integer and zigzag encoding.
+ * @details     Each byte carries 7 bits from the least significant group,
+ *              and the high bit marks that more bytes follow.
+ *              Zigzag maps signed integers to unsigned ones. (0, -1, 1, -2 ...)
+ *              so that small negative values are also encoded in a few bytes.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace rmi {
+namespace stream {
+
+constexpr std::size_t MAX_VARINT_SIZE = 10;
+
+inline std::uint64_t zigzag(std::int64_t value) noexcept
+{
+	return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+}
+
+inline std::int64_t unzigzag(std::uint64_t value) noexcept
+{
+	return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+}
+
+// Returns the number of bytes written. (at most MAX_VARINT_SIZE)
+inline std::size_t encodeVarint(std::uint64_t value, unsigned char* out) noexcept
+{
+	std::size_t size = 0;
+	while (value >= 0x80) {
+		out[size++] = static_cast<unsigned char>(value | 0x80);
+		value >>= 7;
+	}
+	out[size++] = static_cast<unsigned char>(value);
+
+	return size;
+}
+
+// Returns the number of bytes read, or 0 if truncated or malformed.
+inline std::size_t decodeVarint(const unsigned char* in, std::size_t size,
+								std::uint64_t& value) noexcept
+{
+	std::uint64_t result = 0;
+	for (std::size_t i = 0; i < size && i < MAX_VARINT_SIZE; i++) {
+		std::uint64_t byte = in[i];
+		// The last byte can carry only 1 bit of 64 bits.
+		if (i == MAX_VARINT_SIZE - 1 && byte > 1)
+			return 0;
+
+		result |= (byte & 0x7F) << (7 * i);
+		if ((byte & 0x80) == 0) {
+			value = result;
+			return i + 1;
+		}
+	}
+
+	return 0;
+}
+
+inline std::size_t varintSize(std::uint64_t value) noexcept
+{
+	std::size_t size = 1;
+	while (value >= 0x80) {
+		value >>= 7;
+		size++;
+	}
+
+	return size;
+}
+
+} // namespace stream
+} // namespace rmi
@@ -0,0 +1,143 @@
+/*
+ *  Copyright (c) 2018 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * @file        view.hxx
+ * @author      Sangwan Kwon (sangwan.kwon@samsung.com)
+ * @brief       Non-owning views of contiguous bytes. (string_view, span like)
+ * @details     Views are serialized as same as std::string. (length + bytes)
+ *              When deserialized, they point into the archive without copying.
+ *              So, they are valid while the archive is alive.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+namespace rmi {
+namespace stream {
+
+template<typename CharT>
+class BasicView {
+public:
+	using Value = CharT;
+
+	BasicView(void) noexcept = default;
+	BasicView(const CharT* data, std::size_t size) noexcept;
+
+	const CharT* data(void) const noexcept;
+	std::size_t size(void) const noexcept;
+	bool empty(void) const noexcept;
+
+	const CharT* begin(void) const noexcept;
+	const CharT* end(void) const noexcept;
+
+	const CharT& operator[](std::size_t index) const noexcept;
+
+	// Copy the viewed bytes.
+	std::string str(void) const;
+
+private:
+	const CharT* pointer = nullptr;
+	std::size_t length = 0;
+};
+
+class StringView : public BasicView<char> {
+public:
+	using BasicView<char>::BasicView;
+
+	StringView(void) noexcept = default;
+	StringView(const char* str) noexcept : BasicView(str, std::strlen(str)) {}
+	StringView(const std::string& str) noexcept : BasicView(str.data(), str.size()) {}
+};
+
+using BlobView = BasicView<unsigned char>;
+
+template<typename CharT>
+BasicView<CharT>::BasicView(const CharT* data, std::size_t size) noexcept :
+	pointer(data), length(size)
+{
+}
+
+template<typename CharT>
+const CharT* BasicView<CharT>::data(void) const noexcept
+{
+	return this->pointer;
+}
+
+template<typename CharT>
+std::size_t BasicView<CharT>::size(void) const noexcept
+{
+	return this->length;
+}
+
+template<typename CharT>
+bool BasicView<CharT>::empty(void) const noexcept
+{
+	return this->length == 0;
+}
+
+template<typename CharT>
+const CharT* BasicView<CharT>::begin(void) const noexcept
+{
+	return this->pointer;
+}
+
+template<typename CharT>
+const CharT* BasicView<CharT>::end(void) const noexcept
+{
+	return this->pointer + this->length;
+}
+
+template<typename CharT>
+const CharT& BasicView<CharT>::operator[](std::size_t index) const noexcept
+{
+	return this->pointer[index];
+}
+
+template<typename CharT>
+std::string BasicView<CharT>::str(void) const
+{
+	return std::string(reinterpret_cast<const char*>(this->pointer), this->length);
+}
+
+template<typename CharT>
+bool operator==(const BasicView<CharT>& lhs, const BasicView<CharT>& rhs) noexcept
+{
+	return lhs.size() == rhs.size() &&
+		   (lhs.size() == 0 || std::memcmp(lhs.data(), rhs.data(), lhs.size()) == 0);
+}
+
+template<typename CharT>
+bool operator!=(const BasicView<CharT>& lhs, const BasicView<CharT>& rhs) noexcept
+{
+	return !(lhs == rhs);
+}
+
+// Let StringView compare with std::string and literals by implicit conversion.
+inline bool operator==(const StringView& lhs, const StringView& rhs) noexcept
+{
+	return static_cast<const BasicView<char>&>(lhs) == static_cast<const BasicView<char>&>(rhs);
+}
+
+inline bool operator!=(const StringView& lhs, const StringView& rhs) noexcept
+{
+	return !(lhs == rhs);
+}
+
+} // namespace stream
+} // namespace rmi
@@ -22,41 +22,404 @@
 
 #include "connection.hxx"
 
+#include "../stream/compression.hxx"
+
+#include <stdexcept>
 #include <utility>
 
 namespace rmi {
 namespace transport {
 
-Connection::Connection(transport::Socket&& socket) noexcept : socket(std::move(socket))
+namespace {
+
+const std::string HANDSHAKE_SIGNATURE = "Handshake";
+const std::string SHARED_MEMORY_SIGNATURE = "SharedMemory";
+
+} // anonymous namespace
+
+constexpr unsigned int Connection::SUPPORTED_FLAGS;
+constexpr std::size_t Connection::COMPRESSION_THRESHOLD;
+constexpr std::size_t Connection::INPUT_BUFFER_SIZE;
+constexpr std::size_t Connection::HIGH_WATERMARK;
+constexpr std::size_t Connection::LOW_WATERMARK;
+
+Connection::Connection(transport::Socket&& socket) noexcept :
+	socket(std::move(socket)), pool(std::make_shared<BufferPool>())
 {
+	this->decoder.setPool(this->pool);
 }
 
-Connection::Connection(const std::string& path) :
-	socket(transport::Socket::connect(path))
+Connection::Connection(const std::string& address, const Socket::Options& options) :
+	socket(transport::Socket::connect(address, options)), pool(std::make_shared<BufferPool>())
 {
+	this->decoder.setPool(this->pool);
+}
+
+Connection::~Connection()
+{
+	for (auto fd : this->descriptors)
+		::close(fd);
 }
 
 void Connection::send(Message& message)
 {
 	std::lock_guard<std::mutex> lock(this->sendMutex);
 
-	message.header.id = this->sequence++;
-	this->socket.send(&message.header);
+	this->fds.clear();
+	for (const auto& descriptor : message.buffer.getDescriptors())
+		this->fds.push_back(descriptor.get());
+
+	if (!this->fds.empty() && !this->socket.isLocal())
+		throw std::invalid_argument("Descriptors can be passed only through Unix socket.");
+
+	// The reply takes the id of request, so it is matched in any order.
+	if (message.header.type != Message::Type::Reply &&
+		message.header.type != Message::Type::Error)
+		message.header.id = this->sequence++;
+	message.header.flags &= ~Message::Flag::Compressed;
+	message.header.descriptors = static_cast<unsigned int>(this->fds.size());
+	const auto& descriptors = message.buffer.getDescriptors();
+
+	// The header on the wire differs from message's one if compressed.
+	Message::Header header = message.header;
+
+	// Send header and the pieces of body with a single system call.
+	message.buffer.gather(this->pieces);
+	this->vector.clear();
+	this->vector.push_back({&header, sizeof(header)});
+
+	std::size_t size = message.buffer.size();
+	if ((this->flags & Message::Flag::Compressed) && size >= this->compressionThreshold &&
+		this->channel == nullptr) {
+		// Borrowed from the pool, so the largest one is not kept by connection.
+		auto compressed = this->pool->acquire(size);
+		compressed.resize(size);
+
+		// Worth only if it is smaller than the raw body.
+		auto length = stream::compressFrame(this->pieces, size, compressed.data(), size);
+		if (length != 0) {
+			header.flags |= Message::Flag::Compressed;
+			header.length = length;
+			this->vector.push_back({compressed.data(), length});
+
+			// The written or queued bytes no longer refer to it.
+			this->transmit(this->vector.data(), this->vector.size(), descriptors);
+			this->pool->release(std::move(compressed));
+			return;
+		}
+
+		this->pool->release(std::move(compressed));
+	}
+
+	for (const auto& piece : this->pieces)
+		this->vector.push_back({const_cast<unsigned char*>(piece.data()), piece.size()});
+
+	this->transmit(this->vector.data(), this->vector.size(), descriptors);
+}
+
+void Connection::transmit(::iovec* vector, std::size_t count,
+						  const std::vector<stream::Descriptor>& descriptors)
+{
+	const int* fds = this->fds.data();
+	std::size_t fdCount = this->fds.size();
+
+	if (!this->nonBlocking) {
+		if (this->channel == nullptr)
+			return this->socket.sendv(vector, count, fds, fdCount);
+
+		// Ahead of the message, so they are received when it is read.
+		if (fdCount > 0) {
+			unsigned char marker = 0;
+			::iovec byte = {&marker, sizeof(marker)};
+			this->socket.sendv(&byte, 1, fds, fdCount);
+		}
+
+		return this->channel->write(vector, count);
+	}
+
+	// Write directly only if nothing is queued ahead.
+	// (The descriptors go with the first byte if it is written.)
+	std::size_t written = 0;
+	if (this->pendingBytes == 0)
+		written = this->writeSome(vector, count, fds, fdCount);
+
+	// Otherwise they are queued to go with the first byte by flushOutput().
+	if (written == 0 && fdCount > 0)
+		this->outputDescriptors.push_back({this->output.size(), descriptors,
+										   std::vector<int>(fds, fds + fdCount)});
+
+	// The rest is copied, since the pieces may not outlive the message.
+	for (std::size_t i = 0; i < count; i++) {
+		if (written >= vector[i].iov_len) {
+			written -= vector[i].iov_len;
+			continue;
+		}
+
+		auto base = reinterpret_cast<const unsigned char*>(vector[i].iov_base);
+		this->output.insert(this->output.end(), base + written, base + vector[i].iov_len);
+		this->pendingBytes += vector[i].iov_len - written;
+		written = 0;
+	}
+
+	if (this->pendingBytes > this->backpressure.peakBytes)
+		this->backpressure.peakBytes = this->pendingBytes;
+
+	this->flushOutput();
+
+	if (!this->congested && this->pendingBytes >= this->highWatermark) {
+		this->congested = true;
+		this->backpressure.engaged++;
+	}
+}
+
+bool Connection::flush(void)
+{
+	std::lock_guard<std::mutex> lock(this->sendMutex);
+
+	return this->flushOutput();
+}
+
+bool Connection::flushOutput(void)
+{
+	while (this->pendingBytes > 0) {
+		::iovec rest = {this->output.data() + this->outputOffset, this->pendingBytes};
+
+		// The descriptors go with the first byte of their message, and the
+		// bytes ahead of the next ones are written apart.
+		const int* fds = nullptr;
+		std::size_t fdCount = 0;
+		for (const auto& queued : this->outputDescriptors) {
+			if (queued.offset == this->outputOffset) {
+				fds = queued.fds.data();
+				fdCount = queued.fds.size();
+				continue;
+			}
+
+			rest.iov_len = queued.offset - this->outputOffset;
+			break;
+		}
+
+		auto written = this->writeSome(&rest, 1, fds, fdCount);
+		if (written == 0)
+			return false;
+
+		if (fdCount > 0)
+			this->outputDescriptors.pop_front();
+
+		this->outputOffset += written;
+		this->pendingBytes -= written;
+
+		if (this->pendingBytes <= this->lowWatermark)
+			this->congested = false;
+	}
+
+	this->congested = false;
+
+	this->output.clear();
+	this->outputOffset = 0;
+
+	return true;
+}
+
+std::size_t Connection::writeSome(const ::iovec* vector, std::size_t count,
+								  const int* fds, std::size_t fdCount)
+{
+	if (this->channel == nullptr)
+		return this->socket.sendSome(vector, count, fds, fdCount);
+
+	// The marker goes ahead only if the message follows it at once.
+	if (fdCount > 0) {
+		if (!this->channel->writable())
+			return 0;
+
+		unsigned char marker = 0;
+		::iovec byte = {&marker, sizeof(marker)};
+		if (this->socket.sendSome(&byte, 1, fds, fdCount) == 0)
+			return 0;
+	}
+
+	return this->channel->writeSome(vector, count);
+}
+
+std::size_t Connection::getPendingBytes(void) const noexcept
+{
+	return this->pendingBytes;
+}
+
+void Connection::setWatermarks(std::size_t high, std::size_t low)
+{
+	if (high == 0 || low > high)
+		throw std::invalid_argument("Low watermark should not be over high watermark.");
+
+	std::lock_guard<std::mutex> lock(this->sendMutex);
+
+	this->highWatermark = high;
+	this->lowWatermark = low;
+}
+
+bool Connection::isCongested(void) const noexcept
+{
+	return this->congested;
+}
+
+Connection::Backpressure Connection::getBackpressure(void) const noexcept
+{
+	std::lock_guard<std::mutex> lock(this->sendMutex);
+
+	return this->backpressure;
+}
+
+void Connection::setNonBlocking(bool enabled)
+{
+	std::lock(this->sendMutex, this->recvMutex);
+	std::lock_guard<std::mutex> sendLock(this->sendMutex, std::adopt_lock);
+	std::lock_guard<std::mutex> recvLock(this->recvMutex, std::adopt_lock);
+
+	this->socket.setNonBlocking(enabled);
+	this->nonBlocking = enabled;
+}
+
+void Connection::fill(void)
+{
+	{
+		std::lock_guard<std::mutex> lock(this->recvMutex);
+
+		// The short read means the socket is drained, so no more read for EAGAIN.
+		bool drained = false;
+		while (!drained)
+			this->receive(drained);
+
+		if (this->channel == nullptr)
+			return;
+
+		// Drain the shared memory until it sleeps without new bytes.
+		do {
+			while (this->channel->read(this->decoder) > 0);
+		} while (!this->channel->sleep());
+	}
+
+	std::lock_guard<std::mutex> lock(this->sendMutex);
+	this->channel->remind();
+}
+
+void Connection::hold(void)
+{
+	if (this->channel == nullptr)
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(this->recvMutex);
+		this->channel->consume();
+	}
+
+	std::lock_guard<std::mutex> lock(this->sendMutex);
+	this->channel->remind();
+}
+
+std::size_t Connection::receive(bool& drained) const
+{
+	// The read stops after the bytes which descriptors are attached to.
+	auto received = this->descriptors.size();
+
+	// The large part is received in place, and the small ones are batched.
+	auto window = this->decoder.window();
+	if (window.size >= INPUT_BUFFER_SIZE && this->channel == nullptr) {
+		auto bytes = this->socket.recvSome(window.data, window.size, &this->descriptors);
+		this->decoder.commit(bytes);
+		drained = bytes < window.size && this->descriptors.size() == received;
+
+		return bytes;
+	}
+
+	if (this->input.size() < INPUT_BUFFER_SIZE)
+		this->input.resize(INPUT_BUFFER_SIZE);
+
+	auto bytes = this->socket.recvSome(this->input.data(), this->input.size(),
+									   &this->descriptors);
+	// The bytes on socket only carry descriptors if the channel is set up.
+	if (this->channel == nullptr)
+		this->decoder.feed(this->input.data(), bytes);
+	drained = bytes < this->input.size() && this->descriptors.size() == received;
+
+	return bytes;
+}
+
+Message Connection::pop(void) const
+{
+	Message message = this->decoder.next();
+
+	std::size_t count = message.header.descriptors;
+	if (count > Socket::MAX_DESCRIPTORS)
+		throw std::runtime_error("Message has too many descriptors.");
+
+	// Through the socket, they arrive with the first byte of message.
+	// Through the shared memory, they are sent on socket ahead of message,
+	// and the reactor waits for them by ready() instead of here.
+	while (this->descriptors.size() < count) {
+		if (this->channel == nullptr || this->nonBlocking)
+			throw std::runtime_error("Descriptors of message are missing.");
+
+		bool drained;
+		if (this->receive(drained) == 0)
+			this->socket.wait(POLLIN);
+	}
+
+	for (std::size_t i = 0; i < count; i++)
+		message.buffer.addDescriptor(stream::Descriptor(this->descriptors[i]));
+	this->descriptors.erase(this->descriptors.begin(), this->descriptors.begin() + count);
+
+	return message;
+}
+
+void Connection::feed(const void* bytes, std::size_t size, std::vector<int>& fds)
+{
+	std::lock_guard<std::mutex> lock(this->recvMutex);
+
+	this->descriptors.insert(this->descriptors.end(), fds.begin(), fds.end());
+	fds.clear();
+
+	if (this->channel == nullptr)
+		this->decoder.feed(bytes, size);
+}
+
+bool Connection::ready(void) const noexcept
+{
+	std::lock_guard<std::mutex> lock(this->recvMutex);
+
+	if (!this->decoder.ready())
+		return false;
+
+	// The wrong count is thrown by next().
+	std::size_t count = this->decoder.front().header.descriptors;
+	return this->channel == nullptr || count > Socket::MAX_DESCRIPTORS ||
+		   this->descriptors.size() >= count;
+}
+
+Message Connection::next(void)
+{
+	std::lock_guard<std::mutex> lock(this->recvMutex);
 
-	this->socket.send(message.buffer.get(), message.header.length);
+	return this->pop();
 }
 
 Message Connection::recv(void) const
 {
 	std::lock_guard<std::mutex> lock(this->recvMutex);
-	Message::Header header;
-	this->socket.recv(&header);
 
-	Message message(header);
-	this->socket.recv(message.buffer.get(), message.size());
-	message.disclose(message.signature);
+	// The following messages read together are kept in decoder.
+	while (!this->decoder.ready()) {
+		if (this->channel != nullptr) {
+			if (this->channel->read(this->decoder) == 0)
+				this->channel->wait();
+			continue;
+		}
 
-	return message;
+		bool drained;
+		if (this->receive(drained) == 0)
+			this->socket.wait(POLLIN);
+	}
+
+	return this->pop();
 }
 
 Message Connection::request(Message& message)
@@ -65,10 +428,133 @@ Message Connection::request(Message& message)
 	return this->recv();
 }
 
+unsigned int Connection::negotiate(unsigned int flags)
+{
+	Message handshake(Message::Type::Handshake, HANDSHAKE_SIGNATURE);
+	handshake.enclose(flags);
+
+	Message reply = this->request(handshake);
+	if (reply.header.type != Message::Type::Handshake)
+		throw std::runtime_error("Failed to negotiate with server.");
+
+	unsigned int agreed;
+	reply.disclose(agreed);
+
+	this->flags = agreed & flags;
+	if (this->flags & Message::Flag::SharedMemory)
+		this->createChannel();
+
+	return this->flags;
+}
+
+void Connection::createChannel(void)
+{
+	std::unique_ptr<SharedChannel> channel(new SharedChannel(SharedChannel::CAPACITY,
+															 this->getFd()));
+
+	// The channel keeps its own descriptors.
+	Message setup(Message::Type::Handshake, SHARED_MEMORY_SIGNATURE);
+	setup.enclose(stream::Descriptor::duplicate(channel->getMemoryFd()),
+				  stream::Descriptor::duplicate(channel->getNotifyFd()));
+
+	// Nothing else is sent on socket until server switches to the channel.
+	Message reply = this->request(setup);
+	if (reply.header.type != Message::Type::Handshake)
+		throw std::runtime_error("Failed to set up shared memory.");
+
+	std::lock_guard<std::mutex> sendLock(this->sendMutex);
+	std::lock_guard<std::mutex> recvLock(this->recvMutex);
+	this->channel = std::move(channel);
+}
+
+void Connection::openChannel(Message& setup)
+{
+	if (!(this->flags & Message::Flag::SharedMemory) || this->channel != nullptr)
+		throw std::runtime_error("Shared memory is not negotiated.");
+
+	stream::Descriptor memory, notify;
+	setup.disclose(memory, notify);
+	if (!memory.valid() || !notify.valid())
+		throw std::runtime_error("Shared memory has wrong descriptors.");
+
+	// Owned by the channel from now.
+	int memoryFd = memory.release();
+	int notifyFd = notify.release();
+	std::unique_ptr<SharedChannel> channel(new SharedChannel(memoryFd, notifyFd,
+															 this->getFd()));
+
+	// The reply goes on socket, since client waits for it there.
+	Message reply(Message::Type::Handshake, SHARED_MEMORY_SIGNATURE);
+	this->send(reply);
+
+	std::lock_guard<std::mutex> sendLock(this->sendMutex);
+	std::lock_guard<std::mutex> recvLock(this->recvMutex);
+	this->channel = std::move(channel);
+}
+
+void Connection::acknowledge(Message& handshake)
+{
+	if (handshake.signature == SHARED_MEMORY_SIGNATURE)
+		return this->openChannel(handshake);
+
+	unsigned int requested;
+	handshake.disclose(requested);
+
+	this->flags = requested & this->supportedFlags;
+	// The memory can not be shared with the remote peer.
+	if (!this->socket.isLocal())
+		this->flags &= ~Message::Flag::SharedMemory;
+
+	Message reply(Message::Type::Handshake, HANDSHAKE_SIGNATURE);
+	reply.enclose(this->flags);
+	this->send(reply);
+}
+
+void Connection::setSupportedFlags(unsigned int flags) noexcept
+{
+	this->supportedFlags = flags & SUPPORTED_FLAGS;
+}
+
 int Connection::getFd(void) const noexcept
 {
 	return this->socket.getFd();
 }
 
+unsigned int Connection::getFlags(void) const noexcept
+{
+	return this->flags;
+}
+
+bool Connection::isAlive(void) const
+{
+	return this->socket.isAlive();
+}
+
+int Connection::getNotifyFd(void) const noexcept
+{
+	return (this->channel != nullptr) ? this->channel->getNotifyFd() : -1;
+}
+
+void Connection::setMaxMessageLength(std::size_t length) noexcept
+{
+	this->decoder.setMaxLength(length);
+}
+
+void Connection::setCompressionThreshold(std::size_t threshold) noexcept
+{
+	this->compressionThreshold = threshold;
+}
+
+void Connection::setPool(const std::shared_ptr<BufferPool>& pool) noexcept
+{
+	this->pool = pool;
+	this->decoder.setPool(pool);
+}
+
+const std::shared_ptr<BufferPool>& Connection::getPool(void) const noexcept
+{
+	return this->pool;
+}
+
 } // namespace transport
 } // namespace rmi
@@ -22,11 +22,19 @@
 
 #pragma once
 
+#include "decoder.hxx"
 #include "message.hxx"
+#include "shared-channel.hxx"
 #include "socket.hxx"
 
+#include <atomic>
+#include <deque>
+#include <memory>
 #include <mutex>
 #include <utility>
+#include <vector>
+
+#include <sys/uio.h>
 
 namespace rmi {
 namespace transport {
@@ -34,32 +42,166 @@ namespace transport {
 class Connection {
 public:
 	explicit Connection(transport::Socket&& socket) noexcept;
-	explicit Connection(const std::string& path);
-	virtual ~Connection() = default;
+	// Connect to the address. (see Socket)
+	explicit Connection(const std::string& address,
+						const Socket::Options& options = Socket::Options());
+	virtual ~Connection();
 
 	Connection(const Connection&) = delete;
 	Connection& operator=(const Connection&) = delete;
 
-	Connection(Connection&&) = default;
-	Connection& operator=(Connection&&) = default;
+	Connection(Connection&&) = delete;
+	Connection& operator=(Connection&&) = delete;
 
 	// server-side
 	void send(Message& message);
 	Message recv(void) const;
+	// Reply the flags which are supported among the requested ones.
+	// (SharedMemory is not supported over TCP.)
+	void acknowledge(Message& handshake);
+	// Restrict the flags to be acknowledged. (SUPPORTED_FLAGS by default)
+	void setSupportedFlags(unsigned int flags) noexcept;
 
 	// client-side
 	Message request(Message& message);
+	// Agree the flags of message with server and return the agreed ones.
+	unsigned int negotiate(unsigned int flags);
 
 	int getFd(void) const noexcept;
+	unsigned int getFlags(void) const noexcept;
+	// False if the peer is gone. (see Socket::isAlive)
+	bool isAlive(void) const;
+	// The eventfd of shared memory to be watched by server, or -1.
+	int getNotifyFd(void) const noexcept;
+
+	// The message buffers of this connection are recycled through the pool.
+	// (It can be shared with other connections which run on the same thread.)
+	void setPool(const std::shared_ptr<BufferPool>& pool) noexcept;
+	const std::shared_ptr<BufferPool>& getPool(void) const noexcept;
+
+	// Reject the received message larger than this.
+	void setMaxMessageLength(std::size_t length) noexcept;
+
+	// Compress the body equal or larger than threshold if it is agreed.
+	void setCompressionThreshold(std::size_t threshold) noexcept;
+
+	// Non-blocking mode for the edge-triggered reactor.
+	// send() writes what is possible and queues the rest to flush() on writable.
+	// (recv() and request() still wait for the message.)
+	// On shared memory, the writable is notified through getNotifyFd().
+	void setNonBlocking(bool enabled);
+	// Read all available bytes until EAGAIN, then pop the messages by next().
+	// Throw std::runtime_error if the peer is closed or the stream is malformed.
+	void fill(void);
+	// The message is not ready until its descriptors arrive on socket.
+	bool ready(void) const noexcept;
+	Message next(void);
+	// Leave the bytes in shared memory and consume its notification. (paused)
+	void hold(void);
+	// Decode the bytes received by others, and take the descriptors.
+	// (The completion-based reactor receives on socket instead of fill().)
+	void feed(const void* bytes, std::size_t size, std::vector<int>& fds);
+	// Write the queued bytes and return true if nothing is left.
+	bool flush(void);
+	// Readable from any thread while others send.
+	std::size_t getPendingBytes(void) const noexcept;
+
+	// The connection is congested once the queued bytes reach high watermark,
+	// and until they are flushed down to low watermark. Then the caller should
+	// stop reading, so the queue is bounded by high watermark and the replies
+	// of the messages already read.
+	void setWatermarks(std::size_t high, std::size_t low);
+	bool isCongested(void) const noexcept;
+
+	struct Backpressure {
+		// How many times the connection became congested.
+		std::size_t engaged;
+		// The most bytes which were queued at once.
+		std::size_t peakBytes;
+	};
+	Backpressure getBackpressure(void) const noexcept;
+
+	static constexpr unsigned int SUPPORTED_FLAGS = Message::Flag::Compact |
+													Message::Flag::Compressed |
+													Message::Flag::SharedMemory |
+													Message::Flag::Ordered |
+													Message::Flag::OrderedPerObject;
+	static constexpr std::size_t COMPRESSION_THRESHOLD = 64 * 1024;
+	// The smaller parts of message are read at once through the input buffer.
+	static constexpr std::size_t INPUT_BUFFER_SIZE = 64 * 1024;
+	static constexpr std::size_t HIGH_WATERMARK = 4 * 1024 * 1024;
+	static constexpr std::size_t LOW_WATERMARK = 1024 * 1024;
 
 private:
+	// Client sends the descriptors of shared memory after negotiation,
+	// and server maps them and replies before switching.
+	void createChannel(void);
+	void openChannel(Message& setup);
+
+	// Read once what is available and decode it. (under recvMutex)
+	// Drained is set if the socket had less than requested.
+	std::size_t receive(bool& drained) const;
+	// Pop the decoded message with its descriptors. (under recvMutex)
+	Message pop(void) const;
+
+	// Write or queue the buffers in order. (under sendMutex)
+	// (The descriptors are this->fds, owned by descriptors.)
+	void transmit(::iovec* vector, std::size_t count,
+				  const std::vector<stream::Descriptor>& descriptors);
+	bool flushOutput(void);
+	// Write what is possible without waiting. (under sendMutex)
+	// The descriptors are sent if and only if some bytes are written.
+	std::size_t writeSome(const ::iovec* vector, std::size_t count,
+						  const int* fds, std::size_t fdCount);
+
 	transport::Socket socket;
 
+	unsigned int flags = Message::Flag::None;
+	unsigned int supportedFlags = SUPPORTED_FLAGS;
+
+	std::shared_ptr<BufferPool> pool;
+	std::size_t compressionThreshold = COMPRESSION_THRESHOLD;
+
 	// SOCK_STREAM are full-duplex byte streams
 	mutable std::mutex sendMutex;
 	mutable std::mutex recvMutex;
 
+	// Guarded by recvMutex.
+	mutable Decoder decoder;
+
 	unsigned int sequence = 0;
+
+	// Reused by send() under sendMutex.
+	std::vector<stream::BlobView> pieces;
+	std::vector<::iovec> vector;
+	std::vector<int> fds;
+
+	bool nonBlocking = false;
+	// Guarded by recvMutex.
+	mutable std::vector<unsigned char> input;
+	// The bytes which are not written yet. (guarded by sendMutex)
+	std::vector<unsigned char> output;
+	std::size_t outputOffset = 0;
+	// Written under sendMutex, but read by the reactor without it.
+	std::atomic<std::size_t> pendingBytes{0};
+	std::size_t highWatermark = HIGH_WATERMARK;
+	std::size_t lowWatermark = LOW_WATERMARK;
+	std::atomic<bool> congested{false};
+	Backpressure backpressure = {0, 0};
+	// The descriptors which go with the byte at offset of output.
+	// (Kept open by the copies of message's ones until sent.)
+	struct QueuedDescriptors {
+		std::size_t offset;
+		std::vector<stream::Descriptor> descriptors;
+		std::vector<int> fds;
+	};
+	std::deque<QueuedDescriptors> outputDescriptors;
+
+	// Replaces socket for messages once it is set up.
+	// (The socket carries only a byte for each message with descriptors.)
+	std::unique_ptr<SharedChannel> channel;
+	// The received descriptors not popped yet. (guarded by recvMutex)
+	mutable std::vector<int> descriptors;
 };
 
 } // namespace transport
@@ -0,0 +1,186 @@
+/*
+ *  Copyright (c) 2018 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * @file        decoder.cpp
+ * @author      Sangwan Kwon (sangwan.kwon@samsung.com)
+ * @brief       Implementation of decoder.
+ */
+
+#include "decoder.hxx"
+
+#include "../stream/compression.hxx"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+namespace rmi {
+namespace transport {
+
+constexpr std::size_t Decoder::MAX_LENGTH;
+
+Decoder::Decoder(std::size_t maxLength) noexcept : maxLength(maxLength)
+{
+}
+
+Decoder::Window Decoder::window(void)
+{
+	switch (this->state) {
+	case State::Header:
+		return {reinterpret_cast<unsigned char*>(&this->header) + this->received,
+				sizeof(this->header) - this->received};
+	case State::Body:
+		return {this->message.buffer.get() + this->received,
+				this->message.size() - this->received};
+	default:
+		throw std::runtime_error("Decoder is failed.");
+	}
+}
+
+void Decoder::commit(std::size_t size)
+{
+	if (size > this->window().size)
+		throw std::out_of_range("Decoder received over the window.");
+
+	this->received += size;
+
+	if (this->state == State::Header && this->received == sizeof(this->header))
+		this->onHeader();
+
+	// The body of message can be empty.
+	if (this->state == State::Body && this->received == this->message.size())
+		this->onBody();
+}
+
+void Decoder::feed(const void* bytes, std::size_t size)
+{
+	auto source = reinterpret_cast<const unsigned char*>(bytes);
+	while (size > 0) {
+		auto window = this->window();
+		auto length = std::min(window.size, size);
+
+		std::memcpy(window.data, source, length);
+		this->commit(length);
+
+		source += length;
+		size -= length;
+	}
+}
+
+bool Decoder::ready(void) const noexcept
+{
+	return this->head < this->completed.size();
+}
+
+const Message& Decoder::front(void) const noexcept
+{
+	return this->completed[this->head];
+}
+
+Message Decoder::next(void)
+{
+	if (!this->ready())
+		throw std::out_of_range("Decoder has no completed message.");
+
+	Message message = std::move(this->completed[this->head++]);
+	if (this->head == this->completed.size()) {
+		this->completed.clear();
+		this->head = 0;
+	}
+
+	return message;
+}
+
+bool Decoder::pending(void) const noexcept
+{
+	return this->state == State::Body || this->received > 0;
+}
+
+void Decoder::setPool(const std::shared_ptr<BufferPool>& pool) noexcept
+{
+	this->pool = pool;
+}
+
+void Decoder::setMaxLength(std::size_t maxLength) noexcept
+{
+	this->maxLength = maxLength;
+}
+
+void Decoder::onHeader(void)
+{
+	// Check the length before allocating the body.
+	if (this->header.length > this->maxLength)
+		this->fail("Message is larger than the limit.");
+
+	this->message = Message(this->header, this->pool);
+	this->state = State::Body;
+	this->received = 0;
+}
+
+void Decoder::onBody(void)
+{
+	if (this->header.flags & Message::Flag::Compressed) {
+		auto& frame = this->message.buffer;
+		std::uint64_t size = 0;
+		try {
+			size = stream::frameSize(frame.get(), this->header.length);
+		} catch (const std::runtime_error& e) {
+			this->fail(e.what());
+		}
+
+		if (size > this->maxLength ||
+			size / stream::MAX_COMPRESSION_RATIO > this->header.length)
+			this->fail("Compressed message has wrong size.");
+
+		// The message has the decompressed body as if it is not compressed.
+		Message::Header header = this->header;
+		header.flags &= ~Message::Flag::Compressed;
+		header.length = static_cast<std::size_t>(size);
+
+		Message inflated(header, this->pool);
+		try {
+			stream::decompressFrame(frame.get(), this->header.length,
+									inflated.buffer.get(), inflated.size());
+		} catch (const std::runtime_error& e) {
+			this->fail(e.what());
+		}
+
+		this->message = std::move(inflated);
+	}
+
+	try {
+		this->message.disclose(this->message.signature);
+	} catch (const std::out_of_range&) {
+		this->fail("Message has malformed signature.");
+	}
+
+	this->completed.push_back(std::move(this->message));
+	this->message = Message();
+	this->state = State::Header;
+	this->received = 0;
+}
+
+void Decoder::fail(const std::string& reason)
+{
+	this->state = State::Failed;
+	this->message = Message();
+
+	throw std::runtime_error(reason);
+}
+
+} // namespace transport
+} // namespace rmi
@@ -0,0 +1,102 @@
+/*
+ *  Copyright (c) 2018 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * @file        decoder.hxx
+ * @author      Sangwan Kwon (sangwan.kwon@samsung.com)
+ * @brief       Resumable decoder of messages from byte stream.
+ * @details     The decoder accepts whatever bytes are available and yields
+ *              the completed messages. The bytes are received in place
+ *              through window() and commit(), or copied by feed().
+ *              The malformed or oversized message throws std::runtime_error,
+ *              and the decoder refuses the following bytes. (close the stream)
+ * @usage       while (!decoder.ready()) {
+ *                  auto window = decoder.window();
+ *                  decoder.commit(::read(fd, window.data, window.size));
+ *              }
+ *              Message message = decoder.next();
+ */
+
+#pragma once
+
+#include "message.hxx"
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace rmi {
+namespace transport {
+
+class Decoder final {
+public:
+	struct Window {
+		unsigned char* data;
+		std::size_t size;
+	};
+
+	explicit Decoder(std::size_t maxLength = MAX_LENGTH) noexcept;
+
+	// The bytes which are expected next. (at most the rest of current part)
+	Window window(void);
+	// The given bytes are received into window.
+	void commit(std::size_t size);
+
+	// Copy and decode the given bytes.
+	void feed(const void* bytes, std::size_t size);
+
+	bool ready(void) const noexcept;
+	// The completed message to be popped next. (if ready)
+	const Message& front(void) const noexcept;
+	// Pop the completed message in order.
+	Message next(void);
+
+	// The bytes of incomplete message are pending.
+	bool pending(void) const noexcept;
+
+	void setPool(const std::shared_ptr<BufferPool>& pool) noexcept;
+	// The message larger than this is rejected. (both on wire and decompressed)
+	void setMaxLength(std::size_t maxLength) noexcept;
+
+	static constexpr std::size_t MAX_LENGTH = 64 * 1024 * 1024;
+
+private:
+	enum class State {
+		Header,
+		Body,
+		Failed
+	};
+
+	void onHeader(void);
+	void onBody(void);
+	// Throw with entering the failed state.
+	[[noreturn]] void fail(const std::string& reason);
+
+	State state = State::Header;
+
+	Message::Header header;
+	Message message;
+	// The received bytes of current part. (header or body)
+	std::size_t received = 0;
+	// Cleared when all are popped, so its capacity is reused.
+	std::vector<Message> completed;
+	std::size_t head = 0;
+
+	std::size_t maxLength;
+	std::shared_ptr<BufferPool> pool;
+};
+
+} // namespace transport
+} // namespace rmi
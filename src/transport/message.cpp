@@ -25,16 +25,36 @@
 namespace rmi {
 namespace transport {
 
-Message::Message(unsigned int type, const std::string& signature) :
-	header({0, type, signature.size()}),
+constexpr std::size_t Message::REFERENCE_THRESHOLD;
+
+namespace {
+
+Buffer::Encoding encoding_of(unsigned int flags)
+{
+	if (flags & Message::Flag::Compact)
+		return Buffer::Encoding::Compact;
+
+	return Buffer::Encoding::Fixed;
+}
+
+} // anonymous namespace
+
+Message::Message(unsigned int type, const std::string& signature, unsigned int flags,
+				 const std::shared_ptr<BufferPool>& pool) :
+	header({0, type, signature.size(), flags, 0}),
 	signature(signature)
 {
+	this->buffer.setPool(pool);
+	this->buffer.setEncoding(encoding_of(flags));
 	this->enclose(signature);
 }
 
-Message::Message(Header header) : header(header)
+Message::Message(Header header, const std::shared_ptr<BufferPool>& pool) :
+	header(header)
 {
-	this->buffer.reserve(this->header.length);
+	this->buffer.setPool(pool);
+	this->buffer.setEncoding(encoding_of(header.flags));
+	this->buffer.resize(this->header.length);
 }
 
 std::size_t Message::size(void) const noexcept
@@ -22,6 +22,7 @@
 
 #pragma once
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -31,6 +32,7 @@ namespace rmi {
 namespace transport {
 
 using Buffer = rmi::stream::Archive;
+using BufferPool = rmi::stream::BufferPool;
 
 struct Message final {
 	enum Type : unsigned int {
@@ -38,18 +40,42 @@ struct Message final {
 		MethodCall,
 		Reply,
 		Error,
-		Signal
+		Signal,
+		Handshake,
+		// Several method calls in one message. (see application::Batch)
+		Batch
+	};
+
+	// The features of body which are negotiated per connection by handshake.
+	enum Flag : unsigned int {
+		None = 0,
+		// Integers and lengths are varint encoded.
+		Compact = 1 << 0,
+		// The large body is compressed. (set per message by connection)
+		Compressed = 1 << 1,
+		// The messages go through shared memory instead of socket.
+		SharedMemory = 1 << 2,
+		// The requests are invoked one by one in order, even on the executor
+		// of server. (per connection, or per exposed object)
+		Ordered = 1 << 3,
+		OrderedPerObject = 1 << 4
 	};
 
 	struct Header {
 		unsigned int id;
 		unsigned int type;
 		size_t length;
+		unsigned int flags;
+		// The count of descriptors passed with this message. (SCM_RIGHTS)
+		unsigned int descriptors;
 	};
 
 	explicit Message(void) = default;
-	explicit Message(unsigned int type, const std::string& signature);
-	explicit Message(Header header);
+	// The buffer is acquired from the pool if it is given.
+	explicit Message(unsigned int type, const std::string& signature,
+					 unsigned int flags = Flag::None,
+					 const std::shared_ptr<BufferPool>& pool = nullptr);
+	explicit Message(Header header, const std::shared_ptr<BufferPool>& pool = nullptr);
 
 	~Message(void) noexcept = default;
 
@@ -66,6 +92,9 @@ struct Message final {
 
 	std::size_t size(void) const noexcept;
 
+	// The enclosed bytes larger than this are referenced until sent.
+	static constexpr std::size_t REFERENCE_THRESHOLD = 16 * 1024;
+
 	Header header;
 	std::string signature;
 	Buffer buffer;
@@ -74,6 +103,7 @@ struct Message final {
 template<typename... Args>
 void Message::enclose(Args&&... args)
 {
+	this->buffer.prepare(args...);
 	this->buffer.pack(std::forward<Args>(args)...);
 	header.length = this->buffer.size();
 }
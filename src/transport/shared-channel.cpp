@@ -0,0 +1,443 @@
+/*
+ *  Copyright (c) 2018 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * @file        shared-channel.cpp
+ * @author      Sangwan Kwon (sangwan.kwon@samsung.com)
+ * @brief       Implementation of shared-memory transport.
+ */
+
+#include "shared-channel.hxx"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <thread>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace rmi {
+namespace transport {
+
+namespace {
+
+// Spin before sleeping, since the peer usually replies soon.
+// (Only with other cores, or the peer cannot run while spinning.)
+const int SPIN_COUNT = 128;
+
+// How the reader is sleeping.
+const std::uint32_t AWAKE = 0;
+const std::uint32_t ON_FUTEX = 1;
+const std::uint32_t ON_EVENTFD = 2;
+// Check the hangup of peer periodically while sleeping.
+const long SLEEP_NANOSECONDS = 100 * 1000 * 1000;
+
+const unsigned int SEALS = F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL;
+
+inline void relax(void) noexcept
+{
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_ia32_pause();
+#endif
+}
+
+// Not private, since the words are shared among processes.
+void futex_wait(std::atomic<std::uint32_t>& word, std::uint32_t expected)
+{
+	::timespec timeout = {0, SLEEP_NANOSECONDS};
+	::syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAIT,
+			  expected, &timeout, nullptr, 0);
+}
+
+void futex_wake(std::atomic<std::uint32_t>& word)
+{
+	::syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAKE,
+			  1, nullptr, nullptr, 0);
+}
+
+bool is_power_of_2(std::size_t value)
+{
+	return value != 0 && (value & (value - 1)) == 0;
+}
+
+} // anonymous namespace
+
+constexpr std::size_t SharedChannel::CAPACITY;
+constexpr std::size_t SharedChannel::MAX_CAPACITY;
+constexpr std::chrono::milliseconds::rep SharedChannel::WRITE_TIMEOUT;
+
+SharedChannel::SharedChannel(std::size_t capacity, int socketFd) :
+	client(true), memoryFd(-1), notifyFd(-1), socketFd(socketFd), capacity(capacity)
+{
+	if (!is_power_of_2(capacity) || capacity > MAX_CAPACITY)
+		throw std::invalid_argument("Capacity of shared channel is wrong.");
+
+	this->memoryFd = ::memfd_create("rmi-shared-channel", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+	if (this->memoryFd == -1)
+		throw std::runtime_error("Failed to create memfd.");
+
+	// Sealed, so the server is not faulted by shrinking.
+	auto size = 2 * (sizeof(Control) + capacity);
+	if (::ftruncate(this->memoryFd, size) == -1 ||
+		::fcntl(this->memoryFd, F_ADD_SEALS, SEALS) == -1) {
+		::close(this->memoryFd);
+		throw std::runtime_error("Failed to size memfd.");
+	}
+
+	this->notifyFd = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	if (this->notifyFd == -1) {
+		::close(this->memoryFd);
+		throw std::runtime_error("Failed to create eventfd.");
+	}
+
+	try {
+		this->map();
+	} catch (...) {
+		::close(this->memoryFd);
+		::close(this->notifyFd);
+		throw;
+	}
+
+	// The server starts sleeping on mainloop.
+	new (this->out.control) Control();
+	new (this->in.control) Control();
+	this->out.control->readerWaiting = ON_EVENTFD;
+}
+
+SharedChannel::SharedChannel(int memoryFd, int notifyFd, int socketFd) :
+	client(false), memoryFd(memoryFd), notifyFd(notifyFd), socketFd(socketFd)
+{
+	try {
+		struct ::stat status;
+		if (::fstat(memoryFd, &status) == -1)
+			throw std::runtime_error("Failed to get size of memfd.");
+
+		// Do not trust the layout in the memory written by peer.
+		auto seals = ::fcntl(memoryFd, F_GET_SEALS);
+		if (seals == -1 || (static_cast<unsigned int>(seals) & SEALS) != SEALS)
+			throw std::runtime_error("Shared memory is not sealed.");
+
+		auto size = static_cast<std::size_t>(status.st_size);
+		if (size < 2 * sizeof(Control) || size % 2 != 0)
+			throw std::runtime_error("Size of shared memory is wrong.");
+
+		this->capacity = size / 2 - sizeof(Control);
+		if (!is_power_of_2(this->capacity) || this->capacity > MAX_CAPACITY)
+			throw std::runtime_error("Capacity of shared channel is wrong.");
+
+		this->map();
+	} catch (...) {
+		::close(memoryFd);
+		::close(notifyFd);
+		throw;
+	}
+}
+
+SharedChannel::~SharedChannel(void)
+{
+	// Wake up the peer to tell closing.
+	for (auto control : {this->in.control, this->out.control}) {
+		control->closed = 1;
+		futex_wake(control->readerWaiting);
+		futex_wake(control->writerWaiting);
+	}
+
+	::munmap(this->memory, 2 * (sizeof(Control) + this->capacity));
+	::close(this->memoryFd);
+	::close(this->notifyFd);
+}
+
+void SharedChannel::map(void)
+{
+	auto size = 2 * (sizeof(Control) + this->capacity);
+	this->memory = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, this->memoryFd, 0);
+	if (this->memory == MAP_FAILED)
+		throw std::runtime_error("Failed to map shared memory.");
+
+	// [requests: control, data][replies: control, data]
+	auto base = reinterpret_cast<unsigned char*>(this->memory);
+	Ring requests = {reinterpret_cast<Control*>(base), base + sizeof(Control)};
+	base += sizeof(Control) + this->capacity;
+	Ring replies = {reinterpret_cast<Control*>(base), base + sizeof(Control)};
+
+	this->out = this->client ? requests : replies;
+	this->in = this->client ? replies : requests;
+}
+
+void SharedChannel::write(const ::iovec* vector, std::size_t count)
+{
+	std::size_t total = 0;
+	for (std::size_t i = 0; i < count; i++)
+		total += vector[i].iov_len;
+
+	auto control = this->out.control;
+	auto timeout = std::chrono::milliseconds(this->writeTimeout);
+	auto deadline = std::chrono::steady_clock::now() + timeout;
+
+	std::size_t written = 0;
+	while (true) {
+		auto copied = this->put(vector, count, written);
+		written += copied;
+		if (written == total)
+			break;
+
+		// The alive but stuck reader is given up after the timeout.
+		auto now = std::chrono::steady_clock::now();
+		if (copied > 0)
+			deadline = now + timeout;
+		else if (now >= deadline)
+			throw std::runtime_error("Shared channel is not read by peer.");
+
+		control->writerWaiting = ON_FUTEX;
+		if (this->isFull())
+			futex_wait(control->writerWaiting, ON_FUTEX);
+		control->writerWaiting = AWAKE;
+
+		if (this->isFull())
+			this->check();
+	}
+}
+
+std::size_t SharedChannel::writeSome(const ::iovec* vector, std::size_t count)
+{
+	std::size_t total = 0;
+	for (std::size_t i = 0; i < count; i++)
+		total += vector[i].iov_len;
+
+	// The reader may make room while writing.
+	std::size_t written = 0;
+	while (written < total && this->writable())
+		written += this->put(vector, count, written);
+
+	return written;
+}
+
+bool SharedChannel::writable(void)
+{
+	this->armed = false;
+	if (!this->isFull())
+		return true;
+
+	// Notified by eventfd once the reader makes room. (see read)
+	auto control = this->out.control;
+	control->writerWaiting = ON_EVENTFD;
+	if (this->isFull()) {
+		this->armed = true;
+		return false;
+	}
+
+	control->writerWaiting = AWAKE;
+	return true;
+}
+
+std::size_t SharedChannel::put(const ::iovec* vector, std::size_t count, std::size_t skip)
+{
+	auto control = this->out.control;
+	auto head = control->head.load(std::memory_order_relaxed);
+	auto used = head - control->tail.load(std::memory_order_acquire);
+	if (used > this->capacity)
+		throw std::runtime_error("Shared channel is corrupted.");
+
+	auto room = this->capacity - used;
+	std::size_t copied = 0;
+	for (std::size_t i = 0; i < count && room > 0; i++) {
+		if (skip >= vector[i].iov_len) {
+			skip -= vector[i].iov_len;
+			continue;
+		}
+
+		auto source = reinterpret_cast<const unsigned char*>(vector[i].iov_base) + skip;
+		auto left = vector[i].iov_len - skip;
+		skip = 0;
+
+		while (left > 0 && room > 0) {
+			auto offset = static_cast<std::size_t>(head & (this->capacity - 1));
+			auto length = std::min({left, room, this->capacity - offset});
+			std::memcpy(this->out.data + offset, source, length);
+
+			head += length;
+			source += length;
+			left -= length;
+			room -= length;
+			copied += length;
+		}
+	}
+
+	if (copied > 0)
+		this->publish(head);
+
+	return copied;
+}
+
+void SharedChannel::publish(std::uint64_t head)
+{
+	auto control = this->out.control;
+	control->head.store(head);
+
+	switch (control->readerWaiting.exchange(AWAKE)) {
+	case ON_FUTEX:
+		futex_wake(control->readerWaiting);
+		break;
+	case ON_EVENTFD:
+		this->notify();
+		break;
+	default:
+		break;
+	}
+}
+
+void SharedChannel::notify(void)
+{
+	std::uint64_t one = 1;
+	while (::write(this->notifyFd, &one, sizeof(one)) == -1 && errno == EINTR);
+}
+
+bool SharedChannel::isFull(void) const
+{
+	auto control = this->out.control;
+	auto used = control->head.load(std::memory_order_relaxed) - control->tail.load();
+	if (used > this->capacity)
+		throw std::runtime_error("Shared channel is corrupted.");
+
+	return used == this->capacity;
+}
+
+std::size_t SharedChannel::read(Decoder& decoder)
+{
+	auto control = this->in.control;
+	auto tail = control->tail.load(std::memory_order_relaxed);
+	auto head = control->head.load(std::memory_order_acquire);
+
+	auto size = head - tail;
+	if (size == 0)
+		return 0;
+
+	if (size > this->capacity)
+		throw std::runtime_error("Shared channel is corrupted.");
+
+	auto offset = static_cast<std::size_t>(tail & (this->capacity - 1));
+	auto first = std::min<std::size_t>(size, this->capacity - offset);
+	decoder.feed(this->in.data + offset, first);
+	if (size > first)
+		decoder.feed(this->in.data, size - first);
+
+	control->tail.store(head);
+	switch (control->writerWaiting.exchange(AWAKE)) {
+	case ON_FUTEX:
+		futex_wake(control->writerWaiting);
+		break;
+	case ON_EVENTFD:
+		this->notify();
+		break;
+	default:
+		break;
+	}
+
+	return size;
+}
+
+void SharedChannel::wait(void)
+{
+	auto control = this->in.control;
+	auto tail = control->tail.load(std::memory_order_relaxed);
+
+	static const int spins = (std::thread::hardware_concurrency() > 1) ? SPIN_COUNT : 0;
+	for (int i = 0; i < spins; i++) {
+		if (control->head.load(std::memory_order_acquire) != tail)
+			return;
+
+		relax();
+	}
+
+	control->readerWaiting = ON_FUTEX;
+	if (control->head.load() == tail)
+		futex_wait(control->readerWaiting, ON_FUTEX);
+	control->readerWaiting = AWAKE;
+
+	// The bytes written before closing are still readable.
+	if (control->head.load() == tail)
+		this->check();
+}
+
+bool SharedChannel::sleep(void)
+{
+	// Consume the notification before arming, so the next one is not lost.
+	this->consume();
+
+	auto control = this->in.control;
+	control->readerWaiting = ON_EVENTFD;
+	if (control->head.load() == control->tail.load(std::memory_order_relaxed))
+		return true;
+
+	control->readerWaiting = AWAKE;
+	return false;
+}
+
+void SharedChannel::consume(void)
+{
+	std::uint64_t count;
+	while (::read(this->notifyFd, &count, sizeof(count)) == -1 && errno == EINTR);
+}
+
+void SharedChannel::remind(void)
+{
+	if (this->armed && this->out.control->writerWaiting != ON_EVENTFD) {
+		this->armed = false;
+		this->notify();
+	}
+}
+
+void SharedChannel::setWriteTimeout(std::chrono::milliseconds::rep timeout) noexcept
+{
+	this->writeTimeout = timeout;
+}
+
+void SharedChannel::check(void) const
+{
+	if (this->in.control->closed || this->out.control->closed)
+		throw std::runtime_error("Shared channel is closed by peer.");
+
+	// The crashed peer could not mark closed.
+	::pollfd target = {this->socketFd, POLLRDHUP, 0};
+	if (::poll(&target, 1, 0) > 0 && (target.revents & (POLLHUP | POLLRDHUP | POLLERR | POLLNVAL)))
+		throw std::runtime_error("Connection is closed by peer.");
+}
+
+int SharedChannel::getMemoryFd(void) const noexcept
+{
+	return this->memoryFd;
+}
+
+int SharedChannel::getNotifyFd(void) const noexcept
+{
+	return this->notifyFd;
+}
+
+std::size_t SharedChannel::getCapacity(void) const noexcept
+{
+	return this->capacity;
+}
+
+} // namespace transport
+} // namespace rmi
@@ -0,0 +1,137 @@
+/*
+ *  Copyright (c) 2018 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * @file        shared-channel.hxx
+ * @author      Sangwan Kwon (sangwan.kwon@samsung.com)
+ * @brief       Shared-memory transport for the processes on same host.
+ * @details     A sealed memfd holds a pair of SPSC byte rings, one for each
+ *              direction. The messages are written into a ring as they are
+ *              on socket, and decoded by Decoder on the other side.
+ *              The peer is notified only when it is sleeping: client waits
+ *              on futex, and server waits on eventfd with the mainloop.
+ *              Server does not wait for the room of replies either, and the
+ *              eventfd also tells it when client has made room.
+ *              The channel is set up over the Unix socket connection which
+ *              passes the descriptors and tells the hangup of peer.
+ */
+
+#pragma once
+
+#include "decoder.hxx"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include <sys/uio.h>
+
+namespace rmi {
+namespace transport {
+
+class SharedChannel final {
+public:
+	// Client: create the memory and the notification of requests.
+	explicit SharedChannel(std::size_t capacity, int socketFd);
+	// Server: map the ones received from client. (the descriptors are owned)
+	explicit SharedChannel(int memoryFd, int notifyFd, int socketFd);
+	~SharedChannel(void);
+
+	SharedChannel(const SharedChannel&) = delete;
+	SharedChannel& operator=(const SharedChannel&) = delete;
+
+	SharedChannel(SharedChannel&&) = delete;
+	SharedChannel& operator=(SharedChannel&&) = delete;
+
+	// Write all buffers in order, waiting for the space.
+	// Throw std::runtime_error if reader makes no room for the write timeout.
+	void write(const ::iovec* vector, std::size_t count);
+	// Server: write what fits without waiting, and return the size of them.
+	// If some are left, the room made by reader is notified by eventfd.
+	std::size_t writeSome(const ::iovec* vector, std::size_t count);
+	// Server: true if some bytes can be written now, or arm the notification.
+	bool writable(void);
+	// Decode the available bytes and return the size of them.
+	std::size_t read(Decoder& decoder);
+
+	// Client: wait until some bytes are readable.
+	void wait(void);
+	// Server: arm the notification before sleeping on mainloop.
+	// Return false if some bytes arrived meanwhile. (read again)
+	bool sleep(void);
+	// Server: consume the notification without reading. (while paused)
+	void consume(void);
+	// Server: notify again if reader has made room for the armed writer,
+	// since consuming the notification of bytes consumed it too.
+	// (under the lock of writing)
+	void remind(void);
+
+	void setWriteTimeout(std::chrono::milliseconds::rep timeout) noexcept;
+
+	int getMemoryFd(void) const noexcept;
+	int getNotifyFd(void) const noexcept;
+	std::size_t getCapacity(void) const noexcept;
+
+	// The capacity of each ring. (power of 2)
+	static constexpr std::size_t CAPACITY = 1024 * 1024;
+	static constexpr std::size_t MAX_CAPACITY = 64 * 1024 * 1024;
+	static constexpr std::chrono::milliseconds::rep WRITE_TIMEOUT = 10 * 1000;
+
+private:
+	// Placed at the front of each ring in the shared memory.
+	struct Control {
+		// The total written bytes, updated by writer.
+		alignas(64) std::atomic<std::uint64_t> head;
+		// The total consumed bytes, updated by reader.
+		alignas(64) std::atomic<std::uint64_t> tail;
+		// The futex words. (not 0 if sleeping)
+		alignas(64) std::atomic<std::uint32_t> readerWaiting;
+		std::atomic<std::uint32_t> writerWaiting;
+		std::atomic<std::uint32_t> closed;
+	};
+
+	struct Ring {
+		Control* control;
+		unsigned char* data;
+	};
+
+	void map(void);
+	// Copy the bytes after skip as many as fit, and publish them.
+	std::size_t put(const ::iovec* vector, std::size_t count, std::size_t skip);
+	void publish(std::uint64_t head);
+	void notify(void);
+	bool isFull(void) const;
+	// Throw if the peer is closed while waiting.
+	void check(void) const;
+
+	bool client;
+	int memoryFd;
+	int notifyFd;
+	int socketFd;
+
+	void* memory = nullptr;
+	std::size_t capacity;
+
+	std::chrono::milliseconds::rep writeTimeout = WRITE_TIMEOUT;
+	// The writer waits for the notification of room. (server)
+	bool armed = false;
+
+	Ring in;
+	Ring out;
+};
+
+} // namespace transport
+} // namespace rmi
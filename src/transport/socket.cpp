@@ -17,15 +17,22 @@
  * @file        socket.cpp
  * @author      Jaemin Ryu (jm77.ryu@samsung.com)
  *              Sangwan Kwon (sangwan.kwon@samsung.com)
- * @brief       Implementation of Unix Domain Socket.
+ * @brief       Implementation of stream socket.
  */
 
 #include "socket.hxx"
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
+#include <climits>
+#include <cstring>
 #include <fcntl.h>
 
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <sys/un.h>
 #include <sys/stat.h>
 #include <sys/socket.h>
@@ -41,49 +48,238 @@ void set_cloexec(int fd)
 		throw std::runtime_error("Failed to set CLOSEXEC.");
 }
 
-} // anonymous namespace
+// The closed peer should not raise SIGPIPE on the reactor.
+::ssize_t send_message(int fd, const ::iovec* vector, std::size_t count,
+					   const int* fds, std::size_t fdCount)
+{
+	if (fdCount > Socket::MAX_DESCRIPTORS)
+		throw std::invalid_argument("Too many descriptors to send.");
+
+	::msghdr message;
+	std::memset(&message, 0, sizeof(message));
+	message.msg_iov = const_cast<::iovec*>(vector);
+	message.msg_iovlen = std::min<std::size_t>(count, IOV_MAX);
+
+	alignas(::cmsghdr) unsigned char control[CMSG_SPACE(sizeof(int) * Socket::MAX_DESCRIPTORS)];
+	if (fdCount > 0) {
+		message.msg_control = control;
+		message.msg_controllen = CMSG_SPACE(sizeof(int) * fdCount);
+
+		auto header = CMSG_FIRSTHDR(&message);
+		header->cmsg_level = SOL_SOCKET;
+		header->cmsg_type = SCM_RIGHTS;
+		header->cmsg_len = CMSG_LEN(sizeof(int) * fdCount);
+		std::memcpy(CMSG_DATA(header), fds, sizeof(int) * fdCount);
+	}
 
-Socket::Socket(int fd) noexcept : fd(fd)
+	return ::sendmsg(fd, &message, MSG_NOSIGNAL);
+}
+
+::ssize_t recv_message(int fd, void* buffer, std::size_t size, std::vector<int>& fds)
 {
+	::iovec vector = {buffer, size};
+	::msghdr message;
+	std::memset(&message, 0, sizeof(message));
+	message.msg_iov = &vector;
+	message.msg_iovlen = 1;
+
+	alignas(::cmsghdr) unsigned char control[CMSG_SPACE(sizeof(int) * Socket::MAX_DESCRIPTORS)];
+	message.msg_control = control;
+	message.msg_controllen = sizeof(control);
+
+	auto bytes = ::recvmsg(fd, &message, MSG_CMSG_CLOEXEC);
+	if (bytes <= 0)
+		return bytes;
+
+	for (auto header = CMSG_FIRSTHDR(&message); header != nullptr;
+		 header = CMSG_NXTHDR(&message, header)) {
+		if (header->cmsg_level != SOL_SOCKET || header->cmsg_type != SCM_RIGHTS)
+			continue;
+
+		auto count = (header->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+		auto begin = fds.size();
+		fds.resize(begin + count);
+		std::memcpy(fds.data() + begin, CMSG_DATA(header), sizeof(int) * count);
+	}
+
+	// The descriptors over the limit are closed by kernel.
+	if (message.msg_flags & MSG_CTRUNC)
+		throw std::runtime_error("Too many descriptors are received.");
+
+	return bytes;
 }
 
-Socket::Socket(const std::string& path)
+struct Address {
+	int family;
+	// Unix domain
+	std::string path;
+	// TCP
+	std::string host;
+	std::string port;
+};
+
+const std::string UNIX_SCHEME = "unix:";
+const std::string TCP_SCHEME = "tcp:";
+
+Address parse_address(const std::string& address)
 {
-	if (path.size() >= sizeof(::sockaddr_un::sun_path))
-		throw std::invalid_argument("Socket path size is wrong.");
+	if (address.compare(0, TCP_SCHEME.size(), TCP_SCHEME) != 0) {
+		// The path without scheme is also Unix domain.
+		std::string path = address;
+		if (address.compare(0, UNIX_SCHEME.size(), UNIX_SCHEME) == 0)
+			path = address.substr(UNIX_SCHEME.size());
 
-	int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
-	if (fd == -1)
-		throw std::runtime_error("Failed to create socket.");
+		if (path.empty() || path.size() >= sizeof(::sockaddr_un::sun_path))
+			throw std::invalid_argument("Socket path size is wrong.");
 
-	set_cloexec(fd);
+		return {AF_UNIX, path, "", ""};
+	}
+
+	std::string rest = address.substr(TCP_SCHEME.size());
+	auto colon = rest.rfind(':');
+	if (colon == std::string::npos || colon + 1 == rest.size())
+		throw std::invalid_argument("TCP address should have port.");
 
+	std::string host = rest.substr(0, colon);
+	if (host.size() >= 2 && host.front() == '[' && host.back() == ']')
+		host = host.substr(1, host.size() - 2);
+	else if (host.find(':') != std::string::npos)
+		throw std::invalid_argument("IPv6 address should be in brackets.");
+
+	return {AF_INET, "", host, rest.substr(colon + 1)};
+}
+
+::sockaddr_un unix_address(const std::string& path)
+{
 	::sockaddr_un addr;
+	std::memset(&addr, 0, sizeof(addr));
 	addr.sun_family = AF_UNIX;
-	::strncpy(addr.sun_path, path.c_str(), sizeof(sockaddr_un::sun_path));
+	::strncpy(addr.sun_path, path.c_str(), sizeof(::sockaddr_un::sun_path) - 1);
 
 	if (addr.sun_path[0] == '@')
 		addr.sun_path[0] = '\0';
 
-	struct stat buf;
-	if (::stat(path.c_str(), &buf) == 0)
-		if (::unlink(path.c_str()) == -1)
-			throw std::runtime_error("Failed to remove exist socket.");
+	return addr;
+}
+
+int open_unix(void)
+{
+	int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd == -1)
+		throw std::runtime_error("Failed to create socket.");
+
+	set_cloexec(fd);
+
+	return fd;
+}
+
+// Bind or connect to the first usable one of resolved addresses.
+int open_tcp(const Address& target, bool listening)
+{
+	::addrinfo hints;
+	std::memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	hints.ai_flags = AI_NUMERICSERV | (listening ? AI_PASSIVE : 0);
+
+	::addrinfo* results = nullptr;
+	const char* host = target.host.empty() ? nullptr : target.host.c_str();
+	if (::getaddrinfo(host, target.port.c_str(), &hints, &results) != 0)
+		throw std::invalid_argument("Failed to resolve address: " + target.host);
+
+	int fd = -1;
+	for (auto result = results; result != nullptr; result = result->ai_next) {
+		fd = ::socket(result->ai_family, result->ai_socktype | SOCK_CLOEXEC,
+					  result->ai_protocol);
+		if (fd == -1)
+			continue;
+
+		if (listening) {
+			// Restart on the port of which connections are in TIME_WAIT.
+			int enabled = 1;
+			::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &enabled, sizeof(enabled));
+			if (::bind(fd, result->ai_addr, result->ai_addrlen) == 0)
+				break;
+		} else if (::connect(fd, result->ai_addr, result->ai_addrlen) == 0) {
+			break;
+		}
 
-	if (::bind(fd, reinterpret_cast<::sockaddr*>(&addr), sizeof(::sockaddr_un)) == -1) {
 		::close(fd);
-		throw std::runtime_error("Failed to bind.");
+		fd = -1;
 	}
 
-	if (::listen(fd, MAX_BACKLOG_SIZE) == -1) {
-		::close(fd);
-		throw std::runtime_error("Failed to liten.");
+	::freeaddrinfo(results);
+
+	if (fd == -1)
+		throw std::runtime_error(listening ? "Failed to bind." : "Failed to connect.");
+
+	return fd;
+}
+
+void set_option(int fd, int level, int name, int value)
+{
+	if (::setsockopt(fd, level, name, &value, sizeof(value)) == -1)
+		throw std::runtime_error("Failed to set socket option.");
+}
+
+void set_options(int fd, const Socket::Options& options, bool tcp)
+{
+	if (options.sendBufferSize > 0)
+		set_option(fd, SOL_SOCKET, SO_SNDBUF, options.sendBufferSize);
+	if (options.recvBufferSize > 0)
+		set_option(fd, SOL_SOCKET, SO_RCVBUF, options.recvBufferSize);
+
+	if (!tcp)
+		return;
+
+	set_option(fd, IPPROTO_TCP, TCP_NODELAY, options.noDelay);
+	set_option(fd, SOL_SOCKET, SO_KEEPALIVE, options.keepAlive);
+	if (options.keepAlive) {
+		set_option(fd, IPPROTO_TCP, TCP_KEEPIDLE, options.keepAliveIdle);
+		set_option(fd, IPPROTO_TCP, TCP_KEEPINTVL, options.keepAliveInterval);
+		set_option(fd, IPPROTO_TCP, TCP_KEEPCNT, options.keepAliveCount);
+	}
+}
+
+} // anonymous namespace
+
+constexpr std::size_t Socket::MAX_DESCRIPTORS;
+
+Socket::Socket(int fd) noexcept : fd(fd)
+{
+}
+
+Socket::Socket(const std::string& address, const Options& options) : options(options)
+{
+	auto target = parse_address(address);
+	if (target.family == AF_UNIX) {
+		int fd = open_unix();
+
+		struct stat buf;
+		if (target.path[0] != '@' && ::stat(target.path.c_str(), &buf) == 0)
+			if (::unlink(target.path.c_str()) == -1) {
+				::close(fd);
+				throw std::runtime_error("Failed to remove exist socket.");
+			}
+
+		auto addr = unix_address(target.path);
+		if (::bind(fd, reinterpret_cast<::sockaddr*>(&addr), sizeof(::sockaddr_un)) == -1) {
+			::close(fd);
+			throw std::runtime_error("Failed to bind.");
+		}
+
+		this->fd = fd;
+	} else {
+		this->fd = open_tcp(target, true);
 	}
 
-	this->fd = fd;
+	if (::listen(this->fd, MAX_BACKLOG_SIZE) == -1) {
+		::close(this->fd);
+		throw std::runtime_error("Failed to liten.");
+	}
 }
 
-Socket::Socket(Socket&& that) : fd(that.fd)
+Socket::Socket(Socket&& that) : fd(that.fd), options(that.options)
 {
 	that.fd = -1;
 }
@@ -94,6 +290,7 @@ Socket& Socket::operator=(Socket&& that)
 		return *this;
 
 	this->fd = that.fd;
+	this->options = that.options;
 	that.fd = -1;
 
 	return *this;
@@ -113,33 +310,142 @@ Socket Socket::accept(void) const
 
 	set_cloexec(fd);
 
-	return Socket(fd);
+	return this->adopt(fd);
 }
 
-Socket Socket::connect(const std::string& path)
+Socket Socket::adopt(int fd) const
 {
-	if (path.size() >= sizeof(::sockaddr_un::sun_path))
-		throw std::invalid_argument("Socket path size is wrong.");
+	Socket accepted(fd);
+	set_options(fd, this->options, !accepted.isLocal());
 
-	int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
-	if (fd == -1)
-		throw std::runtime_error("Failed to create socket.");
-
-	set_cloexec(fd);
+	return accepted;
+}
 
-	::sockaddr_un addr;
-	addr.sun_family = AF_UNIX;
-	::strncpy(addr.sun_path, path.c_str(), sizeof(::sockaddr_un::sun_path));
+Socket Socket::connect(const std::string& address, const Options& options)
+{
+	auto target = parse_address(address);
+	if (target.family != AF_UNIX) {
+		Socket connected(open_tcp(target, false));
+		set_options(connected.fd, options, true);
+		return connected;
+	}
 
-	if (addr.sun_path[0] == '@')
-		addr.sun_path[0] = '\0';
+	Socket connected(open_unix());
+	set_options(connected.fd, options, false);
 
-	if (::connect(fd, reinterpret_cast<::sockaddr*>(&addr), sizeof(sockaddr_un)) == -1) {
-		::close(fd);
+	auto addr = unix_address(target.path);
+	if (::connect(connected.fd, reinterpret_cast<::sockaddr*>(&addr), sizeof(sockaddr_un)) == -1)
 		throw std::runtime_error("Failed to connect.");
+
+	return connected;
+}
+
+void Socket::sendv(::iovec* vector, std::size_t count, const int* fds, std::size_t fdCount) const
+{
+	while (count > 0) {
+		// The client is not killed by SIGPIPE either when server is gone.
+		auto bytes = send_message(this->fd, vector, count, fds, fdCount);
+		if (bytes == -1) {
+			if (errno == EAGAIN || errno == EWOULDBLOCK)
+				this->wait(POLLOUT);
+			else if (errno != EINTR)
+				throw std::runtime_error("Failed to write.");
+
+			continue;
+		}
+
+		// The descriptors went with the first byte.
+		fdCount = 0;
+
+		// Skip the written buffers and adjust the partially written one.
+		std::size_t written = static_cast<std::size_t>(bytes);
+		while (count > 0 && written >= vector->iov_len) {
+			written -= vector->iov_len;
+			vector++;
+			count--;
+		}
+
+		if (count > 0) {
+			vector->iov_base = reinterpret_cast<unsigned char*>(vector->iov_base) + written;
+			vector->iov_len -= written;
+		}
 	}
+}
+
+void Socket::setNonBlocking(bool enabled)
+{
+	int flags = ::fcntl(this->fd, F_GETFL);
+	if (flags == -1)
+		throw std::runtime_error("Failed to get file status flags.");
+
+	flags = enabled ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK);
+	if (::fcntl(this->fd, F_SETFL, flags) == -1)
+		throw std::runtime_error("Failed to set O_NONBLOCK.");
+}
 
-	return Socket(fd);
+bool Socket::isNonBlocking(void) const
+{
+	int flags = ::fcntl(this->fd, F_GETFL);
+	if (flags == -1)
+		throw std::runtime_error("Failed to get file status flags.");
+
+	return flags & O_NONBLOCK;
+}
+
+std::size_t Socket::recvSome(void* buffer, std::size_t size, std::vector<int>* fds) const
+{
+	while (true) {
+		auto bytes = (fds == nullptr) ? ::read(this->fd, buffer, size)
+									  : recv_message(this->fd, buffer, size, *fds);
+		if (bytes > 0)
+			return static_cast<std::size_t>(bytes);
+
+		if (bytes == 0 && size > 0)
+			throw std::runtime_error("Connection is closed by peer.");
+
+		if (bytes == 0 || errno == EAGAIN || errno == EWOULDBLOCK)
+			return 0;
+
+		if (errno != EINTR)
+			throw std::runtime_error("Failed to read.");
+	}
+}
+
+std::size_t Socket::sendSome(const ::iovec* vector, std::size_t count,
+							 const int* fds, std::size_t fdCount) const
+{
+	while (true) {
+		auto bytes = send_message(this->fd, vector, count, fds, fdCount);
+		if (bytes >= 0)
+			return static_cast<std::size_t>(bytes);
+
+		if (errno == EAGAIN || errno == EWOULDBLOCK)
+			return 0;
+
+		if (errno != EINTR)
+			throw std::runtime_error("Failed to write.");
+	}
+}
+
+void Socket::wait(short events) const
+{
+	::pollfd target = {this->fd, events, 0};
+	while (::poll(&target, 1, -1) == -1) {
+		if (errno != EINTR)
+			throw std::runtime_error("Failed to poll.");
+	}
+}
+
+bool Socket::isAlive(void) const
+{
+	::pollfd target = {this->fd, POLLRDHUP, 0};
+	int ready;
+	while ((ready = ::poll(&target, 1, 0)) == -1) {
+		if (errno != EINTR)
+			throw std::runtime_error("Failed to poll.");
+	}
+
+	return ready == 0 || !(target.revents & (POLLRDHUP | POLLHUP | POLLERR | POLLNVAL));
 }
 
 int Socket::getFd(void) const noexcept
@@ -147,5 +453,48 @@ int Socket::getFd(void) const noexcept
 	return this->fd;
 }
 
+std::string Socket::getAddress(void) const
+{
+	::sockaddr_storage addr;
+	::socklen_t size = sizeof(addr);
+	if (::getsockname(this->fd, reinterpret_cast<::sockaddr*>(&addr), &size) == -1)
+		throw std::runtime_error("Failed to get socket name.");
+
+	char host[INET6_ADDRSTRLEN];
+	switch (addr.ss_family) {
+	case AF_INET: {
+		auto inet = reinterpret_cast<::sockaddr_in*>(&addr);
+		::inet_ntop(AF_INET, &inet->sin_addr, host, sizeof(host));
+		return std::string("tcp:") + host + ":" + std::to_string(ntohs(inet->sin_port));
+	}
+	case AF_INET6: {
+		auto inet = reinterpret_cast<::sockaddr_in6*>(&addr);
+		::inet_ntop(AF_INET6, &inet->sin6_addr, host, sizeof(host));
+		return std::string("tcp:[") + host + "]:" + std::to_string(ntohs(inet->sin6_port));
+	}
+	default: {
+		auto local = reinterpret_cast<::sockaddr_un*>(&addr);
+		std::size_t length = size - offsetof(::sockaddr_un, sun_path);
+		std::string path(local->sun_path, ::strnlen(local->sun_path, length));
+		// The abstract one starts with null, and is padded with null.
+		if (length > 0 && local->sun_path[0] == '\0') {
+			auto name = local->sun_path + 1;
+			path = "@" + std::string(name, ::strnlen(name, length - 1));
+		}
+		return "unix:" + path;
+	}
+	}
+}
+
+bool Socket::isLocal(void) const
+{
+	int family;
+	::socklen_t size = sizeof(family);
+	if (::getsockopt(this->fd, SOL_SOCKET, SO_DOMAIN, &family, &size) == -1)
+		throw std::runtime_error("Failed to get socket domain.");
+
+	return family == AF_UNIX;
+}
+
 } // namespace transport
 } // namespace rmi
@@ -17,7 +17,11 @@
  * @file        socket.hxx
  * @author      Jaemin Ryu (jm77.ryu@samsung.com)
  *              Sangwan Kwon (sangwan.kwon@samsung.com)
- * @brief       Define Unix Domain Socket.
+ * @brief       Define stream socket of Unix domain or TCP.
+ * @details     The address selects the transport by scheme.
+ *              - unix:<path> (or just <path>, '@' prefix for abstract one)
+ *              - tcp:<host>:<port> (IPv4, or IPv6 in brackets as tcp:[::1]:<port>)
+ *              The descriptors can be passed only through Unix socket.
  */
 
 #pragma once
@@ -25,17 +29,38 @@
 #include <cstddef>
 #include <string>
 #include <stdexcept>
+#include <vector>
 
 #include <unistd.h>
 #include <errno.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
 
 namespace rmi {
 namespace transport {
 
+struct SocketOptions {
+	// Send the small messages without waiting for ACK. (TCP_NODELAY)
+	bool noDelay = true;
+	// Probe the idle peer after keepAliveIdle seconds, every
+	// keepAliveInterval seconds for keepAliveCount times. (TCP)
+	bool keepAlive = true;
+	int keepAliveIdle = 60;
+	int keepAliveInterval = 10;
+	int keepAliveCount = 6;
+	// SO_SNDBUF and SO_RCVBUF. (0: system default)
+	int sendBufferSize = 0;
+	int recvBufferSize = 0;
+};
+
 class Socket {
 public:
+	using Options = SocketOptions;
+
 	explicit Socket(int fd) noexcept;
-	explicit Socket(const std::string& path);
+	// Listen on the address. The accepted sockets take the options.
+	explicit Socket(const std::string& address, const Options& options = Options());
 	virtual ~Socket(void);
 
 	Socket(const Socket&) = delete;
@@ -45,7 +70,9 @@ public:
 	Socket& operator=(Socket&&);
 
 	Socket accept(void) const;
-	static Socket connect(const std::string& path);
+	// Take the fd accepted by others on this socket. (e.g. io_uring)
+	Socket adopt(int fd) const;
+	static Socket connect(const std::string& address, const Options& options = Options());
 
 	template<typename T>
 	void send(const T* buffer, const std::size_t size = sizeof(T)) const;
@@ -53,12 +80,43 @@ public:
 	template<typename T>
 	void recv(T* buffer, const std::size_t size = sizeof(T)) const;
 
+	// Send the scattered buffers at once. (writev)
+	// The descriptors are sent with the first byte if given. (SCM_RIGHTS)
+	void sendv(::iovec* vector, std::size_t count,
+			   const int* fds = nullptr, std::size_t fdCount = 0) const;
+
+	// The calls above wait for the non-blocking socket to be ready,
+	// and the calls below transfer only what is possible without waiting.
+	void setNonBlocking(bool enabled);
+	bool isNonBlocking(void) const;
+
+	// Return the transferred bytes, or 0 if it would block.
+	// (recvSome() throws std::runtime_error when the peer is closed.)
+	// The received descriptors are appended to fds if it is given.
+	std::size_t recvSome(void* buffer, std::size_t size, std::vector<int>* fds = nullptr) const;
+	std::size_t sendSome(const ::iovec* vector, std::size_t count,
+						 const int* fds = nullptr, std::size_t fdCount = 0) const;
+
+	// Wait until the socket is ready for the events. (poll)
+	void wait(short events) const;
+	// False if the peer has closed or the socket has failed. (poll without waiting)
+	// Nothing is read or written, so it does not disturb the stream.
+	bool isAlive(void) const;
+
 	int getFd(void) const noexcept;
+	// The bound address in the scheme form. (e.g. the port chosen for 0)
+	std::string getAddress(void) const;
+	// Unix domain socket, which can pass descriptors.
+	bool isLocal(void) const;
+
+	static constexpr std::size_t MAX_DESCRIPTORS = 64;
 
 private:
-	const int MAX_BACKLOG_SIZE = 100;
+
+	const int MAX_BACKLOG_SIZE = SOMAXCONN;
 
 	int fd;
+	Options options;
 };
 
 template<typename T>
@@ -70,10 +128,10 @@ void Socket::send(const T *buffer, const std::size_t size) const
 		auto bytes = ::write(this->fd, rest, size - written);
 		if (bytes >= 0)
 			written += bytes;
-		else if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
-			continue;
-		else
-			std::runtime_error("Failed to write.");
+		else if (errno == EAGAIN || errno == EWOULDBLOCK)
+			this->wait(POLLOUT);
+		else if (errno != EINTR)
+			throw std::runtime_error("Failed to write.");
 	}
 }
 
@@ -84,12 +142,14 @@ void Socket::recv(T *buffer, const std::size_t size) const
 	while (readen < size) {
 		auto rest = reinterpret_cast<unsigned char*>(buffer) + readen;
 		auto bytes = ::read(this->fd, rest, size - readen);
-		if (bytes >= 0)
+		if (bytes > 0)
 			readen += bytes;
-		else if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
-			continue;
-		else
-			std::runtime_error("Failed to read.");
+		else if (bytes == 0)
+			throw std::runtime_error("Connection is closed by peer.");
+		else if (errno == EAGAIN || errno == EWOULDBLOCK)
+			this->wait(POLLIN);
+		else if (errno != EINTR)
+			throw std::runtime_error("Failed to read.");
 	}
 }
 
@@ -20,15 +20,24 @@
 
 #include "application/server.hxx"
 #include "application/client.hxx"
+#include "application/client-pool.hxx"
 
 #include <string>
 #include <thread>
 #include <memory>
 #include <iostream>
 #include <chrono>
+#include <cstring>
+#include <future>
+#include <atomic>
+#include <vector>
+
+#include <unistd.h>
 
 #include <gtest/gtest.h>
 
+#include "socket-path.hxx"
+
 using namespace rmi::application;
 using namespace rmi::transport;
 
@@ -48,9 +57,59 @@ struct Foo {
 	std::string name;
 };
 
+struct Store {
+	// Return the sum of bytes mapped from the client.
+	std::size_t put(const rmi::stream::SealedBlob& blob)
+	{
+		std::size_t sum = 0;
+		for (auto byte : blob.view())
+			sum += byte;
+		return sum;
+	}
+
+	rmi::stream::SealedBlob get(std::size_t size)
+	{
+		rmi::stream::SealedBlob blob(size);
+		std::memset(blob.writable(), 'g', size);
+		blob.seal();
+		return blob;
+	}
+};
+
+struct Sequence {
+	int append(int value)
+	{
+		this->values.push_back(value);
+		return value;
+	}
+
+	std::vector<int> values;
+};
+
+struct Sleeper {
+	int sleep(int ms)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+		return ms;
+	}
+
+	int peek(int ms) const
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+		return ms;
+	}
+};
+
+struct Faulty {
+	int fail(int value)
+	{
+		throw std::runtime_error("Faulty " + std::to_string(value));
+	}
+};
+
 TEST(APPLICATION, SERVER_CLIENT)
 {
-	std::string sockPath = ("./server");
+	SocketPath sockPath("server");
 
 	// server-side
 	Server server;
@@ -81,3 +140,1015 @@ TEST(APPLICATION, SERVER_CLIENT)
 	if (client.joinable())
 		client.join();
 }
+
+TEST(APPLICATION, SERVER_CLIENT_COMPACT)
+{
+	SocketPath sockPath("server-compact");
+
+	// server-side
+	Server server;
+	server.listen(sockPath);
+
+	auto foo = std::make_shared<Foo>();
+	server.expose(foo, "Foo::setName", &Foo::setName);
+	server.expose(foo, "Foo::getName", &Foo::getName);
+
+	auto client = std::thread([&]() {
+		std::this_thread::sleep_for(std::chrono::seconds(1));
+
+		// client-side
+		Client client(sockPath, Message::Flag::Compact);
+
+		std::string param = "RMI-TEST-COMPACT";
+		bool ret = client.invoke<bool>("Foo::setName", param);
+		EXPECT_EQ(ret, false);
+
+		std::string name = client.invoke<std::string>("Foo::getName");
+		EXPECT_EQ(name, param);
+
+		server.stop();
+	});
+
+	server.start();
+
+	if (client.joinable())
+		client.join();
+}
+
+TEST(APPLICATION, SERVER_SLOW_CLIENTS)
+{
+	SocketPath sockPath("server-slow");
+
+	// server-side
+	Server server;
+	server.listen(sockPath);
+
+	auto foo = std::make_shared<Foo>();
+	server.expose(foo, "Foo::setName", &Foo::setName);
+	server.expose(foo, "Foo::getName", &Foo::getName);
+
+	auto client = std::thread([&]() {
+		std::this_thread::sleep_for(std::chrono::seconds(1));
+
+		// The client which stops in the middle of header.
+		Socket partial = Socket::connect(sockPath);
+		Message::Header header;
+		partial.send(&header, sizeof(header) / 2);
+
+		// The client which does not read the large replies.
+		Client lazy(sockPath);
+		std::string large(4 * 1024 * 1024, 'l');
+		lazy.invoke<bool>("Foo::setName", large);
+		Message request(Message::Type::MethodCall, "Foo::getName");
+		Connection stalled(sockPath);
+		for (int i = 0; i < 4; i++)
+			stalled.send(request);
+
+		// The others are still served.
+		for (int i = 0; i < 10; i++) {
+			Client client(sockPath);
+			EXPECT_EQ(client.invoke<std::string>("Foo::getName"), large);
+		}
+
+		server.stop();
+	});
+
+	server.start();
+
+	if (client.joinable())
+		client.join();
+}
+
+TEST(APPLICATION, SERVER_BACKPRESSURE)
+{
+	for (auto backend : {Mainloop::Backend::Epoll, Mainloop::Backend::IoUring}) {
+		SocketPath sockPath("server-backpressure");
+
+		// server-side
+		Server server(backend);
+		server.listen(sockPath);
+		server.setWatermarks(256 * 1024, 64 * 1024);
+
+		auto foo = std::make_shared<Foo>();
+		foo->name = std::string(256 * 1024, 'b');
+		server.expose(foo, "Foo::getName", &Foo::getName);
+
+		auto client = std::thread([&]() {
+			std::this_thread::sleep_for(std::chrono::seconds(1));
+
+			// The requests are sent while the replies are not read.
+			const int count = 64;
+			Connection lazy(sockPath);
+			auto sender = std::thread([&]() {
+				Message request(Message::Type::MethodCall, "Foo::getName");
+				for (int i = 0; i < count; i++)
+					lazy.send(request);
+			});
+
+			std::this_thread::sleep_for(std::chrono::milliseconds(500));
+			EXPECT_EQ(server.getBackpressure().paused, 1);
+			EXPECT_EQ(server.getBackpressure().resumed, 0);
+
+			for (int i = 0; i < count; i++) {
+				std::string name;
+				lazy.recv().disclose(name);
+				EXPECT_EQ(name, foo->name);
+			}
+			sender.join();
+
+			auto backpressure = server.getBackpressure();
+			EXPECT_GE(backpressure.paused, 1);
+			EXPECT_GE(backpressure.peakBytes, 256 * 1024);
+			EXPECT_EQ(backpressure.resumed, backpressure.paused);
+
+			server.stop();
+		});
+
+		server.start();
+
+		if (client.joinable())
+			client.join();
+	}
+}
+
+TEST(APPLICATION, SERVER_BACKPRESSURE_WORKERS)
+{
+	for (auto backend : {Mainloop::Backend::Epoll, Mainloop::Backend::IoUring}) {
+		SocketPath sockPath("server-backpressure-workers");
+
+		// server-side
+		Server server(backend);
+		server.listen(sockPath);
+		server.setWatermarks(256 * 1024, 64 * 1024);
+		server.setWorkers(2);
+
+		auto foo = std::make_shared<Foo>();
+		foo->name = std::string(256 * 1024, 'w');
+		server.expose(foo, "Foo::getName", &Foo::getName);
+
+		auto client = std::thread([&]() {
+			std::this_thread::sleep_for(std::chrono::seconds(1));
+
+			// The replies are sent by workers, and the congestion is cleared by
+			// them while the reactor has paused reading.
+			const int rounds = 8, count = 8;
+			Connection lazy(sockPath);
+			auto sender = std::thread([&]() {
+				Message request(Message::Type::MethodCall, "Foo::getName");
+				for (int i = 0; i < rounds; i++) {
+					for (int j = 0; j < count; j++)
+						lazy.send(request);
+					std::this_thread::sleep_for(std::chrono::milliseconds(50));
+				}
+			});
+
+			std::this_thread::sleep_for(std::chrono::milliseconds(500));
+			EXPECT_GE(server.getBackpressure().paused, 1);
+
+			for (int i = 0; i < rounds * count; i++) {
+				std::string name;
+				lazy.recv().disclose(name);
+				EXPECT_EQ(name, foo->name);
+			}
+			sender.join();
+
+			// Resumed by the reactor after the last reply is flushed.
+			for (int i = 0; i < 100; i++) {
+				auto backpressure = server.getBackpressure();
+				if (backpressure.resumed == backpressure.paused)
+					break;
+				std::this_thread::sleep_for(std::chrono::milliseconds(10));
+			}
+
+			auto backpressure = server.getBackpressure();
+			EXPECT_GE(backpressure.peakBytes, 256 * 1024);
+			EXPECT_EQ(backpressure.resumed, backpressure.paused);
+
+			server.stop();
+		});
+
+		server.start();
+
+		if (client.joinable())
+			client.join();
+	}
+}
+
+TEST(APPLICATION, SERVER_REACTORS)
+{
+	for (auto backend : {Mainloop::Backend::Epoll, Mainloop::Backend::IoUring}) {
+		SocketPath sockPath("server-reactors");
+
+		// server-side
+		Server server(backend);
+		server.listen(sockPath);
+		server.setReactors(4);
+		EXPECT_EQ(server.getReactorLoads(), std::vector<std::size_t>(4, 0));
+
+		auto foo = std::make_shared<Foo>();
+		server.expose(foo, "Foo::setName", &Foo::setName);
+		server.expose(foo, "Foo::getName", &Foo::getName);
+
+		auto client = std::thread([&]() {
+			std::this_thread::sleep_for(std::chrono::seconds(1));
+
+			Client setter(sockPath);
+			setter.invoke<bool>("Foo::setName", std::string("reactors"));
+
+			// Served on several threads at once.
+			std::vector<std::thread> callers;
+			for (int i = 0; i < 8; i++) {
+				callers.emplace_back([&]() {
+					Client client(sockPath, Message::Flag::Compact);
+					for (int j = 0; j < 100; j++)
+						EXPECT_EQ(client.invoke<std::string>("Foo::getName"), "reactors");
+				});
+			}
+
+			for (auto& caller : callers)
+				caller.join();
+
+			server.stop();
+		});
+
+		server.start();
+
+		if (client.joinable())
+			client.join();
+	}
+}
+
+TEST(APPLICATION, SERVER_REACTORS_BALANCE)
+{
+	using Loads = std::vector<std::size_t>;
+	for (auto balance : {Server::Balance::RoundRobin, Server::Balance::LeastLoaded}) {
+		SocketPath sockPath("server-balance");
+
+		// server-side
+		Server server;
+		server.listen(sockPath);
+		server.setReactors(4, balance);
+
+		auto foo = std::make_shared<Foo>();
+		server.expose(foo, "Foo::getName", &Foo::getName);
+
+		auto client = std::thread([&]() {
+			std::this_thread::sleep_for(std::chrono::seconds(1));
+
+			// Accepted one by one in order.
+			std::vector<std::unique_ptr<Client>> clients;
+			for (int i = 0; i < 4; i++) {
+				clients.emplace_back(new Client(sockPath));
+				clients.back()->invoke<std::string>("Foo::getName");
+			}
+			EXPECT_EQ(server.getReactorLoads(), Loads({1, 1, 1, 1}));
+
+			clients[2].reset();
+			for (int i = 0; i < 100 && server.getReactorLoads()[2] != 0; i++)
+				std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+			Client next(sockPath);
+			next.invoke<std::string>("Foo::getName");
+			if (balance == Server::Balance::RoundRobin)
+				EXPECT_EQ(server.getReactorLoads(), Loads({2, 1, 0, 1}));
+			else
+				EXPECT_EQ(server.getReactorLoads(), Loads({1, 1, 1, 1}));
+
+			server.stop();
+		});
+
+		server.start();
+
+		if (client.joinable())
+			client.join();
+	}
+}
+
+TEST(APPLICATION, SERVER_WORKERS)
+{
+	SocketPath sockPath("server-workers");
+
+	// server-side
+	Server server;
+	server.listen(sockPath);
+	server.setWorkers(4);
+	EXPECT_EQ(server.getWorkerStatistics().size(), 4);
+
+	auto first = std::make_shared<Sequence>();
+	auto second = std::make_shared<Sequence>();
+	server.expose(first, "First::append", &Sequence::append);
+	server.expose(second, "Second::append", &Sequence::append);
+	server.expose(std::make_shared<Sleeper>(), "Sleeper::sleep", &Sleeper::sleep);
+
+	auto client = std::thread([&]() {
+		std::this_thread::sleep_for(std::chrono::seconds(1));
+
+		// The reactor is not blocked by the slow method.
+		Client slow(sockPath);
+		auto sleeping = slow.invokeAsync<int>("Sleeper::sleep", 1000);
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+		// (The handshake is replied on the reactor.)
+		auto begin = std::chrono::steady_clock::now();
+		for (auto flags : {Message::Flag::Ordered, Message::Flag::OrderedPerObject})
+			Client client(sockPath, flags);
+		EXPECT_LT(std::chrono::steady_clock::now() - begin, std::chrono::milliseconds(500));
+		EXPECT_EQ(sleeping.get(), 1000);
+
+		// The pipelined requests are invoked in order.
+		const int count = 200;
+		for (auto flags : {Message::Flag::Ordered, Message::Flag::OrderedPerObject}) {
+			first->values.clear();
+			second->values.clear();
+
+			Client client(sockPath, flags);
+			std::vector<std::future<int>> futures;
+			for (int i = 0; i < count; i++) {
+				futures.push_back(client.invokeAsync<int>("First::append", i));
+				futures.push_back(client.invokeAsync<int>("Second::append", i));
+			}
+
+			for (auto& future : futures)
+				future.get();
+
+			ASSERT_EQ(first->values.size(), count);
+			ASSERT_EQ(second->values.size(), count);
+			for (int i = 0; i < count; i++) {
+				EXPECT_EQ(first->values[i], i);
+				EXPECT_EQ(second->values[i], i);
+			}
+		}
+
+		// A task is counted after it has sent the reply.
+		std::size_t tasks = 0;
+		for (int i = 0; i < 100 && tasks < 4 * count + 1; i++) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+			tasks = 0;
+			for (const auto& worker : server.getWorkerStatistics())
+				tasks += worker.tasks;
+		}
+		EXPECT_GE(tasks, 4 * count + 1);
+
+		server.stop();
+	});
+
+	server.start();
+
+	if (client.joinable())
+		client.join();
+}
+
+TEST(APPLICATION, SERVER_CONCURRENCY)
+{
+	SocketPath sockPath("server-concurrency");
+
+	// server-side
+	Server server;
+	server.listen(sockPath);
+	server.setWorkers(4);
+
+	auto none = std::make_shared<Sleeper>();
+	auto exclusive = std::make_shared<Sleeper>();
+	auto other = std::make_shared<Sleeper>();
+	auto shared = std::make_shared<Sleeper>();
+	server.expose(none, "None::sleep", &Sleeper::sleep, Server::Concurrency::None);
+	server.expose(exclusive, "Exclusive::sleep", &Sleeper::sleep);
+	server.expose(exclusive, "Exclusive::peek", &Sleeper::peek);
+	server.expose(other, "Other::sleep", &Sleeper::sleep);
+	server.expose(shared, "Shared::sleep", &Sleeper::sleep,
+				  Server::Concurrency::ReaderWriter);
+	server.expose(shared, "Shared::peek", &Sleeper::peek,
+				  Server::Concurrency::ReaderWriter);
+
+	// An object has one policy.
+	EXPECT_THROW(server.expose(none, "None::peek", &Sleeper::peek),
+				 std::invalid_argument);
+
+	auto client = std::thread([&]() {
+		std::this_thread::sleep_for(std::chrono::seconds(1));
+
+		Client first(sockPath), second(sockPath);
+		auto elapsed = [&](const std::string& a, const std::string& b) {
+			auto begin = std::chrono::steady_clock::now();
+			auto one = first.invokeAsync<int>(a, 300);
+			auto another = second.invokeAsync<int>(b, 300);
+			EXPECT_EQ(one.get() + another.get(), 600);
+
+			return std::chrono::steady_clock::now() - begin;
+		};
+
+		const auto parallel = std::chrono::milliseconds(550);
+		EXPECT_LT(elapsed("None::sleep", "None::sleep"), parallel);
+		EXPECT_GE(elapsed("Exclusive::sleep", "Exclusive::sleep"), parallel);
+		// The const method does not share the exclusive object.
+		EXPECT_GE(elapsed("Exclusive::peek", "Exclusive::peek"), parallel);
+		EXPECT_LT(elapsed("Exclusive::sleep", "Other::sleep"), parallel);
+		EXPECT_LT(elapsed("Shared::peek", "Shared::peek"), parallel);
+		EXPECT_GE(elapsed("Shared::peek", "Shared::sleep"), parallel);
+
+		// Exposed while serving.
+		server.expose(std::make_shared<Foo>(), "Late::getName", &Foo::getName);
+		EXPECT_EQ(first.invoke<std::string>("Late::getName"), "");
+
+		server.stop();
+	});
+
+	server.start();
+
+	if (client.joinable())
+		client.join();
+}
+
+TEST(APPLICATION, SERVER_CLIENT_SHARED_MEMORY)
+{
+	SocketPath sockPath("server-shared");
+
+	// server-side
+	Server server;
+	server.listen(sockPath);
+
+	auto foo = std::make_shared<Foo>();
+	server.expose(foo, "Foo::setName", &Foo::setName);
+	server.expose(foo, "Foo::getName", &Foo::getName);
+
+	auto client = std::thread([&]() {
+		std::this_thread::sleep_for(std::chrono::seconds(1));
+
+		// client-side
+		Client client(sockPath, Message::Flag::Compact | Message::Flag::SharedMemory);
+
+		// Larger than the rings.
+		std::string param(3 * 1024 * 1024, 's');
+		for (int i = 0; i < 10; i++) {
+			param[i] = 'a' + i;
+			bool ret = client.invoke<bool>("Foo::setName", param);
+			EXPECT_EQ(ret, false);
+
+			std::string name = client.invoke<std::string>("Foo::getName");
+			EXPECT_EQ(name, param);
+		}
+
+		Client other(sockPath, Message::Flag::SharedMemory);
+		EXPECT_EQ(other.invoke<std::string>("Foo::getName"), param);
+
+		server.stop();
+	});
+
+	server.start();
+
+	if (client.joinable())
+		client.join();
+}
+
+TEST(APPLICATION, SERVER_SHARED_MEMORY_BACKPRESSURE)
+{
+	SocketPath sockPath("server-shared-backpressure");
+
+	// server-side
+	Server server;
+	server.listen(sockPath);
+	server.setWatermarks(256 * 1024, 64 * 1024);
+
+	auto foo = std::make_shared<Foo>();
+	foo->name = std::string(512 * 1024, 'm');
+	server.expose(foo, "Foo::getName", &Foo::getName);
+
+	auto client = std::thread([&]() {
+		std::this_thread::sleep_for(std::chrono::seconds(1));
+
+		// The replies fill the ring which is not read.
+		const int count = 8;
+		Connection lazy(sockPath);
+		ASSERT_EQ(lazy.negotiate(Message::Flag::SharedMemory), Message::Flag::SharedMemory);
+		Message request(Message::Type::MethodCall, "Foo::getName", lazy.getFlags());
+		for (int i = 0; i < count; i++)
+			lazy.send(request);
+
+		for (int i = 0; i < 100 && server.getBackpressure().paused == 0; i++)
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		EXPECT_EQ(server.getBackpressure().paused, 1);
+
+		// The reactor is not blocked by it.
+		Client other(sockPath, Message::Flag::SharedMemory);
+		EXPECT_EQ(other.invoke<std::string>("Foo::getName"), foo->name);
+
+		// The queued ones are written as the ring is read.
+		for (int i = 0; i < count; i++) {
+			std::string name;
+			lazy.recv().disclose(name);
+			EXPECT_EQ(name, foo->name);
+		}
+
+		for (int i = 0; i < 100; i++) {
+			auto backpressure = server.getBackpressure();
+			if (backpressure.resumed == backpressure.paused)
+				break;
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		}
+
+		auto backpressure = server.getBackpressure();
+		EXPECT_GE(backpressure.peakBytes, 256 * 1024);
+		EXPECT_EQ(backpressure.resumed, backpressure.paused);
+
+		server.stop();
+	});
+
+	server.start();
+
+	if (client.joinable())
+		client.join();
+}
+
+TEST(APPLICATION, SERVER_CLIENT_SEALED_BLOB)
+{
+	SocketPath sockPath("server-blob");
+
+	// server-side
+	Server server;
+	server.listen(sockPath);
+
+	auto store = std::make_shared<Store>();
+	server.expose(store, "Store::put", &Store::put);
+	server.expose(store, "Store::get", &Store::get);
+
+	auto client = std::thread([&]() {
+		std::this_thread::sleep_for(std::chrono::seconds(1));
+
+		std::size_t size = 8 * 1024 * 1024;
+		rmi::stream::SealedBlob blob(size);
+		std::memset(blob.writable(), 1, size);
+		blob.seal();
+
+		// Passed through socket and along with shared memory.
+		for (auto flags : {Message::Flag::None, Message::Flag::SharedMemory}) {
+			Client client(sockPath, flags);
+			for (int i = 0; i < 3; i++) {
+				EXPECT_EQ(client.invoke<std::size_t>("Store::put", blob), size);
+
+				auto received = client.invoke<rmi::stream::SealedBlob>("Store::get", size);
+				ASSERT_EQ(received.size(), size);
+				EXPECT_EQ(received.data()[0], 'g');
+				EXPECT_EQ(received.data()[size - 1], 'g');
+			}
+		}
+
+		server.stop();
+	});
+
+	server.start();
+
+	if (client.joinable())
+		client.join();
+}
+
+TEST(APPLICATION, SERVER_CLIENT_TCP)
+{
+	// Find a free port on loopback.
+	std::string address = Socket("tcp:127.0.0.1:0").getAddress();
+
+	// server-side
+	Server server;
+	server.listen(address);
+
+	auto foo = std::make_shared<Foo>();
+	server.expose(foo, "Foo::setName", &Foo::setName);
+	server.expose(foo, "Foo::getName", &Foo::getName);
+
+	auto client = std::thread([&]() {
+		std::this_thread::sleep_for(std::chrono::seconds(1));
+
+		// client-side
+		Client client(address, Message::Flag::Compact | Message::Flag::Compressed);
+
+		std::string param(1024 * 1024, 't');
+		bool ret = client.invoke<bool>("Foo::setName", param);
+		EXPECT_EQ(ret, false);
+
+		std::string name = client.invoke<std::string>("Foo::getName");
+		EXPECT_EQ(name, param);
+
+		server.stop();
+	});
+
+	server.start();
+
+	if (client.joinable())
+		client.join();
+}
+
+TEST(APPLICATION, SERVER_CLIENT_URING)
+{
+	SocketPath sockPath("server-uring");
+
+	// server-side
+	Server server(Mainloop::Backend::IoUring);
+	server.listen(sockPath);
+
+	auto foo = std::make_shared<Foo>();
+	server.expose(foo, "Foo::setName", &Foo::setName);
+	server.expose(foo, "Foo::getName", &Foo::getName);
+
+	auto store = std::make_shared<Store>();
+	server.expose(store, "Store::put", &Store::put);
+
+	auto client = std::thread([&]() {
+		std::this_thread::sleep_for(std::chrono::seconds(1));
+
+		// client-side
+		Client client(sockPath, Message::Flag::Compact);
+
+		// Larger than the provided buffers.
+		std::string param(8 * 1024 * 1024, 'u');
+		for (int i = 0; i < 3; i++) {
+			param[i] = 'a' + i;
+			bool ret = client.invoke<bool>("Foo::setName", param);
+			EXPECT_EQ(ret, false);
+
+			std::string name = client.invoke<std::string>("Foo::getName");
+			EXPECT_EQ(name, param);
+		}
+
+		rmi::stream::SealedBlob blob(4096);
+		std::memset(blob.writable(), 1, blob.size());
+		blob.seal();
+		EXPECT_EQ(client.invoke<std::size_t>("Store::put", blob), 4096);
+
+		// The shared memory is refused, so it keeps the socket.
+		Client other(sockPath, Message::Flag::SharedMemory);
+		EXPECT_EQ(other.invoke<std::string>("Foo::getName"), param);
+
+		server.stop();
+	});
+
+	server.start();
+
+	if (client.joinable())
+		client.join();
+}
+
+TEST(APPLICATION, CLIENT_POOL)
+{
+	SocketPath first("server-pool-a"), second("server-pool-b");
+	std::vector<std::string> sockPaths = {first, second};
+
+	// server-side
+	Server server;
+	for (const auto& sockPath : sockPaths)
+		server.listen(sockPath);
+
+	auto foo = std::make_shared<Foo>();
+	server.expose(foo, "Foo::setName", &Foo::setName);
+	server.expose(foo, "Foo::getName", &Foo::getName);
+
+	auto client = std::thread([&]() {
+		std::this_thread::sleep_for(std::chrono::seconds(1));
+
+		// client-side
+		ClientPool pool(sockPaths, 2, Message::Flag::Compact);
+		EXPECT_EQ(pool.size(), 4);
+		EXPECT_EQ(pool.getHealthyCount(), 4);
+
+		std::string param(64 * 1024, 'p');
+		EXPECT_EQ(pool.invoke<bool>("Foo::setName", param), false);
+
+		std::vector<std::thread> callers;
+		for (int i = 0; i < 8; i++) {
+			callers.emplace_back([&]() {
+				for (int j = 0; j < 50; j++)
+					EXPECT_EQ(pool.invoke<std::string>("Foo::getName"), param);
+			});
+		}
+
+		for (auto& caller : callers)
+			caller.join();
+
+		server.stop();
+	});
+
+	server.start();
+
+	if (client.joinable())
+		client.join();
+}
+
+TEST(APPLICATION, CLIENT_POOL_HEALTH)
+{
+	SocketPath sockPath("server-pool-health");
+	SocketPath nowhere("server-pool-nowhere");
+
+	// server-side
+	Server server;
+	server.listen(sockPath);
+
+	auto foo = std::make_shared<Foo>();
+	server.expose(foo, "Foo::getName", &Foo::getName);
+	server.expose(std::make_shared<Faulty>(), "Faulty::fail", &Faulty::fail);
+
+	auto client = std::thread([&]() {
+		std::this_thread::sleep_for(std::chrono::seconds(1));
+
+		// client-side
+		ClientPool pool({sockPath, nowhere}, 2);
+		EXPECT_EQ(pool.getHealthyCount(), 2);
+
+		// The unreachable ones are skipped.
+		for (int i = 0; i < 10; i++)
+			EXPECT_EQ(pool.invoke<std::string>("Foo::getName"), "");
+
+		// The failure of remote method does not drop the connection.
+		EXPECT_THROW(pool.invoke<int>("Faulty::fail", 1), std::runtime_error);
+		EXPECT_EQ(pool.getHealthyCount(), 2);
+
+		// And joined once the server is up.
+		Socket late(nowhere);
+		EXPECT_EQ(pool.check(), 4);
+
+		server.stop();
+	});
+
+	server.start();
+
+	if (client.joinable())
+		client.join();
+
+	EXPECT_THROW(ClientPool({sockPath}, 0), std::invalid_argument);
+}
+
+TEST(APPLICATION, CLIENT_POOL_PROBE)
+{
+	SocketPath sockPath("server-pool-probe");
+	std::unique_ptr<Socket> listener(new Socket(sockPath));
+
+	ClientPool pool({sockPath}, 2);
+	EXPECT_EQ(pool.getHealthyCount(), 2);
+
+	{
+		Socket first = listener->accept();
+		Socket second = listener->accept();
+		EXPECT_EQ(pool.check(), 2);
+
+		// The server goes away while the connections are idle.
+		listener.reset();
+	}
+
+	// Found without any call.
+	EXPECT_EQ(pool.check(), 0);
+	EXPECT_THROW(pool.invoke<int>("Foo::echo", 1), std::runtime_error);
+}
+
+TEST(APPLICATION, SERVER_CLIENT_ASYNC)
+{
+	SocketPath sockPath("server-async");
+
+	// server-side
+	Server server;
+	server.listen(sockPath);
+
+	auto foo = std::make_shared<Foo>();
+	server.expose(foo, "Foo::setName", &Foo::setName);
+	server.expose(foo, "Foo::getName", &Foo::getName);
+
+	auto client = std::thread([&]() {
+		std::this_thread::sleep_for(std::chrono::seconds(1));
+
+		// client-side
+		Client client(sockPath, Message::Flag::Compact);
+
+		std::string param(32 * 1024, 'a');
+		EXPECT_EQ(client.invokeAsync<bool>("Foo::setName", param).get(), false);
+
+		// Many calls are in flight at once.
+		std::vector<std::future<std::string>> futures;
+		for (int i = 0; i < 100; i++)
+			futures.push_back(client.invokeAsync<std::string>("Foo::getName"));
+
+		for (auto& future : futures)
+			EXPECT_EQ(future.get(), param);
+
+		std::atomic<int> called(0);
+		std::promise<void> done;
+		Client::Callback<std::string> callback = [&](std::string name, std::exception_ptr error) {
+			EXPECT_EQ(error, nullptr);
+			EXPECT_EQ(name, param);
+			if (++called == 10)
+				done.set_value();
+		};
+
+		for (int i = 0; i < 10; i++)
+			client.invokeAsync(callback, "Foo::getName");
+		done.get_future().wait();
+
+		// The round trip shares the connection with them.
+		EXPECT_EQ(client.invoke<std::string>("Foo::getName"), param);
+
+		server.stop();
+	});
+
+	server.start();
+
+	if (client.joinable())
+		client.join();
+}
+
+TEST(APPLICATION, CLIENT_ASYNC_OUT_OF_ORDER)
+{
+	SocketPath sockPath("server-out-of-order");
+	Socket socket(sockPath);
+
+	// The server which replies in reverse order.
+	auto server = std::thread([&]() {
+		Connection connection{socket.accept()};
+
+		std::vector<Message> requests;
+		for (int i = 0; i < 3; i++)
+			requests.push_back(connection.recv());
+
+		// The reply of unknown id is dropped.
+		Message unknown(Message::Type::Reply, "Foo::echo");
+		unknown.header.id = 1000;
+		unknown.enclose(-1);
+		connection.send(unknown);
+
+		for (auto iter = requests.rbegin(); iter != requests.rend(); iter++) {
+			int value;
+			iter->disclose(value);
+
+			Message reply(Message::Type::Reply, iter->signature);
+			reply.header.id = iter->header.id;
+			reply.enclose(value);
+			connection.send(reply);
+		}
+	});
+
+	{
+		Client client(sockPath);
+
+		std::vector<std::future<int>> futures;
+		for (int i = 0; i < 3; i++)
+			futures.push_back(client.invokeAsync<int>("Foo::echo", i));
+
+		for (int i = 0; i < 3; i++)
+			EXPECT_EQ(futures[i].get(), i);
+
+		server.join();
+
+		// The pending call fails once the connection is closed.
+		auto orphan = client.invokeAsync<int>("Foo::echo", 3);
+		EXPECT_THROW(orphan.get(), std::runtime_error);
+	}
+}
+
+TEST(APPLICATION, CLIENT_BROKEN)
+{
+	SocketPath sockPath("client-broken");
+	Socket socket(sockPath);
+
+	// The server which closes the connection without reply.
+	auto server = std::thread([&]() {
+		Connection connection{socket.accept()};
+		connection.recv();
+	});
+
+	Client client(sockPath);
+	EXPECT_THROW(client.invoke<int>("Foo::echo", 1), std::runtime_error);
+	server.join();
+	EXPECT_TRUE(client.isBroken());
+
+	// The call is not sent on the connection known to be broken.
+	EXPECT_THROW(client.invoke<int>("Foo::echo", 2), std::runtime_error);
+	EXPECT_THROW(client.invokeAsync<int>("Foo::echo", 3).get(), std::runtime_error);
+}
+
+TEST(APPLICATION, SERVER_CLIENT_ERROR)
+{
+	for (std::size_t workers : {0, 2}) {
+		SocketPath sockPath("server-error");
+
+		// server-side
+		Server server;
+		server.listen(sockPath);
+		server.setWorkers(workers);
+
+		auto foo = std::make_shared<Foo>();
+		server.expose(foo, "Foo::getName", &Foo::getName);
+		server.expose(std::make_shared<Faulty>(), "Faulty::fail", &Faulty::fail);
+
+		auto client = std::thread([&]() {
+			std::this_thread::sleep_for(std::chrono::seconds(1));
+
+			Client client(sockPath);
+			EXPECT_THROW(client.invoke<int>("Foo::none", 1), std::runtime_error);
+			try {
+				client.invoke<int>("Faulty::fail", 1);
+				ADD_FAILURE();
+			} catch (const std::runtime_error& e) {
+				EXPECT_NE(std::string(e.what()).find("Faulty 1"), std::string::npos);
+			}
+
+			// The waiting calls fail instead of hanging.
+			auto unknown = client.invokeAsync<int>("Foo::none", 2);
+			auto thrown = client.invokeAsync<int>("Faulty::fail", 3);
+			EXPECT_THROW(unknown.get(), std::runtime_error);
+			EXPECT_THROW(thrown.get(), std::runtime_error);
+
+			std::promise<std::string> failure;
+			client.invokeAsync<int>([&](int, std::exception_ptr error) {
+				try {
+					std::rethrow_exception(error);
+				} catch (const std::exception& e) {
+					failure.set_value(e.what());
+				}
+			}, "Faulty::fail", 4);
+			EXPECT_NE(failure.get_future().get().find("Faulty 4"), std::string::npos);
+
+			// The connection is still usable.
+			EXPECT_EQ(client.invoke<std::string>("Foo::getName"), foo->name);
+
+			server.stop();
+		});
+
+		server.start();
+
+		if (client.joinable())
+			client.join();
+	}
+}
+
+TEST(APPLICATION, SERVER_CLIENT_BATCH)
+{
+	SocketPath sockPath("server-batch");
+
+	// server-side
+	Server server;
+	server.listen(sockPath);
+
+	auto foo = std::make_shared<Foo>();
+	server.expose(foo, "Foo::setName", &Foo::setName);
+	server.expose(foo, "Foo::getName", &Foo::getName);
+
+	auto store = std::make_shared<Store>();
+	server.expose(store, "Store::put", &Store::put);
+	server.expose(store, "Store::get", &Store::get);
+
+	auto client = std::thread([&]() {
+		std::this_thread::sleep_for(std::chrono::seconds(1));
+
+		rmi::stream::SealedBlob blob(4096);
+		std::memset(blob.writable(), 1, 4096);
+		blob.seal();
+
+		for (auto flags : {Message::Flag::None, Message::Flag::Compact}) {
+			Client client(sockPath, flags);
+
+			Batch batch;
+			EXPECT_EQ(batch.add("Foo::setName", std::string("batch")), 0);
+			EXPECT_EQ(batch.add("Foo::getName"), 1);
+			EXPECT_EQ(batch.add("Foo::unknown", 1), 2);
+			EXPECT_EQ(batch.add("Store::put", blob), 3);
+			EXPECT_EQ(batch.add("Store::get", std::size_t(1024)), 4);
+			EXPECT_EQ(batch.size(), 5);
+
+			// The calls are invoked in order.
+			auto result = client.invoke(batch);
+			ASSERT_EQ(result.size(), 5);
+			EXPECT_TRUE(result.succeeded(0));
+			EXPECT_EQ(result.get<bool>(0), false);
+			EXPECT_EQ(result.get<std::string>(1), "batch");
+
+			// The failure of a call does not stop the others.
+			EXPECT_FALSE(result.succeeded(2));
+			EXPECT_FALSE(result.getError(2).empty());
+			EXPECT_THROW(result.get<int>(2), std::runtime_error);
+
+			EXPECT_EQ(result.get<std::size_t>(3), 4096);
+			auto received = result.get<rmi::stream::SealedBlob>(4);
+			ASSERT_EQ(received.size(), 1024);
+			EXPECT_EQ(received.data()[1023], 'g');
+
+			EXPECT_THROW(result.succeeded(5), std::out_of_range);
+
+			// The client goes on with single calls.
+			EXPECT_EQ(client.invoke<std::string>("Foo::getName"), "batch");
+			EXPECT_EQ(client.invokeAsync<std::string>("Foo::getName").get(), "batch");
+
+			batch.clear();
+			EXPECT_EQ(client.invoke(batch).size(), 0);
+		}
+
+		// The malformed batch is replied with an error.
+		Connection raw(sockPath);
+		Message malformed(Message::Type::Batch, "Batch");
+		malformed.enclose(std::size_t(3));
+		Message reply = raw.request(malformed);
+		EXPECT_EQ(reply.header.type, Message::Type::Error);
+		EXPECT_EQ(reply.header.id, malformed.header.id);
+
+		server.stop();
+	});
+
+	server.start();
+
+	if (client.joinable())
+		client.join();
+}
@@ -0,0 +1,103 @@
+/*
+ *  Copyright (c) 2018 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * @file        test-executor.cpp
+ * @author      Sangwan Kwon (sangwan.kwon@samsung.com)
+ */
+
+#include "event/executor.hxx"
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace rmi::event;
+
+TEST(EVENT, EXECUTOR_SUBMIT)
+{
+	std::atomic<int> count{0};
+	{
+		Executor executor(4);
+		EXPECT_EQ(executor.size(), 4);
+
+		for (int i = 0; i < 1000; i++)
+			executor.submit([&count]() { count++; });
+
+		// The exception of a task does not stop the worker.
+		executor.submit([]() { throw std::runtime_error("task"); });
+	}
+
+	// The tasks left are run before the workers are joined.
+	EXPECT_EQ(count, 1000);
+
+	EXPECT_THROW(Executor(0), std::invalid_argument);
+}
+
+TEST(EVENT, EXECUTOR_ORDERED)
+{
+	const int count = 1000;
+	std::vector<int> first, second;
+
+	{
+		Executor executor(4);
+		for (int i = 0; i < count; i++) {
+			executor.submit(&first, [&first, i]() { first.push_back(i); });
+			executor.submit(&second, [&second, i]() { second.push_back(i); });
+		}
+	}
+
+	ASSERT_EQ(first.size(), count);
+	ASSERT_EQ(second.size(), count);
+	for (int i = 0; i < count; i++) {
+		EXPECT_EQ(first[i], i);
+		EXPECT_EQ(second[i], i);
+	}
+}
+
+TEST(EVENT, EXECUTOR_STEALING)
+{
+	const int count = 20;
+	std::atomic<int> done{0};
+
+	Executor executor(2);
+
+	// All go to the queue of the worker which submits them.
+	executor.submit([&]() {
+		for (int i = 0; i < count; i++) {
+			executor.submit([&done]() {
+				std::this_thread::sleep_for(std::chrono::milliseconds(5));
+				done++;
+			});
+		}
+	});
+
+	while (done < count)
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+	auto statistics = executor.getStatistics();
+	ASSERT_EQ(statistics.size(), 2);
+	EXPECT_EQ(statistics[0].tasks + statistics[1].tasks, count + 1);
+	EXPECT_GT(statistics[0].steals + statistics[1].steals, 0);
+	for (const auto& worker : statistics) {
+		EXPECT_GT(worker.tasks, 0);
+		EXPECT_GT(worker.utilization, 0.0);
+		EXPECT_LE(worker.utilization, 1.0);
+	}
+}
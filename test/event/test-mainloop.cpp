@@ -0,0 +1,140 @@
+/*
+ *  Copyright (c) 2018 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * @file        test-mainloop.cpp
+ * @author      Sangwan Kwon (sangwan.kwon@samsung.com)
+ */
+
+#include "event/mainloop.hxx"
+#include "event/eventfd.hxx"
+#include "transport/socket.hxx"
+
+#include <string>
+#include <thread>
+#include <memory>
+#include <vector>
+
+#include <unistd.h>
+#include <sys/uio.h>
+
+#include <gtest/gtest.h>
+
+#include "socket-path.hxx"
+
+using namespace rmi::event;
+using namespace rmi::transport;
+
+namespace {
+
+const std::vector<Mainloop::Backend> BACKENDS = {Mainloop::Backend::Epoll,
+												 Mainloop::Backend::IoUring};
+
+} // anonymous namespace
+
+TEST(EVENT, MAINLOOP_BACKEND)
+{
+	Mainloop epoll(Mainloop::Backend::Epoll);
+	EXPECT_EQ(epoll.getBackend(), Mainloop::Backend::Epoll);
+
+	// Fall back to epoll on the old kernel.
+	Mainloop uring(Mainloop::Backend::IoUring);
+	auto expected = IoUring::isSupported() ? Mainloop::Backend::IoUring
+										   : Mainloop::Backend::Epoll;
+	EXPECT_EQ(uring.getBackend(), expected);
+}
+
+TEST(EVENT, MAINLOOP_LEVEL_HANDLER)
+{
+	for (auto backend : BACKENDS) {
+		Mainloop mainloop(backend);
+		EventFD event;
+
+		// Reported again while readable.
+		int count = 0;
+		auto onEvent = [&]() {
+			if (++count < 3)
+				return;
+
+			event.receive();
+			mainloop.removeHandler(event.getFd());
+			mainloop.stop();
+		};
+
+		mainloop.addHandler(event.getFd(), std::move(onEvent));
+		event.send();
+		mainloop.run();
+
+		EXPECT_EQ(count, 3);
+	}
+}
+
+TEST(EVENT, MAINLOOP_ACCEPT_RECEIVE)
+{
+	SocketPath sockPath("mainloop");
+
+	for (auto backend : BACKENDS) {
+		Mainloop mainloop(backend);
+		Socket socket(sockPath);
+
+		// Larger than a provided buffer.
+		std::string payload(1024 * 1024, 'p');
+		for (std::size_t i = 0; i < payload.size(); i += 1000)
+			payload[i] = 'a' + (i % 26);
+
+		std::shared_ptr<Socket> accepted;
+		std::string received;
+		std::size_t descriptors = 0;
+		bool closed = false;
+
+		auto onReceive = [&](const unsigned char* data, std::size_t size,
+							 std::vector<int>& fds) {
+			received.append(reinterpret_cast<const char*>(data), size);
+			descriptors += fds.size();
+		};
+
+		auto onClose = [&]() {
+			closed = true;
+			mainloop.removeHandler(accepted->getFd());
+			mainloop.stop();
+		};
+
+		auto onAccept = [&](int fd) {
+			accepted = std::make_shared<Socket>(socket.adopt(fd));
+			accepted->setNonBlocking(true);
+			mainloop.addReceiveHandler(fd, onReceive, []() {}, onClose);
+		};
+
+		mainloop.addAcceptHandler(socket.getFd(), std::move(onAccept));
+
+		auto client = std::thread([&]() {
+			Socket connected = Socket::connect(sockPath);
+
+			EventFD event;
+			int fd = event.getFd();
+			::iovec vector = {const_cast<char*>(payload.data()), payload.size()};
+			connected.sendv(&vector, 1, &fd, 1);
+		});
+
+		mainloop.run();
+
+		if (client.joinable())
+			client.join();
+
+		EXPECT_EQ(received, payload);
+		EXPECT_EQ(descriptors, 1);
+		EXPECT_TRUE(closed);
+	}
+}
@@ -41,6 +41,11 @@ struct Foo {
 		return this->name;
 	}
 
+	std::size_t getLength(void) const
+	{
+		return this->name.size();
+	}
+
 	int echo(const std::string& a, const std::string b, std::string& c)
 	{
 		std::cout << a << ", " << b << ", " << c << std::endl;
@@ -118,3 +123,23 @@ TEST(FUNCTOR, ARCHIVE)
 	result >> ret;
 	EXPECT_EQ(ret, false);
 }
+
+TEST(FUNCTOR, CONST_MEMBER)
+{
+	auto foo = std::make_shared<Foo>();
+	foo->name = "Foo name";
+
+	auto fooGetLength = make_functor(foo, &Foo::getLength);
+	EXPECT_EQ(fooGetLength(), foo->name.size());
+
+	FunctorMap fooMap;
+	fooMap["getLength"] = make_functor_ptr(foo, &Foo::getLength);
+	fooMap["getName"] = make_functor_ptr(foo, &Foo::getName);
+
+	// The const methods are readers of the instance.
+	EXPECT_TRUE(fooMap.at("getLength")->isConst());
+	EXPECT_FALSE(fooMap.at("getName")->isConst());
+	EXPECT_EQ(fooMap.at("getLength")->getInstance(), foo.get());
+
+	EXPECT_EQ(fooMap.at("getLength")->invoke<std::size_t>(), foo->name.size());
+}
@@ -0,0 +1,60 @@
+/*
+ *  Copyright (c) 2018 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * @file        socket-path.hxx
+ * @author      Sangwan Kwon (sangwan.kwon@samsung.com)
+ * @brief       Unique path of unix socket for tests. (Header Only)
+ * @usage       SocketPath sockPath("server");
+ *              server.listen(sockPath);
+ */
+
+#pragma once
+
+#include <string>
+
+#include <unistd.h>
+
+// The socket file is placed apart from the working directory,
+// and removed when the path goes out of scope.
+class SocketPath {
+public:
+	explicit SocketPath(const std::string& name) :
+		path("/tmp/rmi-test-" + name + "-" + std::to_string(::getpid()))
+	{
+		::unlink(this->path.c_str());
+	}
+
+	~SocketPath()
+	{
+		::unlink(this->path.c_str());
+	}
+
+	SocketPath(const SocketPath&) = delete;
+	SocketPath& operator=(const SocketPath&) = delete;
+
+	const std::string& get(void) const noexcept
+	{
+		return this->path;
+	}
+
+	operator const std::string&(void) const noexcept
+	{
+		return this->path;
+	}
+
+private:
+	std::string path;
+};
@@ -0,0 +1,192 @@
+/*
+ *  Copyright (c) 2018 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * @file        test-archive-view.cpp
+ * @author      Sangwan Kwon (sangwan.kwon@samsung.com)
+ */
+
+#include "stream/archive-view.hxx"
+#include "klass/functor.hxx"
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace rmi::stream;
+using namespace rmi::klass;
+
+TEST(STREAM, VIEW_STRING)
+{
+	std::string input = "Archive string view test";
+
+	Archive archive;
+	archive << input;
+
+	StringView output;
+	archive >> output;
+
+	EXPECT_EQ(output, input);
+	EXPECT_EQ(output.str(), input);
+	// Borrowed from the archive without copying.
+	EXPECT_EQ(reinterpret_cast<const unsigned char*>(output.data()),
+			  archive.get() + sizeof(std::size_t));
+}
+
+TEST(STREAM, VIEW_BLOB)
+{
+	std::vector<unsigned char> input = {0x00, 0x01, 0xFE, 0xFF};
+
+	Archive archive;
+	archive << BlobView(input.data(), input.size());
+
+	std::string raw;
+	archive >> raw;
+
+	BlobView output(reinterpret_cast<const unsigned char*>(raw.data()), raw.size());
+	EXPECT_EQ(output, BlobView(input.data(), input.size()));
+}
+
+TEST(STREAM, ARCHIVE_VIEW)
+{
+	int input1 = 100;
+	std::string input2 = "Archive view test";
+
+	Archive archive;
+	archive << input1 << input2;
+
+	ArchiveView view(archive.get(), archive.size());
+	EXPECT_EQ(view.size(), archive.size());
+
+	int output1;
+	StringView output2;
+	view >> output1 >> output2;
+
+	EXPECT_EQ(input1, output1);
+	EXPECT_EQ(output2, input2);
+	EXPECT_EQ(reinterpret_cast<const unsigned char*>(output2.data()),
+			  archive.get() + sizeof(int) + sizeof(std::size_t));
+}
+
+TEST(STREAM, ARCHIVE_VIEW_READ_ONLY)
+{
+	Archive archive;
+	archive << 1;
+
+	ArchiveView view(archive);
+	EXPECT_THROW(view << 2, std::logic_error);
+	EXPECT_THROW(view << view, std::logic_error);
+
+	// Not referenced over threshold either.
+	std::string large(4096, 'r');
+	view.setReferenceThreshold(1024);
+	EXPECT_THROW(view << large, std::logic_error);
+	EXPECT_TRUE(view.getDescriptors().empty());
+
+	// Through Archive, the bytes of view are reported but not writable.
+	const Archive& readable = view;
+	EXPECT_EQ(readable.get(), archive.get());
+	EXPECT_EQ(readable.size(), archive.size());
+	Archive& writable = view;
+	EXPECT_THROW(writable.get(), std::logic_error);
+
+	// The referenced bytes are not contiguous, so flattened ones are viewed.
+	Archive referenced;
+	referenced.setReferenceThreshold(1024);
+	referenced << 1 << large;
+	EXPECT_THROW(ArchiveView{referenced}, std::invalid_argument);
+
+	referenced.flatten();
+	ArchiveView flattened(referenced);
+	int number;
+	std::string output;
+	flattened >> number >> output;
+	EXPECT_EQ(number, 1);
+	EXPECT_EQ(output, large);
+}
+
+TEST(STREAM, ARCHIVE_VIEW_APPEND)
+{
+	std::string input = "Archive view append";
+
+	Archive archive;
+	archive << 1 << input;
+
+	// The unread bytes of view are appended and measured.
+	ArchiveView view(archive.get(), archive.size());
+	int skipped;
+	view >> skipped;
+
+	Archive appended;
+	EXPECT_EQ(appended.measure(view), archive.size() - sizeof(int));
+	appended << view;
+	EXPECT_EQ(appended.size(), archive.size() - sizeof(int));
+
+	std::string output;
+	appended >> output;
+	EXPECT_EQ(output, input);
+}
+
+TEST(STREAM, ARCHIVE_VIEW_OUT_OF_RANGE)
+{
+	std::string input = "Archive view test";
+
+	Archive archive;
+	archive << input;
+
+	// Truncate the bytes of string.
+	ArchiveView view(archive.get(), archive.size() - 1);
+
+	StringView output;
+	EXPECT_THROW(view >> output, std::out_of_range);
+
+	std::string copied;
+	ArchiveView view2(archive.get(), sizeof(std::size_t) - 1);
+	EXPECT_THROW(view2 >> copied, std::out_of_range);
+}
+
+struct Bar {
+	std::size_t length(StringView name, BlobView blob)
+	{
+		this->borrowed = name.data();
+		return name.size() + blob.size();
+	}
+
+	const char* borrowed = nullptr;
+};
+
+TEST(STREAM, ARCHIVE_VIEW_FUNCTOR)
+{
+	auto bar = std::make_shared<Bar>();
+	auto functor = make_functor_ptr(bar, &Bar::length);
+
+	std::string name = "borrowed parameter";
+	std::string blob(1024, 'b');
+
+	Archive archive;
+	archive << name << blob;
+
+	ArchiveView view(archive);
+	auto result = functor->invoke(view);
+
+	std::size_t ret = 0;
+	result >> ret;
+	EXPECT_EQ(ret, name.size() + blob.size());
+	EXPECT_EQ(reinterpret_cast<const unsigned char*>(bar->borrowed),
+			  archive.get() + sizeof(std::size_t));
+}
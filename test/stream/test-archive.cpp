@@ -20,10 +20,18 @@
 
 #include "stream/archive.hxx"
 
+#include <array>
+#include <map>
 #include <memory>
 #include <limits>
+#include <set>
 #include <string>
 #include <cassert>
+#include <stdexcept>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -314,3 +322,348 @@ TEST(STREAM, PARAMETER_PACK_TRANSFORM_EMPTY)
 	Archive archive;
 	archive.transform(tuple);
 }
+
+TEST(STREAM, ARCHIVE_GROWTH)
+{
+	const int count = 10000;
+
+	Archive archive;
+	archive.reserve(sizeof(int));
+	for (int i = 0; i < count; i++)
+		archive << i;
+
+	EXPECT_EQ(archive.size(), sizeof(int) * count);
+
+	for (int i = 0; i < count; i++) {
+		int output;
+		archive >> output;
+		EXPECT_EQ(i, output);
+	}
+}
+
+TEST(STREAM, ARCHIVE_SELF_APPEND)
+{
+	std::string input = "Archive string test";
+
+	Archive archive;
+	archive << input;
+	archive << archive;
+
+	std::string output1, output2;
+	archive >> output1 >> output2;
+
+	EXPECT_EQ(input, output1);
+	EXPECT_EQ(input, output2);
+
+	// Not referenced into the temporary copy.
+	std::string large(4096, 's');
+	Archive referencing;
+	referencing.setReferenceThreshold(1024);
+	referencing << large;
+	referencing << referencing;
+	referencing << referencing;
+
+	for (int i = 0; i < 4; i++) {
+		std::string output;
+		referencing >> output;
+		EXPECT_EQ(output, large);
+	}
+}
+
+TEST(STREAM, VECTOR)
+{
+	std::vector<int> input1 = {std::numeric_limits<int>::lowest(), 0, 1, 2,
+							   std::numeric_limits<int>::max()};
+	std::vector<std::string> input2 = {"vector", "of", "string"};
+	std::vector<bool> input3 = {true, false, true};
+	std::vector<double> input4;
+
+	Archive archive;
+	archive << input1 << input2 << input3 << input4;
+
+	std::vector<int> output1 = {42};
+	std::vector<std::string> output2;
+	std::vector<bool> output3;
+	std::vector<double> output4 = {1.0};
+	archive >> output1 >> output2 >> output3 >> output4;
+
+	EXPECT_EQ(input1, output1);
+	EXPECT_EQ(input2, output2);
+	EXPECT_EQ(input3, output3);
+	EXPECT_EQ(input4, output4);
+}
+
+TEST(STREAM, ARRAY)
+{
+	std::array<float, 3> input1 = {{1.5f, 2.5f, 3.5f}};
+	std::array<std::string, 2> input2 = {{"array", "string"}};
+
+	Archive archive;
+	archive << input1 << input2;
+	EXPECT_EQ(archive.size(), sizeof(float) * 3 + (sizeof(std::size_t) + 5) +
+							  (sizeof(std::size_t) + 6));
+
+	std::array<float, 3> output1;
+	std::array<std::string, 2> output2;
+	archive >> output1 >> output2;
+
+	EXPECT_EQ(input1, output1);
+	EXPECT_EQ(input2, output2);
+}
+
+TEST(STREAM, PAIR_TUPLE)
+{
+	std::pair<int, std::string> input1(1, "pair");
+	std::tuple<bool, double, std::string> input2(true, 3.14, "tuple");
+	std::tuple<> input3;
+
+	Archive archive;
+	archive << input1 << input2 << input3;
+
+	std::pair<int, std::string> output1;
+	std::tuple<bool, double, std::string> output2;
+	std::tuple<> output3;
+	archive >> output1 >> output2 >> output3;
+
+	EXPECT_EQ(input1, output1);
+	EXPECT_EQ(input2, output2);
+}
+
+TEST(STREAM, MAP_SET)
+{
+	std::map<std::string, int> input1 = {{"a", 1}, {"b", 2}, {"c", 3}};
+	std::unordered_map<int, std::vector<int>> input2 = {{1, {1}}, {2, {2, 2}}};
+	std::set<std::string> input3 = {"x", "y", "z"};
+
+	Archive archive;
+	archive << input1 << input2 << input3;
+
+	std::map<std::string, int> output1 = {{"stale", 0}};
+	std::unordered_map<int, std::vector<int>> output2;
+	std::set<std::string> output3;
+	archive >> output1 >> output2 >> output3;
+
+	EXPECT_EQ(input1, output1);
+	EXPECT_EQ(input2, output2);
+	EXPECT_EQ(input3, output3);
+}
+
+TEST(STREAM, CONTAINER_OUT_OF_RANGE)
+{
+	std::size_t length = std::numeric_limits<std::size_t>::max() / 2;
+
+	Archive archive;
+	archive << length << 1 << 2;
+
+	std::vector<int> output;
+	EXPECT_THROW(archive >> output, std::out_of_range);
+}
+
+TEST(STREAM, COMPACT_INTEGER)
+{
+	std::vector<long long int> inputs = {0, 1, -1, 63, -64, 64, -65, 300, -300,
+										 std::numeric_limits<int>::max(),
+										 std::numeric_limits<int>::lowest(),
+										 std::numeric_limits<long long int>::max(),
+										 std::numeric_limits<long long int>::lowest()};
+
+	for (auto input : inputs) {
+		Archive archive;
+		archive.setEncoding(Archive::Encoding::Compact);
+		archive << input;
+
+		EXPECT_EQ(archive.size(), varintSize(zigzag(input)));
+
+		long long int output;
+		archive >> output;
+		EXPECT_EQ(input, output);
+	}
+
+	unsigned long long int max = std::numeric_limits<unsigned long long int>::max();
+	short small = -2;
+
+	Archive archive;
+	archive.setEncoding(Archive::Encoding::Compact);
+	archive << max << small;
+	EXPECT_EQ(archive.size(), MAX_VARINT_SIZE + 1);
+
+	unsigned long long int output1;
+	short output2;
+	archive >> output1 >> output2;
+	EXPECT_EQ(max, output1);
+	EXPECT_EQ(small, output2);
+}
+
+TEST(STREAM, COMPACT_LENGTH)
+{
+	std::string input1 = "compact";
+	std::vector<int> input2 = {1, -2, 3, -4};
+	std::vector<double> input3 = {1.5, 2.5};
+	bool input4 = true;
+	char input5 = 'c';
+
+	Archive archive;
+	archive.setEncoding(Archive::Encoding::Compact);
+	archive << input1 << input2 << input3 << input4 << input5;
+
+	EXPECT_EQ(archive.size(), (1 + input1.size()) + (1 + input2.size()) +
+							  (1 + sizeof(double) * input3.size()) + 1 + 1);
+
+	std::string output1;
+	std::vector<int> output2;
+	std::vector<double> output3;
+	bool output4;
+	char output5;
+	archive >> output1 >> output2 >> output3 >> output4 >> output5;
+
+	EXPECT_EQ(input1, output1);
+	EXPECT_EQ(input2, output2);
+	EXPECT_EQ(input3, output3);
+	EXPECT_EQ(input4, output4);
+	EXPECT_EQ(input5, output5);
+}
+
+TEST(STREAM, COMPACT_MALFORMED)
+{
+	Archive truncated;
+	truncated << static_cast<unsigned char>(0x80);
+	truncated.setEncoding(Archive::Encoding::Compact);
+
+	int output;
+	EXPECT_THROW(truncated >> output, std::out_of_range);
+
+	Archive overflow;
+	overflow.setEncoding(Archive::Encoding::Compact);
+	overflow << std::numeric_limits<long long int>::max();
+
+	EXPECT_THROW(overflow >> output, std::out_of_range);
+}
+
+TEST(STREAM, REFERENCE)
+{
+	std::string small = "copied";
+	std::string large(1024, 'r');
+	std::vector<int> bulk(256, 7);
+
+	Archive archive;
+	archive.setReferenceThreshold(1024);
+	archive << small << large << 1 << bulk;
+
+	auto copiedSize = (sizeof(std::size_t) + small.size()) + sizeof(std::size_t) +
+					  sizeof(int) + sizeof(std::size_t);
+	EXPECT_EQ(archive.size(), copiedSize + large.size() + sizeof(int) * bulk.size());
+
+	// small, large, 1 with length of bulk, bulk
+	auto pieces = archive.gather();
+	ASSERT_EQ(pieces.size(), 4);
+	EXPECT_EQ(pieces[1].data(), reinterpret_cast<const unsigned char*>(large.data()));
+	EXPECT_EQ(pieces[3].data(), reinterpret_cast<const unsigned char*>(bulk.data()));
+
+	// Appending keeps the references.
+	Archive appended;
+	appended.setReferenceThreshold(1024);
+	appended << archive;
+	EXPECT_EQ(appended.gather().size(), 4);
+
+	std::string output1, output2;
+	int output3;
+	std::vector<int> output4;
+	archive >> output1 >> output2 >> output3 >> output4;
+
+	EXPECT_EQ(small, output1);
+	EXPECT_EQ(large, output2);
+	EXPECT_EQ(1, output3);
+	EXPECT_EQ(bulk, output4);
+	EXPECT_EQ(archive.gather().size(), 0);
+}
+
+struct Point : public Archival {
+	void pack(Archive& archive) const override
+	{
+		archive << x << y;
+	}
+
+	void unpack(Archive& archive) override
+	{
+		archive >> x >> y;
+	}
+
+	int x = 1;
+	int y = 2;
+};
+
+namespace rmi {
+namespace stream {
+
+template<>
+struct SerializedSize<Point> : PackSize<int, int> {};
+
+} // namespace stream
+} // namespace rmi
+
+TEST(STREAM, SERIALIZED_SIZE)
+{
+	static_assert(SerializedSize<int>::fixed, "int is fixed size.");
+	static_assert(SerializedSize<int>::size == sizeof(int), "int size.");
+	static_assert(SerializedSize<int>::bound == 5, "int varint bound.");
+	static_assert(SerializedSize<bool>::bound == 1, "bool is not varint.");
+	static_assert(SerializedSize<std::array<double, 4>>::size == sizeof(double) * 4,
+				  "array size.");
+	static_assert(PackSize<int, char, std::pair<long, Point>>::fixed, "pack is fixed.");
+	static_assert(PackSize<int, std::tuple<double, Point>>::size ==
+				  sizeof(int) + sizeof(double) + sizeof(int) * 2, "pack size.");
+	static_assert(!PackSize<int, std::string>::fixed, "string is not fixed.");
+	static_assert(!SerializedSize<Object>::fixed, "archival is not fixed.");
+}
+
+TEST(STREAM, MEASURE)
+{
+	int input1 = 100;
+	std::string input2 = "measure";
+	std::vector<std::string> input3 = {"a", "bb"};
+	std::map<int, std::vector<int>> input4 = {{1, {1, 2}}, {2, {}}};
+	std::tuple<bool, std::string, Point> input5(true, "tuple", Point());
+	std::unique_ptr<double> input6(new double(1.5));
+
+	for (auto encoding : {Archive::Encoding::Fixed, Archive::Encoding::Compact}) {
+		Archive archive;
+		archive.setEncoding(encoding);
+
+		auto measured = archive.measure(input1, input2, input3, input4, input5, input6);
+		archive.pack(input1, input2, input3, input4, input5, input6);
+
+		if (encoding == Archive::Encoding::Fixed)
+			EXPECT_EQ(measured, archive.size());
+		else
+			EXPECT_GE(measured, archive.size());
+	}
+
+	Archive fixed;
+	EXPECT_EQ(fixed.measure(1, 2.0, Point()), sizeof(int) * 3 + sizeof(double));
+
+	// The archival of unknown size is not counted, so it is the lower bound.
+	Archive lower;
+	EXPECT_EQ(lower.measure(1, Object()), sizeof(int));
+	lower.pack(1, Object());
+	EXPECT_LT(lower.measure(1, Object()), lower.size());
+
+	// The referenced bytes are not counted.
+	std::string large(1024, 'r');
+	Archive referenced;
+	referenced.setReferenceThreshold(1024);
+	EXPECT_EQ(referenced.measure(large), sizeof(std::size_t));
+
+	// Preparing in a loop grows geometrically.
+	Archive growing;
+	std::size_t reallocated = 0;
+	const unsigned char* data = nullptr;
+	for (int i = 0; i < 10000; i++) {
+		growing.prepare(i);
+		if (growing.get() != data) {
+			data = growing.get();
+			reallocated++;
+		}
+		growing << i;
+	}
+	EXPECT_LT(reallocated, 32);
+}
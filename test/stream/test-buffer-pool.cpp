@@ -0,0 +1,169 @@
+/*
+ *  Copyright (c) 2018 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * @file        test-buffer-pool.cpp
+ * @author      Sangwan Kwon (sangwan.kwon@samsung.com)
+ */
+
+#include "stream/buffer-pool.hxx"
+#include "stream/archive.hxx"
+#include "klass/functor.hxx"
+#include "transport/connection.hxx"
+#include "transport/socket.hxx"
+
+#include <memory>
+#include <thread>
+#include <utility>
+
+#include <sys/socket.h>
+
+#include <gtest/gtest.h>
+
+using namespace rmi::stream;
+using namespace rmi::klass;
+using namespace rmi::transport;
+
+namespace {
+
+struct Calculator {
+	int add(int a, int b) { return a + b; }
+};
+
+} // anonymous namespace
+
+TEST(STREAM, BUFFER_POOL)
+{
+	BufferPool pool(2, 1024);
+
+	auto buffer = pool.acquire(128);
+	EXPECT_GE(buffer.capacity(), 128);
+	auto data = buffer.data();
+
+	buffer.assign(64, 0xFF);
+	pool.release(std::move(buffer));
+
+	// Recycled as empty.
+	auto recycled = pool.acquire(100);
+	EXPECT_EQ(recycled.data(), data);
+	EXPECT_TRUE(recycled.empty());
+
+	// Not enough capacity in pool.
+	pool.release(std::move(recycled));
+	auto larger = pool.acquire(512);
+	EXPECT_GE(larger.capacity(), 512);
+
+	auto statistics = pool.getStatistics();
+	EXPECT_EQ(statistics.hits, 1);
+	EXPECT_EQ(statistics.misses, 2);
+	EXPECT_EQ(statistics.recycled, 2);
+	EXPECT_DOUBLE_EQ(pool.getHitRate(), 1.0 / 3);
+}
+
+TEST(STREAM, BUFFER_POOL_CAPS)
+{
+	BufferPool pool(2, 1024);
+
+	// Over the capacity cap.
+	pool.release(pool.acquire(2048));
+	EXPECT_EQ(pool.getStatistics().dropped, 1);
+
+	// Over the count cap.
+	for (int i = 0; i < 3; i++)
+		pool.release(pool.acquire(16 + i));
+
+	EXPECT_EQ(pool.getStatistics().recycled, 2);
+	EXPECT_EQ(pool.getStatistics().dropped, 2);
+}
+
+TEST(STREAM, ARCHIVE_POOL)
+{
+	auto pool = std::make_shared<BufferPool>();
+	const unsigned char* data = nullptr;
+	{
+		Archive archive;
+		archive.setPool(pool);
+		archive << std::string("pooled buffer");
+		data = archive.get();
+	}
+
+	Archive archive;
+	archive.setPool(pool);
+	archive << 100;
+	EXPECT_EQ(archive.get(), data);
+	EXPECT_EQ(pool->getStatistics().hits, 1);
+
+	// Moved buffer is released once.
+	Archive moved(std::move(archive));
+	EXPECT_EQ(moved.get(), data);
+}
+
+TEST(STREAM, ARCHIVE_POOL_FUNCTOR)
+{
+	auto pool = std::make_shared<BufferPool>();
+	auto functor = make_functor_ptr(std::make_shared<Calculator>(), &Calculator::add);
+
+	for (int i = 0; i < 10; i++) {
+		Archive parameters;
+		parameters.setPool(pool);
+		parameters << i << i;
+
+		auto result = functor->invoke(parameters);
+		EXPECT_EQ(result.getPool(), pool);
+
+		int sum;
+		result >> sum;
+		EXPECT_EQ(sum, i + i);
+	}
+
+	// The parameters and the result are recycled after the first loop.
+	EXPECT_EQ(pool->getStatistics().misses, 2);
+	EXPECT_EQ(pool->getStatistics().hits, 18);
+}
+
+TEST(STREAM, CONNECTION_POOL)
+{
+	int fds[2];
+	ASSERT_NE(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds), -1);
+
+	Connection client{Socket(fds[0])};
+	Connection server{Socket(fds[1])};
+
+	auto serverThread = std::thread([&]() {
+		for (int i = 0; i < 10; i++) {
+			Message request = server.recv();
+			Message reply(Message::Type::Reply, request.signature,
+						  Message::Flag::None, server.getPool());
+			reply.enclose(request.buffer);
+			server.send(reply);
+		}
+	});
+
+	for (int i = 0; i < 10; i++) {
+		Message request(Message::Type::MethodCall, "echo",
+						Message::Flag::None, client.getPool());
+		request.enclose(i);
+
+		Message reply = client.request(request);
+		int echo;
+		reply.disclose(echo);
+		EXPECT_EQ(echo, i);
+	}
+
+	serverThread.join();
+
+	EXPECT_GT(client.getPool()->getHitRate(), 0.8);
+	EXPECT_GT(server.getPool()->getHitRate(), 0.8);
+}
@@ -0,0 +1,104 @@
+/*
+ *  Copyright (c) 2018 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * @file        test-compression.cpp
+ * @author      Sangwan Kwon (sangwan.kwon@samsung.com)
+ */
+
+#include "stream/compression.hxx"
+
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace rmi::stream;
+
+namespace {
+
+std::vector<unsigned char> roundtrip(const std::string& input)
+{
+	auto source = reinterpret_cast<const unsigned char*>(input.data());
+	std::vector<unsigned char> compressed(compressBound(input.size()));
+
+	auto length = compress(source, input.size(), compressed.data(), compressed.size());
+	EXPECT_GT(length, 0);
+	compressed.resize(length);
+
+	std::string output(input.size(), '\0');
+	decompress(compressed.data(), compressed.size(),
+			   reinterpret_cast<unsigned char*>(&output[0]), output.size());
+	EXPECT_EQ(input, output);
+
+	return compressed;
+}
+
+} // anonymous namespace
+
+TEST(STREAM, COMPRESSION)
+{
+	roundtrip("");
+	roundtrip("tiny");
+	roundtrip("less than 64KB window, less than 64KB window, less than 64KB window");
+
+	// Overlapped match repeats a short pattern.
+	auto runs = roundtrip(std::string(100000, 'a') + "b" + std::string(300, 'c'));
+	EXPECT_LT(runs.size(), 1000);
+
+	std::string text;
+	for (int i = 0; text.size() < 300000; i++)
+		text += "remote method invocation " + std::to_string(i % 1000) + ", ";
+	EXPECT_LT(roundtrip(text).size(), text.size() / 4);
+
+	std::srand(0);
+	std::string random(100000, '\0');
+	for (auto& c : random)
+		c = static_cast<char>(std::rand());
+	EXPECT_LE(roundtrip(random).size(), compressBound(random.size()));
+}
+
+TEST(STREAM, COMPRESSION_CAPACITY)
+{
+	std::srand(1);
+	std::string random(1000, '\0');
+	for (auto& c : random)
+		c = static_cast<char>(std::rand());
+
+	// Incompressible bytes don't fit in smaller capacity.
+	std::vector<unsigned char> compressed(random.size());
+	EXPECT_EQ(compress(reinterpret_cast<const unsigned char*>(random.data()), random.size(),
+					   compressed.data(), compressed.size()), 0);
+}
+
+TEST(STREAM, COMPRESSION_MALFORMED)
+{
+	auto compressed = roundtrip(std::string(1000, 'x') + "y");
+	std::vector<unsigned char> output(1001);
+
+	// Truncated.
+	EXPECT_THROW(decompress(compressed.data(), compressed.size() - 1,
+							output.data(), output.size()), std::runtime_error);
+	// Wrong decompressed size.
+	EXPECT_THROW(decompress(compressed.data(), compressed.size(),
+							output.data(), output.size() - 1), std::runtime_error);
+
+	// Offset before the beginning.
+	std::vector<unsigned char> offset = {0x10, 'a', 0x05, 0x00, 0x00};
+	EXPECT_THROW(decompress(offset.data(), offset.size(), output.data(), 10),
+				 std::runtime_error);
+}
@@ -0,0 +1,187 @@
+/*
+ *  Copyright (c) 2018 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * @file        test-descriptor.cpp
+ * @author      Sangwan Kwon (sangwan.kwon@samsung.com)
+ */
+
+#include "stream/archive.hxx"
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include <gtest/gtest.h>
+
+using namespace rmi::stream;
+
+TEST(STREAM, DESCRIPTOR)
+{
+	int fds[2];
+	ASSERT_EQ(::pipe(fds), 0);
+
+	Descriptor reader(fds[0]);
+	int writer = fds[1];
+	{
+		// The copies share it, and the last one closes.
+		Descriptor copy = reader;
+		EXPECT_EQ(copy.get(), fds[0]);
+		EXPECT_THROW(copy.release(), std::runtime_error);
+	}
+	EXPECT_NE(::fcntl(fds[0], F_GETFD), -1);
+
+	Descriptor duplicate = Descriptor::duplicate(writer);
+	EXPECT_NE(duplicate.get(), writer);
+	EXPECT_TRUE(::fcntl(duplicate.get(), F_GETFD) & FD_CLOEXEC);
+
+	writer = duplicate.release();
+	EXPECT_FALSE(duplicate.valid());
+	EXPECT_EQ(duplicate.get(), -1);
+	::close(writer);
+	::close(fds[1]);
+
+	EXPECT_THROW(Descriptor(-1), std::invalid_argument);
+}
+
+TEST(STREAM, DESCRIPTOR_ARCHIVE)
+{
+	int fds[2];
+	ASSERT_EQ(::pipe(fds), 0);
+
+	Descriptor reader(fds[0]);
+	Descriptor writer(fds[1]);
+
+	for (auto encoding : {Archive::Encoding::Fixed, Archive::Encoding::Compact}) {
+		Archive archive;
+		archive.setEncoding(encoding);
+		archive << std::string("before") << reader << Descriptor() << writer;
+
+		EXPECT_EQ(archive.measure(reader, Descriptor()), 2 * sizeof(bool));
+		ASSERT_EQ(archive.getDescriptors().size(), 2);
+		EXPECT_EQ(archive.getDescriptors()[0].get(), fds[0]);
+
+		// The descriptors follow the appended archive.
+		Archive outer;
+		outer.setEncoding(encoding);
+		outer << archive;
+		ASSERT_EQ(outer.getDescriptors().size(), 2);
+
+		std::string before;
+		Descriptor first, empty, second;
+		outer >> before >> first >> empty >> second;
+		EXPECT_EQ(before, "before");
+		EXPECT_EQ(first.get(), fds[0]);
+		EXPECT_FALSE(empty.valid());
+		EXPECT_EQ(second.get(), fds[1]);
+	}
+
+	// The bytes refer the descriptor which is not passed.
+	Archive archive;
+	archive << reader;
+
+	Archive bytes;
+	bytes.resize(archive.size());
+	std::memcpy(bytes.get(), archive.get(), archive.size());
+
+	Descriptor missing;
+	EXPECT_THROW(bytes >> missing, std::out_of_range);
+}
+
+TEST(STREAM, SEALED_BLOB)
+{
+	std::string payload = "sealed blob payload";
+
+	SealedBlob blob(payload.size());
+	std::memcpy(blob.writable(), payload.data(), payload.size());
+	EXPECT_FALSE(blob.isSealed());
+
+	// Unsealed one could be changed while the receiver reads it.
+	Archive archive;
+	EXPECT_THROW(archive << blob, std::invalid_argument);
+
+	blob.seal();
+	EXPECT_TRUE(blob.isSealed());
+	EXPECT_THROW(blob.writable(), std::runtime_error);
+	EXPECT_EQ(std::string(blob.view().begin(), blob.view().end()), payload);
+
+	int fd = blob.getDescriptor().get();
+	EXPECT_EQ(::write(fd, "x", 1), -1);
+	EXPECT_EQ(::ftruncate(fd, 0), -1);
+	EXPECT_EQ(::mmap(nullptr, payload.size(), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0),
+			  MAP_FAILED);
+
+	archive << blob;
+	ASSERT_EQ(archive.getDescriptors().size(), 1);
+
+	SealedBlob received;
+	archive >> received;
+	EXPECT_TRUE(received.isSealed());
+	EXPECT_EQ(received.size(), payload.size());
+	EXPECT_EQ(std::string(received.view().begin(), received.view().end()), payload);
+
+	// Empty one is also passed.
+	SealedBlob empty(0);
+	empty.seal();
+	archive << empty;
+	archive >> received;
+	EXPECT_EQ(received.size(), 0);
+	EXPECT_TRUE(received.view().empty());
+}
+
+TEST(STREAM, SEALED_BLOB_SEAL_FAILURE)
+{
+	std::string payload = "sealed blob payload";
+
+	SealedBlob blob(payload.size());
+	std::memcpy(blob.writable(), payload.data(), payload.size());
+
+	// The copy sharing the writable mapping prevents sealing.
+	{
+		SealedBlob copy = blob;
+		EXPECT_THROW(blob.seal(), std::runtime_error);
+		EXPECT_FALSE(blob.isSealed());
+	}
+
+	// So does the other writable mapping, and the blob is kept writable.
+	int fd = blob.getDescriptor().get();
+	auto address = ::mmap(nullptr, payload.size(), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	ASSERT_NE(address, MAP_FAILED);
+	EXPECT_THROW(blob.seal(), std::runtime_error);
+	EXPECT_FALSE(blob.isSealed());
+	ASSERT_NE(blob.writable(), nullptr);
+	blob.writable()[0] = 'S';
+	::munmap(address, payload.size());
+
+	blob.seal();
+	EXPECT_TRUE(blob.isSealed());
+	payload[0] = 'S';
+	EXPECT_EQ(std::string(blob.view().begin(), blob.view().end()), payload);
+}
+
+TEST(STREAM, SEALED_BLOB_UNSEALED)
+{
+	// The memfd which peer can still change is refused.
+	int fd = ::memfd_create("unsealed", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+	ASSERT_NE(fd, -1);
+	ASSERT_EQ(::ftruncate(fd, 4096), 0);
+	ASSERT_EQ(::fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW), 0);
+
+	EXPECT_THROW(SealedBlob(Descriptor(fd)), std::runtime_error);
+}
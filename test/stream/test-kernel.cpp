@@ -0,0 +1,269 @@
+/*
+ *  Copyright (c) 2018 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * @file        test-kernel.cpp
+ * @author      Sangwan Kwon (sangwan.kwon@samsung.com)
+ */
+
+#include "stream/archive.hxx"
+#include "stream/kernel.hxx"
+#include "stream/varint.hxx"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace rmi::stream;
+
+namespace {
+
+const kernel::Isa ISAS[] = {kernel::Isa::Scalar, kernel::Isa::SSE41, kernel::Isa::AVX2};
+
+// The boundary sizes around the vector widths.
+const std::size_t SIZES[] = {0, 1, 2, 3, 4, 7, 8, 9, 15, 16, 17, 31, 32, 33, 100, 1000};
+
+// Runs of 1 byte, 2 bytes and mixed values to take every path.
+template<typename T>
+std::vector<T> values(std::size_t count, int shape)
+{
+	std::vector<T> result(count);
+	for (std::size_t i = 0; i < count; i++) {
+		auto random = static_cast<T>((static_cast<std::uint64_t>(std::rand()) << 33) ^
+									 (static_cast<std::uint64_t>(std::rand()) << 11) ^
+									 static_cast<std::uint64_t>(std::rand()));
+		switch (shape) {
+		case 0: result[i] = static_cast<T>(random % 64); break;
+		case 1: result[i] = static_cast<T>(128 + random % 8000); break;
+		default: result[i] = (i % 5 == 0) ? random : static_cast<T>(i); break;
+		}
+	}
+
+	return result;
+}
+
+template<typename T>
+void expectVarints(const std::vector<T>& input, bool zigzag)
+{
+	std::vector<unsigned char> expected(input.size() * MAX_VARINT_SIZE);
+	kernel::setIsa(kernel::Isa::Scalar);
+	auto size = kernel::encodeVarints(input.data(), input.size(), expected.data(), zigzag);
+	expected.resize(size);
+
+	for (auto isa : ISAS) {
+		kernel::setIsa(isa);
+
+		std::vector<unsigned char> encoded(input.size() * MAX_VARINT_SIZE);
+		encoded.resize(kernel::encodeVarints(input.data(), input.size(),
+											 encoded.data(), zigzag));
+		EXPECT_EQ(expected, encoded);
+
+		std::vector<T> decoded(input.size());
+		EXPECT_EQ(kernel::decodeVarints(encoded.data(), encoded.size(),
+										decoded.data(), decoded.size(), zigzag), size);
+		EXPECT_EQ(input, decoded);
+	}
+
+	kernel::setIsa(kernel::detect());
+}
+
+} // anonymous namespace
+
+TEST(KERNEL, ISA)
+{
+	kernel::setIsa(kernel::Isa::AVX2);
+	EXPECT_EQ(kernel::getIsa(), kernel::detect());
+
+	kernel::setIsa(kernel::Isa::Scalar);
+	EXPECT_EQ(kernel::getIsa(), kernel::Isa::Scalar);
+
+	kernel::setIsa(kernel::detect());
+}
+
+TEST(KERNEL, VARINTS)
+{
+	std::srand(0);
+	for (auto count : SIZES) {
+		for (int shape = 0; shape < 3; shape++) {
+			for (bool zigzag : {false, true}) {
+				expectVarints(values<std::uint32_t>(count, shape), zigzag);
+				expectVarints(values<std::uint64_t>(count, shape), zigzag);
+			}
+		}
+	}
+}
+
+TEST(KERNEL, VARINTS_SAME_AS_SCALAR)
+{
+	// Each value must have the same bytes as encodeVarint().
+	std::vector<std::uint64_t> input = {0, 1, 127, 128, 16383, 16384, 0xFFFFFFFF, ~0ULL};
+	std::vector<unsigned char> expected;
+	for (auto value : input) {
+		unsigned char bytes[MAX_VARINT_SIZE];
+		expected.insert(expected.end(), bytes, bytes + encodeVarint(value, bytes));
+	}
+
+	for (auto isa : ISAS) {
+		kernel::setIsa(isa);
+		std::vector<unsigned char> encoded(input.size() * MAX_VARINT_SIZE);
+		encoded.resize(kernel::encodeVarints(input.data(), input.size(),
+											 encoded.data(), false));
+		EXPECT_EQ(expected, encoded);
+	}
+
+	kernel::setIsa(kernel::detect());
+}
+
+TEST(KERNEL, VARINTS_MALFORMED)
+{
+	for (auto isa : ISAS) {
+		kernel::setIsa(isa);
+
+		// Truncated after the vector path.
+		std::vector<unsigned char> bytes(40, 0x01);
+		bytes.push_back(0x80);
+		std::vector<std::uint32_t> values(41);
+		EXPECT_EQ(kernel::decodeVarints(bytes.data(), bytes.size(),
+										values.data(), values.size(), false), 0);
+
+		// Not enough values.
+		EXPECT_EQ(kernel::decodeVarints(bytes.data(), 40, values.data(), 41, false), 0);
+
+		// Overflows 32 bits.
+		unsigned char wide[] = {0xFF, 0xFF, 0xFF, 0xFF, 0x1F};
+		EXPECT_EQ(kernel::decodeVarints(wide, sizeof(wide), values.data(), 1, false), 0);
+
+		// Too long.
+		std::vector<unsigned char> endless(11, 0xFF);
+		std::vector<std::uint64_t> wides(1);
+		EXPECT_EQ(kernel::decodeVarints(endless.data(), endless.size(),
+										wides.data(), 1, false), 0);
+	}
+
+	kernel::setIsa(kernel::detect());
+}
+
+TEST(KERNEL, BYTE_SWAP)
+{
+	std::srand(1);
+	for (auto isa : ISAS) {
+		kernel::setIsa(isa);
+		for (auto count : SIZES) {
+			auto input = values<std::uint64_t>(count, 2);
+			std::vector<std::uint64_t> output(count);
+			kernel::byteSwap(input.data(), output.data(), count);
+			for (std::size_t i = 0; i < count; i++)
+				EXPECT_EQ(output[i], __builtin_bswap64(input[i]));
+
+			std::vector<std::uint32_t> words(input.begin(), input.end());
+			auto swapped = words;
+			kernel::byteSwap(swapped.data(), swapped.data(), count);
+			for (std::size_t i = 0; i < count; i++)
+				EXPECT_EQ(swapped[i], __builtin_bswap32(words[i]));
+
+			std::vector<std::uint16_t> shorts(input.begin(), input.end());
+			auto reversed = shorts;
+			kernel::byteSwap(reversed.data(), reversed.data(), count);
+			for (std::size_t i = 0; i < count; i++)
+				EXPECT_EQ(reversed[i], __builtin_bswap16(shorts[i]));
+		}
+	}
+
+	kernel::setIsa(kernel::detect());
+}
+
+TEST(KERNEL, DELTA)
+{
+	std::srand(2);
+	for (auto isa : ISAS) {
+		kernel::setIsa(isa);
+		for (auto count : SIZES) {
+			std::vector<std::int32_t> words(count);
+			std::vector<std::int64_t> longs(count);
+			for (std::size_t i = 0; i < count; i++) {
+				words[i] = static_cast<std::int32_t>(std::rand() - RAND_MAX / 2);
+				longs[i] = static_cast<std::int64_t>(std::rand()) * std::rand() * (i % 2 ? 1 : -1);
+			}
+
+			// Out of place, then in place.
+			std::vector<std::int32_t> wordDeltas(count);
+			kernel::deltaEncode(words.data(), wordDeltas.data(), count);
+			for (std::size_t i = 1; i < count; i++)
+				EXPECT_EQ(wordDeltas[i], static_cast<std::int32_t>(
+						static_cast<std::uint32_t>(words[i]) -
+						static_cast<std::uint32_t>(words[i - 1])));
+			kernel::deltaDecode(wordDeltas.data(), wordDeltas.data(), count);
+			EXPECT_EQ(words, wordDeltas);
+
+			auto longDeltas = longs;
+			kernel::deltaEncode(longDeltas.data(), longDeltas.data(), count);
+			if (count > 1) {
+				EXPECT_EQ(longDeltas[1], longs[1] - longs[0]);
+			}
+			std::vector<std::int64_t> restored(count);
+			kernel::deltaDecode(longDeltas.data(), restored.data(), count);
+			EXPECT_EQ(longs, restored);
+		}
+	}
+
+	kernel::setIsa(kernel::detect());
+}
+
+TEST(KERNEL, ARCHIVE_COMPACT_VECTOR)
+{
+	std::srand(3);
+	std::vector<int> ints = values<int>(1000, 2);
+	std::vector<long long> longs = values<long long>(777, 0);
+	std::vector<unsigned int> small = values<unsigned int>(300, 1);
+	std::vector<short> shorts = {-1, 0, 1, 300};
+
+	for (auto isa : ISAS) {
+		kernel::setIsa(isa);
+
+		Archive archive;
+		archive.setEncoding(Archive::Encoding::Compact);
+		archive << ints << longs << small << shorts;
+
+		// Same bytes as the per-element encoding.
+		Archive expected;
+		expected.setEncoding(Archive::Encoding::Compact);
+		expected << ints.size();
+		for (auto value : ints)
+			expected << value;
+		EXPECT_EQ(0, std::memcmp(expected.get(), archive.get(), expected.size()));
+
+		std::vector<int> intsOut;
+		std::vector<long long> longsOut;
+		std::vector<unsigned int> smallOut;
+		std::vector<short> shortsOut;
+		archive >> intsOut >> longsOut >> smallOut >> shortsOut;
+		EXPECT_EQ(ints, intsOut);
+		EXPECT_EQ(longs, longsOut);
+		EXPECT_EQ(small, smallOut);
+		EXPECT_EQ(shorts, shortsOut);
+	}
+
+	kernel::setIsa(kernel::detect());
+
+	Archive truncated;
+	truncated.setEncoding(Archive::Encoding::Compact);
+	truncated << static_cast<std::size_t>(2) << 1 << static_cast<unsigned char>(0x80);
+	std::vector<int> out;
+	EXPECT_THROW(truncated >> out, std::out_of_range);
+}
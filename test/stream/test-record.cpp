@@ -0,0 +1,102 @@
+/*
+ *  Copyright (c) 2018 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * @file        test-record.cpp
+ * @author      Sangwan Kwon (sangwan.kwon@samsung.com)
+ */
+
+#include "stream/record.hxx"
+#include "klass/functor.hxx"
+
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace rmi::stream;
+using namespace rmi::klass;
+
+namespace {
+
+struct Catalog {
+	Record find(int id)
+	{
+		return Record::make(id, std::string("name"), std::vector<int>{1, 2, 3});
+	}
+};
+
+} // anonymous namespace
+
+TEST(STREAM, RECORD)
+{
+	std::map<std::string, int> scores = {{"a", 1}, {"b", 2}};
+	auto input = Record::make(100, std::string("record"), scores, 3.14);
+	EXPECT_EQ(input.count(), 4);
+
+	for (auto encoding : {Archive::Encoding::Fixed, Archive::Encoding::Compact}) {
+		Archive archive;
+		archive.setEncoding(encoding);
+		archive << input;
+
+		Record output;
+		archive >> output;
+		EXPECT_EQ(output.count(), 4);
+
+		// Read in any order without the preceding fields.
+		EXPECT_EQ(output.get<double>(3), 3.14);
+		EXPECT_EQ(output.get<int>(0), 100);
+		EXPECT_EQ((output.get<std::map<std::string, int>>(2)), scores);
+		EXPECT_EQ(output.get<std::string>(1), "record");
+	}
+}
+
+TEST(STREAM, RECORD_IN_PLACE)
+{
+	auto record = Record::make(std::string("borrowed"));
+
+	StringView view;
+	record.get(0, view);
+	EXPECT_EQ(view, "borrowed");
+	EXPECT_EQ(reinterpret_cast<const unsigned char*>(view.data()),
+			  record.field(0).data() + sizeof(std::size_t));
+}
+
+TEST(STREAM, RECORD_OUT_OF_RANGE)
+{
+	auto record = Record::make(1, 2);
+	EXPECT_THROW(record.get<int>(2), std::out_of_range);
+	// The field is smaller than the requested type.
+	EXPECT_THROW(record.get<std::string>(0), std::out_of_range);
+
+	// Offset over the fields.
+	Archive archive;
+	archive << std::vector<std::size_t>{4, 100} << BlobView();
+
+	Record malformed;
+	EXPECT_THROW(archive >> malformed, std::out_of_range);
+}
+
+TEST(STREAM, RECORD_FUNCTOR)
+{
+	auto functor = make_functor_ptr(std::make_shared<Catalog>(), &Catalog::find);
+
+	auto record = functor->invoke<Record>(7);
+	EXPECT_EQ(record.get<int>(0), 7);
+	EXPECT_EQ(record.get<std::vector<int>>(2), std::vector<int>({1, 2, 3}));
+}
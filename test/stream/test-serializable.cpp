@@ -0,0 +1,122 @@
+/*
+ *  Copyright (c) 2018 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * @file        test-serializable.cpp
+ * @author      Sangwan Kwon (sangwan.kwon@samsung.com)
+ */
+
+#include "stream/archive.hxx"
+#include "klass/functor.hxx"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace rmi::stream;
+using namespace rmi::klass;
+
+namespace {
+
+struct Flat {
+	int x;
+	double y;
+	bool z;
+	long long w;
+
+	RMI_SERIALIZE(x, y, z, w)
+};
+
+struct Nested {
+	std::string name;
+	Flat flat = {0, 0, false, 0};
+	std::vector<Flat> flats;
+
+	RMI_SERIALIZE(name, flat, flats)
+};
+
+struct Geometry {
+	Flat scale(Flat flat, int factor)
+	{
+		flat.x *= factor;
+		flat.y *= factor;
+		return flat;
+	}
+};
+
+bool operator==(const Flat& lhs, const Flat& rhs)
+{
+	return lhs.x == rhs.x && lhs.y == rhs.y && lhs.z == rhs.z && lhs.w == rhs.w;
+}
+
+} // anonymous namespace
+
+TEST(STREAM, SERIALIZABLE)
+{
+	Nested input;
+	input.name = "serializable";
+	input.flat = {1, 2.5, true, -3};
+	input.flats = {{4, 5.5, false, 6}, {7, 8.5, true, 9}};
+
+	for (auto encoding : {Archive::Encoding::Fixed, Archive::Encoding::Compact}) {
+		Archive archive;
+		archive.setEncoding(encoding);
+		archive << input;
+
+		Nested output;
+		archive >> output;
+		EXPECT_EQ(output.name, input.name);
+		EXPECT_EQ(output.flat, input.flat);
+		EXPECT_EQ(output.flats, input.flats);
+	}
+}
+
+TEST(STREAM, SERIALIZABLE_SIZE)
+{
+	static_assert(SerializedSize<Flat>::fixed, "flat is fixed size.");
+	static_assert(SerializedSize<Flat>::size ==
+				  sizeof(int) + sizeof(double) + sizeof(bool) + sizeof(long long),
+				  "flat size.");
+	static_assert(!SerializedSize<Nested>::fixed, "string is not fixed.");
+
+	// The flat fields are copied as a block in the same layout as one by one.
+	Flat flat = {1, 2.5, true, -3};
+	Archive block, fields;
+	block << flat;
+	fields << flat.x << flat.y << flat.z << flat.w;
+	ASSERT_EQ(block.size(), fields.size());
+	EXPECT_EQ(std::vector<unsigned char>(block.get(), block.get() + block.size()),
+			  std::vector<unsigned char>(fields.get(), fields.get() + fields.size()));
+	EXPECT_EQ(block.measure(flat), block.size());
+
+	Nested nested;
+	nested.name = "measure";
+	nested.flats.resize(3, {0, 0, false, 0});
+	Archive archive;
+	archive << nested;
+	EXPECT_EQ(archive.measure(nested), archive.size());
+}
+
+TEST(STREAM, SERIALIZABLE_FUNCTOR)
+{
+	auto functor = make_functor_ptr(std::make_shared<Geometry>(), &Geometry::scale);
+
+	Flat input = {1, 2.5, false, 0};
+	auto output = functor->invoke<Flat>(input, 2);
+	EXPECT_EQ(output.x, 2);
+	EXPECT_EQ(output.y, 5.0);
+}
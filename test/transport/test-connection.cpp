@@ -23,17 +23,25 @@
 #include "event/mainloop.hxx"
 #include "event/eventfd.hxx"
 
+#include <future>
 #include <string>
 #include <thread>
 
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
 #include <gtest/gtest.h>
 
+#include "socket-path.hxx"
+
 using namespace rmi::transport;
 using namespace rmi::event;
 
 TEST(TRANSPORT, SOCKET_COMMUNICATION)
 {
-	std::string sockPath = ("./sock");
+	SocketPath sockPath("sock");
 
 	// server-side
 	Mainloop mainloop;
@@ -92,3 +100,449 @@ TEST(TRANSPORT, SOCKET_COMMUNICATION)
 	if (serverThread.joinable())
 		serverThread.join();
 }
+
+TEST(TRANSPORT, SOCKET_COMMUNICATION_LARGE)
+{
+	SocketPath sockPath("sock-large");
+	Socket socket(sockPath);
+
+	std::string request(4 * 1024 * 1024, 'q');
+	std::string response(8 * 1024 * 1024, 'r');
+
+	auto serverThread = std::thread([&]() {
+		Connection conn(socket.accept());
+		Message message = conn.recv();
+
+		std::string recv;
+		message.disclose(recv);
+		EXPECT_EQ(request, recv);
+
+		Message reply(Message::Type::Reply, "large");
+		reply.buffer.setReferenceThreshold(Message::REFERENCE_THRESHOLD);
+		reply.enclose(response);
+		EXPECT_EQ(reply.buffer.gather().size(), 2);
+
+		conn.send(reply);
+	});
+
+	Connection conn(sockPath);
+	Message msg(Message::Type::MethodCall, "large");
+	msg.buffer.setReferenceThreshold(Message::REFERENCE_THRESHOLD);
+	msg.enclose(request);
+
+	Message reply = conn.request(msg);
+
+	std::string recv;
+	reply.disclose(recv);
+	EXPECT_EQ(response, recv);
+
+	if (serverThread.joinable())
+		serverThread.join();
+}
+
+TEST(TRANSPORT, SOCKET_COMMUNICATION_COMPRESSED)
+{
+	SocketPath sockPath("sock-compressed");
+	Socket socket(sockPath);
+
+	std::string request;
+	for (int i = 0; request.size() < 1024 * 1024; i++)
+		request += "compressible request " + std::to_string(i % 100) + "\n";
+	std::string response(2 * 1024 * 1024, 'r');
+	std::promise<void> received;
+
+	auto serverThread = std::thread([&]() {
+		Connection conn(socket.accept());
+		Message handshake = conn.recv();
+		conn.acknowledge(handshake);
+
+		// Peek the header on the wire.
+		Message::Header header;
+		ASSERT_EQ(::recv(conn.getFd(), &header, sizeof(header), MSG_PEEK | MSG_WAITALL),
+				  sizeof(header));
+		EXPECT_TRUE(header.flags & Message::Flag::Compressed);
+		EXPECT_LT(header.length, request.size() / 4);
+
+		Message message = conn.recv();
+		EXPECT_FALSE(message.header.flags & Message::Flag::Compressed);
+
+		std::string recv;
+		message.disclose(recv);
+		EXPECT_EQ(request, recv);
+
+		Message reply(Message::Type::Reply, "compressed");
+		reply.buffer.setReferenceThreshold(Message::REFERENCE_THRESHOLD);
+		reply.enclose(response);
+		conn.send(reply);
+
+		// Send after the reply is read, so it is peeked on the wire.
+		received.get_future().wait();
+
+		// Not compressed under the threshold.
+		Message small(Message::Type::Reply, "small");
+		small.enclose(std::string(1024, 's'));
+		conn.send(small);
+	});
+
+	Connection conn(sockPath);
+	EXPECT_EQ(conn.negotiate(Message::Flag::Compressed), Message::Flag::Compressed);
+
+	Message msg(Message::Type::MethodCall, "compressed");
+	msg.enclose(request);
+
+	Message reply = conn.request(msg);
+
+	std::string recv;
+	reply.disclose(recv);
+	EXPECT_EQ(response, recv);
+
+	// The scratch of compression is borrowed from the pool and given back.
+	auto pool = std::make_shared<BufferPool>();
+	conn.setPool(pool);
+
+	Message again(Message::Type::MethodCall, "compressed");
+	again.enclose(request.substr(0, 64 * 1024));
+	conn.send(again);
+
+	auto statistics = pool->getStatistics();
+	EXPECT_EQ(statistics.misses, 1);
+	EXPECT_EQ(statistics.recycled, 1);
+
+	received.set_value();
+
+	Message::Header header;
+	ASSERT_EQ(::recv(conn.getFd(), &header, sizeof(header), MSG_PEEK | MSG_WAITALL),
+			  sizeof(header));
+	EXPECT_FALSE(header.flags & Message::Flag::Compressed);
+
+	Message small = conn.recv();
+	small.disclose(recv);
+	EXPECT_EQ(recv, std::string(1024, 's'));
+
+	if (serverThread.joinable())
+		serverThread.join();
+}
+
+TEST(TRANSPORT, CONNECTION_NON_BLOCKING)
+{
+	int fds[2];
+	ASSERT_NE(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds), -1);
+
+	// Small buffer to write partially.
+	int size = 4096;
+	ASSERT_EQ(::setsockopt(fds[0], SOL_SOCKET, SO_SNDBUF, &size, sizeof(size)), 0);
+
+	Connection server{Socket(fds[0])};
+	Connection client{Socket(fds[1])};
+	server.setNonBlocking(true);
+
+	// Nothing to read.
+	server.fill();
+	EXPECT_FALSE(server.ready());
+
+	// Read several messages at once.
+	for (int i = 0; i < 3; i++) {
+		Message message(Message::Type::MethodCall, "batch");
+		message.enclose(i);
+		client.send(message);
+	}
+
+	server.fill();
+	for (int i = 0; i < 3; i++) {
+		ASSERT_TRUE(server.ready());
+		int value;
+		server.next().disclose(value);
+		EXPECT_EQ(value, i);
+	}
+	EXPECT_FALSE(server.ready());
+
+	// The rest of large message is queued, and the next one follows it.
+	std::string large(1024 * 1024, 'l');
+	Message first(Message::Type::Reply, "large");
+	first.buffer.setReferenceThreshold(Message::REFERENCE_THRESHOLD);
+	first.enclose(large);
+	server.send(first);
+	EXPECT_GT(server.getPendingBytes(), 0);
+
+	Message second(Message::Type::Reply, "small");
+	second.enclose(std::string("small"));
+	server.send(second);
+
+	auto reader = std::thread([&]() {
+		std::string recv;
+		client.recv().disclose(recv);
+		EXPECT_EQ(recv, large);
+
+		client.recv().disclose(recv);
+		EXPECT_EQ(recv, "small");
+	});
+
+	while (!server.flush()) {
+		::pollfd target = {server.getFd(), POLLOUT, 0};
+		::poll(&target, 1, -1);
+	}
+	EXPECT_EQ(server.getPendingBytes(), 0);
+
+	reader.join();
+}
+
+TEST(TRANSPORT, CONNECTION_WATERMARKS)
+{
+	int fds[2];
+	ASSERT_NE(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds), -1);
+
+	int size = 4096;
+	ASSERT_EQ(::setsockopt(fds[0], SOL_SOCKET, SO_SNDBUF, &size, sizeof(size)), 0);
+
+	Connection server{Socket(fds[0])};
+	Connection client{Socket(fds[1])};
+	server.setNonBlocking(true);
+
+	EXPECT_THROW(server.setWatermarks(1024, 4096), std::invalid_argument);
+	server.setWatermarks(256 * 1024, 64 * 1024);
+
+	// Not congested below high watermark.
+	Message small(Message::Type::Reply, "small");
+	small.enclose(std::string(16 * 1024, 's'));
+	server.send(small);
+	EXPECT_FALSE(server.isCongested());
+
+	std::string large(1024 * 1024, 'l');
+	Message message(Message::Type::Reply, "large");
+	message.enclose(large);
+	server.send(message);
+	EXPECT_TRUE(server.isCongested());
+	EXPECT_EQ(server.getBackpressure().engaged, 1);
+	EXPECT_GE(server.getBackpressure().peakBytes, 256 * 1024);
+
+	auto reader = std::thread([&]() {
+		std::string recv;
+		client.recv().disclose(recv);
+		client.recv().disclose(recv);
+		EXPECT_EQ(recv, large);
+	});
+
+	// Congested until the queue drains to low watermark.
+	while (!server.flush()) {
+		EXPECT_EQ(server.isCongested(), server.getPendingBytes() > 64 * 1024);
+		::pollfd target = {server.getFd(), POLLOUT, 0};
+		::poll(&target, 1, -1);
+	}
+	EXPECT_FALSE(server.isCongested());
+	EXPECT_EQ(server.getBackpressure().engaged, 1);
+
+	reader.join();
+}
+
+TEST(TRANSPORT, CONNECTION_BATCHED_RECV)
+{
+	int fds[2];
+	ASSERT_NE(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds), -1);
+
+	Connection server{Socket(fds[0])};
+	Connection client{Socket(fds[1])};
+
+	for (int i = 0; i < 16; i++) {
+		Message message(Message::Type::MethodCall, "pipelined");
+		message.enclose(i);
+		client.send(message);
+	}
+
+	// The pipelined messages are read at once, and kept for the next recv().
+	int value;
+	server.recv().disclose(value);
+	EXPECT_EQ(value, 0);
+
+	int unread = -1;
+	ASSERT_EQ(::ioctl(server.getFd(), FIONREAD, &unread), 0);
+	EXPECT_EQ(unread, 0);
+
+	for (int i = 1; i < 16; i++) {
+		server.recv().disclose(value);
+		EXPECT_EQ(value, i);
+	}
+}
+
+TEST(TRANSPORT, CONNECTION_DESCRIPTORS)
+{
+	int fds[2];
+	ASSERT_NE(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds), -1);
+
+	Connection server{Socket(fds[0])};
+	Connection client{Socket(fds[1])};
+	server.setNonBlocking(true);
+
+	int pipe[2];
+	ASSERT_EQ(::pipe2(pipe, O_CLOEXEC), 0);
+	rmi::stream::Descriptor reader(pipe[0]);
+	rmi::stream::Descriptor writer(pipe[1]);
+
+	std::size_t size = 16 * 1024 * 1024;
+	rmi::stream::SealedBlob blob(size);
+	for (std::size_t i = 0; i < size; i += 4096)
+		blob.writable()[i] = static_cast<unsigned char>(i >> 12);
+	blob.seal();
+
+	// Pipelined, so the messages with and without descriptors are read together.
+	for (int i = 0; i < 4; i++) {
+		Message message(Message::Type::MethodCall, "descriptors");
+		if (i % 2 == 0)
+			message.enclose(i, writer, blob);
+		else
+			message.enclose(i);
+		client.send(message);
+	}
+
+	std::size_t popped = 0;
+	while (popped < 4) {
+		server.fill();
+		while (server.ready()) {
+			Message message = server.next();
+			int value;
+			if (popped % 2 == 1) {
+				EXPECT_EQ(message.header.descriptors, 0);
+				message.disclose(value);
+				EXPECT_EQ(value, static_cast<int>(popped++));
+				continue;
+			}
+
+			EXPECT_EQ(message.header.descriptors, 2);
+			rmi::stream::Descriptor received;
+			rmi::stream::SealedBlob mapped;
+			message.disclose(value, received, mapped);
+			EXPECT_EQ(value, static_cast<int>(popped++));
+
+			// Same pipe, but another descriptor.
+			EXPECT_NE(received.get(), writer.get());
+			ASSERT_EQ(::write(received.get(), "p", 1), 1);
+			char byte;
+			ASSERT_EQ(::read(reader.get(), &byte, 1), 1);
+			EXPECT_EQ(byte, 'p');
+
+			// Shared without copy.
+			ASSERT_EQ(mapped.size(), size);
+			for (std::size_t i = 0; i < size; i += 4096)
+				EXPECT_EQ(mapped.data()[i], static_cast<unsigned char>(i >> 12));
+		}
+	}
+}
+
+TEST(TRANSPORT, CONNECTION_DESCRIPTORS_QUEUED)
+{
+	int fds[2];
+	ASSERT_NE(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds), -1);
+
+	int size = 4096;
+	ASSERT_EQ(::setsockopt(fds[0], SOL_SOCKET, SO_SNDBUF, &size, sizeof(size)), 0);
+
+	Connection server{Socket(fds[0])};
+	Connection client{Socket(fds[1])};
+	server.setNonBlocking(true);
+
+	int pipe[2];
+	ASSERT_EQ(::pipe2(pipe, O_CLOEXEC), 0);
+	rmi::stream::Descriptor reader(pipe[0]);
+	rmi::stream::Descriptor writer(pipe[1]);
+
+	std::string large(1024 * 1024, 'l');
+	Message first(Message::Type::Reply, "large");
+	first.enclose(large);
+	server.send(first);
+	ASSERT_GT(server.getPendingBytes(), 0);
+
+	// Queued with the bytes instead of waiting for the peer.
+	for (int i = 0; i < 4; i++) {
+		Message message(Message::Type::Reply, "descriptors");
+		if (i % 2 == 0) {
+			rmi::stream::Descriptor duplicated = rmi::stream::Descriptor::duplicate(writer.get());
+			message.enclose(i, duplicated);
+		} else {
+			message.enclose(i);
+		}
+		server.send(message);
+	}
+
+	auto receiver = std::thread([&]() {
+		std::string recv;
+		client.recv().disclose(recv);
+		EXPECT_EQ(recv, large);
+
+		for (int i = 0; i < 4; i++) {
+			Message message = client.recv();
+			int value;
+			if (i % 2 == 1) {
+				EXPECT_EQ(message.header.descriptors, 0);
+				message.disclose(value);
+				EXPECT_EQ(value, i);
+				continue;
+			}
+
+			EXPECT_EQ(message.header.descriptors, 1);
+			rmi::stream::Descriptor received;
+			message.disclose(value, received);
+			EXPECT_EQ(value, i);
+
+			ASSERT_EQ(::write(received.get(), "q", 1), 1);
+			char byte;
+			ASSERT_EQ(::read(reader.get(), &byte, 1), 1);
+			EXPECT_EQ(byte, 'q');
+		}
+	});
+
+	while (!server.flush()) {
+		::pollfd target = {server.getFd(), POLLOUT, 0};
+		::poll(&target, 1, -1);
+	}
+
+	receiver.join();
+}
+
+TEST(TRANSPORT, CONNECTION_TCP)
+{
+	Socket socket("tcp:127.0.0.1:0");
+
+	auto serverThread = std::thread([&]() {
+		Connection conn(socket.accept());
+		Message handshake = conn.recv();
+		conn.acknowledge(handshake);
+
+		while (true) {
+			Message request = conn.recv();
+			std::string value;
+			request.disclose(value);
+			if (value.empty())
+				break;
+
+			Message reply(Message::Type::Reply, "echo", conn.getFlags());
+			reply.enclose(value);
+			conn.send(reply);
+		}
+	});
+
+	Connection conn(socket.getAddress());
+	// Memory is not shared over TCP.
+	EXPECT_EQ(conn.negotiate(Message::Flag::Compact | Message::Flag::SharedMemory),
+			  Message::Flag::Compact);
+
+	for (std::size_t size : {16, 1024 * 1024}) {
+		Message request(Message::Type::MethodCall, "echo", conn.getFlags());
+		request.enclose(std::string(size, 'e'));
+
+		std::string recv;
+		conn.request(request).disclose(recv);
+		EXPECT_EQ(recv, std::string(size, 'e'));
+	}
+
+	int pipe[2];
+	ASSERT_EQ(::pipe2(pipe, O_CLOEXEC), 0);
+	::close(pipe[1]);
+	Message descriptor(Message::Type::MethodCall, "descriptor", conn.getFlags());
+	descriptor.enclose(rmi::stream::Descriptor(pipe[0]));
+	EXPECT_THROW(conn.send(descriptor), std::invalid_argument);
+
+	Message stop(Message::Type::MethodCall, "stop", conn.getFlags());
+	stop.enclose(std::string());
+	conn.send(stop);
+
+	serverThread.join();
+}
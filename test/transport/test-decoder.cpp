@@ -0,0 +1,174 @@
+/*
+ *  Copyright (c) 2018 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * @file        test-decoder.cpp
+ * @author      Sangwan Kwon (sangwan.kwon@samsung.com)
+ */
+
+#include "transport/decoder.hxx"
+#include "stream/compression.hxx"
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace rmi::transport;
+using namespace rmi::stream;
+
+namespace {
+
+std::vector<unsigned char> encode(Message& message)
+{
+	auto header = reinterpret_cast<const unsigned char*>(&message.header);
+	std::vector<unsigned char> bytes(header, header + sizeof(message.header));
+	for (const auto& piece : message.buffer.gather())
+		bytes.insert(bytes.end(), piece.begin(), piece.end());
+
+	return bytes;
+}
+
+std::vector<unsigned char> encode(const std::string& signature, int value)
+{
+	Message message(Message::Type::MethodCall, signature);
+	message.enclose(value);
+
+	return encode(message);
+}
+
+} // anonymous namespace
+
+TEST(TRANSPORT, DECODER_PARTIAL)
+{
+	auto bytes = encode("partial", 100);
+
+	// Byte by byte.
+	Decoder decoder;
+	for (std::size_t i = 0; i < bytes.size(); i++) {
+		EXPECT_FALSE(decoder.ready());
+		decoder.feed(bytes.data() + i, 1);
+	}
+
+	EXPECT_TRUE(decoder.ready());
+	EXPECT_FALSE(decoder.pending());
+
+	Message message = decoder.next();
+	EXPECT_EQ(message.signature, "partial");
+
+	int value;
+	message.disclose(value);
+	EXPECT_EQ(value, 100);
+
+	EXPECT_THROW(decoder.next(), std::out_of_range);
+}
+
+TEST(TRANSPORT, DECODER_MULTIPLE)
+{
+	std::vector<unsigned char> bytes;
+	for (int i = 0; i < 3; i++) {
+		auto message = encode("multiple" + std::to_string(i), i);
+		bytes.insert(bytes.end(), message.begin(), message.end());
+	}
+
+	// Three and a half messages at once.
+	auto fourth = encode("fourth", 4);
+	bytes.insert(bytes.end(), fourth.begin(), fourth.begin() + fourth.size() / 2);
+
+	Decoder decoder;
+	decoder.feed(bytes.data(), bytes.size());
+	EXPECT_TRUE(decoder.pending());
+
+	for (int i = 0; i < 3; i++) {
+		ASSERT_TRUE(decoder.ready());
+		Message message = decoder.next();
+		EXPECT_EQ(message.signature, "multiple" + std::to_string(i));
+	}
+	EXPECT_FALSE(decoder.ready());
+
+	// Received in place.
+	auto window = decoder.window();
+	auto rest = fourth.size() - fourth.size() / 2;
+	ASSERT_GE(window.size, 1);
+	std::memcpy(window.data, fourth.data() + fourth.size() / 2, 1);
+	decoder.commit(1);
+	decoder.feed(fourth.data() + fourth.size() / 2 + 1, rest - 1);
+
+	ASSERT_TRUE(decoder.ready());
+	EXPECT_EQ(decoder.next().signature, "fourth");
+}
+
+TEST(TRANSPORT, DECODER_COMPRESSED)
+{
+	std::string payload(100000, 'z');
+
+	Message message(Message::Type::Reply, "compressed");
+	message.enclose(payload);
+
+	auto pieces = message.buffer.gather();
+	std::vector<unsigned char> frame(message.buffer.size());
+	auto length = compressFrame(pieces, message.buffer.size(), frame.data(), frame.size());
+	ASSERT_GT(length, 0);
+
+	Message::Header header = message.header;
+	header.flags |= Message::Flag::Compressed;
+	header.length = length;
+
+	Decoder decoder;
+	decoder.feed(&header, sizeof(header));
+	decoder.feed(frame.data(), length);
+
+	ASSERT_TRUE(decoder.ready());
+	Message output = decoder.next();
+	EXPECT_FALSE(output.header.flags & Message::Flag::Compressed);
+	EXPECT_EQ(output.signature, "compressed");
+
+	std::string received;
+	output.disclose(received);
+	EXPECT_EQ(received, payload);
+}
+
+TEST(TRANSPORT, DECODER_MALFORMED)
+{
+	// Oversized length is rejected before allocating.
+	Message::Header header = {0, Message::Type::MethodCall, 1024, 0, 0};
+
+	Decoder oversized(1000);
+	EXPECT_THROW(oversized.feed(&header, sizeof(header)), std::runtime_error);
+	// Failed decoder refuses the following bytes.
+	EXPECT_THROW(oversized.feed(&header, sizeof(header)), std::runtime_error);
+
+	// Signature longer than the body.
+	std::vector<unsigned char> body(sizeof(std::size_t) + 4);
+	std::size_t length = 1000;
+	std::memcpy(body.data(), &length, sizeof(length));
+	header.length = body.size();
+
+	Decoder decoder;
+	decoder.feed(&header, sizeof(header));
+	EXPECT_THROW(decoder.feed(body.data(), body.size()), std::runtime_error);
+
+	// Compressed frame over the ratio limit.
+	std::vector<unsigned char> frame(sizeof(std::uint64_t));
+	std::uint64_t size = 1024 * 1024;
+	std::memcpy(frame.data(), &size, sizeof(size));
+	header = {0, Message::Type::MethodCall, frame.size(), Message::Flag::Compressed, 0};
+
+	Decoder bomb;
+	bomb.feed(&header, sizeof(header));
+	EXPECT_THROW(bomb.feed(frame.data(), frame.size()), std::runtime_error);
+}
@@ -0,0 +1,216 @@
+/*
+ *  Copyright (c) 2018 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License
+ */
+/*
+ * @file        test-shared-channel.cpp
+ * @author      Sangwan Kwon (sangwan.kwon@samsung.com)
+ */
+
+#include "transport/shared-channel.hxx"
+
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+using namespace rmi::transport;
+
+namespace {
+
+void write(SharedChannel& channel, Message& message)
+{
+	auto pieces = message.buffer.gather();
+	std::vector<::iovec> vector = {{&message.header, sizeof(message.header)}};
+	for (const auto& piece : pieces)
+		vector.push_back({const_cast<unsigned char*>(piece.data()), piece.size()});
+
+	channel.write(vector.data(), vector.size());
+}
+
+Message read(SharedChannel& channel, Decoder& decoder)
+{
+	while (!decoder.ready()) {
+		if (channel.read(decoder) == 0)
+			channel.wait();
+	}
+
+	return decoder.next();
+}
+
+} // anonymous namespace
+
+TEST(TRANSPORT, SHARED_CHANNEL)
+{
+	int fds[2];
+	ASSERT_NE(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds), -1);
+
+	// Smaller than the messages to wrap around.
+	SharedChannel client(4096, fds[0]);
+	SharedChannel server(::dup(client.getMemoryFd()), ::dup(client.getNotifyFd()), fds[1]);
+	EXPECT_EQ(server.getCapacity(), 4096);
+
+	// Server sleeps at first, so the first request is notified.
+	auto writer = std::thread([&]() {
+		for (std::size_t i = 0; i < 100; i++) {
+			Message message(Message::Type::MethodCall, "shared");
+			message.enclose(std::string(i * 97, static_cast<char>('a' + i % 26)));
+			write(client, message);
+		}
+	});
+
+	::pollfd target = {server.getNotifyFd(), POLLIN, 0};
+	EXPECT_EQ(::poll(&target, 1, -1), 1);
+
+	Decoder decoder;
+	for (std::size_t i = 0; i < 100; i++) {
+		Message message = read(server, decoder);
+		std::string recv;
+		message.disclose(recv);
+		EXPECT_EQ(recv, std::string(i * 97, static_cast<char>('a' + i % 26)));
+	}
+
+	writer.join();
+
+	// Reply in the other direction.
+	Message reply(Message::Type::Reply, "shared");
+	reply.enclose(std::string("reply"));
+	write(server, reply);
+
+	Decoder clientDecoder;
+	std::string recv;
+	read(client, clientDecoder).disclose(recv);
+	EXPECT_EQ(recv, "reply");
+
+	EXPECT_TRUE(server.sleep());
+
+	::close(fds[0]);
+	::close(fds[1]);
+}
+
+TEST(TRANSPORT, SHARED_CHANNEL_CLOSED)
+{
+	int fds[2];
+	ASSERT_NE(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds), -1);
+
+	std::unique_ptr<SharedChannel> client(new SharedChannel(4096, fds[0]));
+	SharedChannel server(::dup(client->getMemoryFd()), ::dup(client->getNotifyFd()), fds[1]);
+
+	auto closer = std::thread([&]() {
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		client.reset();
+	});
+
+	Decoder decoder;
+	EXPECT_THROW(read(server, decoder), std::runtime_error);
+	closer.join();
+
+	// Crashed peer is found by the hangup of socket.
+	SharedChannel other(4096, fds[1]);
+	::shutdown(fds[0], SHUT_RDWR);
+	EXPECT_THROW(read(other, decoder), std::runtime_error);
+
+	::close(fds[0]);
+	::close(fds[1]);
+}
+
+TEST(TRANSPORT, SHARED_CHANNEL_WRITE_SOME)
+{
+	int fds[2];
+	ASSERT_NE(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds), -1);
+
+	SharedChannel client(4096, fds[0]);
+	SharedChannel server(::dup(client.getMemoryFd()), ::dup(client.getNotifyFd()), fds[1]);
+
+	Message reply(Message::Type::Reply, "partial");
+	reply.enclose(std::string(10000, 'p'));
+	std::string bytes(reinterpret_cast<const char*>(&reply.header), sizeof(reply.header));
+	for (const auto& piece : reply.buffer.gather())
+		bytes.append(reinterpret_cast<const char*>(piece.data()), piece.size());
+
+	// Server writes what fits without waiting for the client.
+	::iovec vector = {&bytes[0], bytes.size()};
+	EXPECT_EQ(server.writeSome(&vector, 1), 4096);
+	EXPECT_FALSE(server.writable());
+	EXPECT_EQ(server.writeSome(&vector, 1), 0);
+
+	// The room made by client is notified by eventfd.
+	::pollfd target = {server.getNotifyFd(), POLLIN, 0};
+	EXPECT_EQ(::poll(&target, 1, 0), 0);
+	Decoder decoder;
+	EXPECT_EQ(client.read(decoder), 4096);
+	EXPECT_EQ(::poll(&target, 1, 0), 1);
+
+	server.consume();
+	vector = {&bytes[4096], bytes.size() - 4096};
+	EXPECT_EQ(server.writeSome(&vector, 1), 4096);
+
+	// The notification consumed by sleep() is reminded.
+	EXPECT_EQ(client.read(decoder), 4096);
+	EXPECT_TRUE(server.sleep());
+	EXPECT_EQ(::poll(&target, 1, 0), 0);
+	server.remind();
+	EXPECT_EQ(::poll(&target, 1, 0), 1);
+
+	server.consume();
+	vector = {&bytes[8192], bytes.size() - 8192};
+	EXPECT_EQ(server.writeSome(&vector, 1), bytes.size() - 8192);
+
+	std::string recv;
+	read(client, decoder).disclose(recv);
+	EXPECT_EQ(recv, std::string(10000, 'p'));
+
+	::close(fds[0]);
+	::close(fds[1]);
+}
+
+TEST(TRANSPORT, SHARED_CHANNEL_WRITE_TIMEOUT)
+{
+	int fds[2];
+	ASSERT_NE(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds), -1);
+
+	SharedChannel client(4096, fds[0]);
+	SharedChannel server(::dup(client.getMemoryFd()), ::dup(client.getNotifyFd()), fds[1]);
+	client.setWriteTimeout(200);
+
+	// The server is alive, but does not read.
+	std::string bytes(8192, 't');
+	::iovec vector = {&bytes[0], bytes.size()};
+	auto begin = std::chrono::steady_clock::now();
+	EXPECT_THROW(client.write(&vector, 1), std::runtime_error);
+	EXPECT_GE(std::chrono::steady_clock::now() - begin, std::chrono::milliseconds(200));
+
+	::close(fds[0]);
+	::close(fds[1]);
+}
+
+TEST(TRANSPORT, SHARED_CHANNEL_UNSEALED)
+{
+	int memoryFd = ::memfd_create("unsealed", MFD_CLOEXEC);
+	ASSERT_NE(memoryFd, -1);
+	ASSERT_EQ(::ftruncate(memoryFd, 2 * 4096 + 4096), 0);
+
+	int notifyFd = ::eventfd(0, EFD_CLOEXEC);
+	EXPECT_THROW(SharedChannel(memoryFd, notifyFd, -1), std::runtime_error);
+}
@@ -26,14 +26,21 @@
 #include <thread>
 #include <chrono>
 #include <cstring>
+#include <stdexcept>
+
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
 
 #include <gtest/gtest.h>
 
+#include "socket-path.hxx"
+
 using namespace rmi::transport;
 
 TEST(TRANSPORT, SOCKET_READ_WRITE)
 {
-	std::string sockPath = "./sock";
+	SocketPath sockPath("sock");
 	Socket socket(sockPath);
 
 	int input = std::numeric_limits<int>::max();
@@ -104,3 +111,110 @@ TEST(TRANSPORT, SOCKET_ABSTRACT)
 	if (client.joinable())
 		client.join();
 }
+
+TEST(TRANSPORT, SOCKET_NON_BLOCKING)
+{
+	int fds[2];
+	ASSERT_NE(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds), -1);
+
+	Socket reader(fds[0]);
+	Socket writer(fds[1]);
+
+	reader.setNonBlocking(true);
+	EXPECT_TRUE(reader.isNonBlocking());
+	EXPECT_FALSE(writer.isNonBlocking());
+
+	char buffer[16];
+	EXPECT_EQ(reader.recvSome(buffer, sizeof(buffer)), 0);
+
+	char data[] = "hello";
+	::iovec vector = {data, sizeof(data)};
+	EXPECT_EQ(writer.sendSome(&vector, 1), sizeof(data));
+	EXPECT_EQ(reader.recvSome(buffer, sizeof(buffer)), sizeof(data));
+	EXPECT_STREQ(buffer, data);
+
+	// Blocking call waits for the non-blocking socket.
+	auto late = std::thread([&]() {
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		writer.send(data, sizeof(data));
+	});
+	reader.recv(buffer, sizeof(data));
+	EXPECT_STREQ(buffer, data);
+	late.join();
+
+	// Closed peer throws instead of spinning.
+	{
+		Socket closed = std::move(writer);
+	}
+	EXPECT_THROW(reader.recvSome(buffer, sizeof(buffer)), std::runtime_error);
+	EXPECT_THROW(reader.recv(buffer, sizeof(buffer)), std::runtime_error);
+}
+
+namespace {
+
+int get_option(const Socket& socket, int level, int name)
+{
+	int value = 0;
+	::socklen_t size = sizeof(value);
+	EXPECT_EQ(::getsockopt(socket.getFd(), level, name, &value, &size), 0);
+	return value;
+}
+
+} // anonymous namespace
+
+TEST(TRANSPORT, SOCKET_TCP)
+{
+	Socket::Options options;
+	options.keepAliveIdle = 30;
+	options.sendBufferSize = 256 * 1024;
+	options.recvBufferSize = 256 * 1024;
+
+	for (std::string loopback : {"tcp:127.0.0.1:0", "tcp:[::1]:0"}) {
+		// The port is chosen by kernel.
+		Socket socket(loopback, options);
+		std::string address = socket.getAddress();
+		EXPECT_EQ(address.compare(0, loopback.size() - 1, loopback, 0, loopback.size() - 1), 0);
+		EXPECT_NE(address, loopback);
+		EXPECT_FALSE(socket.isLocal());
+
+		Socket connected = Socket::connect(address, options);
+		Socket accepted = socket.accept();
+
+		for (const auto& peer : {&connected, &accepted}) {
+			EXPECT_EQ(get_option(*peer, IPPROTO_TCP, TCP_NODELAY), 1);
+			EXPECT_EQ(get_option(*peer, SOL_SOCKET, SO_KEEPALIVE), 1);
+			EXPECT_EQ(get_option(*peer, IPPROTO_TCP, TCP_KEEPIDLE), 30);
+			// Kernel doubles the requested one.
+			EXPECT_GE(get_option(*peer, SOL_SOCKET, SO_SNDBUF), options.sendBufferSize);
+			EXPECT_GE(get_option(*peer, SOL_SOCKET, SO_RCVBUF), options.recvBufferSize);
+		}
+
+		int input = std::numeric_limits<int>::max();
+		int output = 0;
+		connected.send(&input);
+		accepted.recv(&output);
+		EXPECT_EQ(input, output);
+	}
+
+	EXPECT_THROW(Socket::connect("tcp:127.0.0.1:1"), std::runtime_error);
+}
+
+TEST(TRANSPORT, SOCKET_ADDRESS)
+{
+	SocketPath sockPath("sock-address");
+	Socket socket("unix:" + sockPath.get());
+	EXPECT_EQ(socket.getAddress(), "unix:" + sockPath.get());
+	EXPECT_TRUE(socket.isLocal());
+
+	// The path without scheme is Unix domain too.
+	Socket connected = Socket::connect(sockPath);
+	EXPECT_TRUE(connected.isLocal());
+
+	Socket abstract("unix:@sock-address");
+	EXPECT_EQ(abstract.getAddress(), "unix:@sock-address");
+
+	EXPECT_THROW(Socket("tcp:127.0.0.1"), std::invalid_argument);
+	EXPECT_THROW(Socket("tcp:::1:0"), std::invalid_argument);
+	EXPECT_THROW(Socket("unix:"), std::invalid_argument);
+	EXPECT_THROW(Socket::connect("tcp:host.invalid:80"), std::invalid_argument);
+}